@@ -244,6 +244,22 @@ yf_hash_key(char *data, size_t len)
 }
 
 
+yf_int_t
+yf_jump_hash(yf_u64_t key, yf_int_t buckets)
+{
+        yf_s64_t b = -1, j = 0;
+
+        while (j < buckets)
+        {
+                b = j;
+                key = key * 2862933555777941757ULL + 1;
+                j = (b + 1) * ((double)(1LL << 31) / (double)((key >> 33) + 1));
+        }
+
+        return b;
+}
+
+
 yf_uint_t
 yf_hash_key_lc(char *data, size_t len)
 {
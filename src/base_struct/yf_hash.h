@@ -82,6 +82,12 @@ yf_uint_t yf_hash_key(char *data, size_t len);
 yf_uint_t yf_hash_key_lc(char *data, size_t len);
 yf_uint_t yf_hash_strlow(char *dst, char *src, size_t n);
 
+/*
+* jump consistent hash, key -> [0, buckets), if buckets grow from n to n+1,
+* only 1/(n+1) keys move (all to the new bucket), others stay
+*/
+yf_int_t yf_jump_hash(yf_u64_t key, yf_int_t buckets);
+
 
 yf_int_t yf_hash_keys_array_init(yf_hash_keys_arrays_t *ha, yf_uint_t type);
 yf_int_t yf_hash_add_key(yf_hash_keys_arrays_t *ha, yf_str_t *key, void *value, yf_uint_t flags);
@@ -12,7 +12,10 @@ yf_create_pool(size_t size, yf_log_t *log)
 {
         yf_pool_t *p;
 
-        p = yf_memalign(YF_POOL_ALIGNMENT, size, log);
+        if (size >= YF_HPAGE_MIN_SIZE)
+                p = yf_page_alloc(size, log);
+        else
+                p = yf_memalign(YF_POOL_ALIGNMENT, size, log);
         if (p == NULL)
         {
                 return NULL;
@@ -44,6 +47,7 @@ yf_destroy_pool(yf_pool_t *pool)
         yf_pool_t *p, *n;
         yf_pool_large_t *l;
         yf_pool_cleanup_t *c;
+        size_t psize = (size_t)(pool->d.end - (char *)pool);
 
         for (c = pool->cleanup; c; c = c->next)
         {
@@ -87,7 +91,10 @@ yf_destroy_pool(yf_pool_t *pool)
 
         for (p = pool, n = pool->d.next; /* void */; p = n, n = n->d.next)
         {
-                yf_free(p);
+                if (psize >= YF_HPAGE_MIN_SIZE)
+                        yf_page_free(p);
+                else
+                        yf_free(p);
 
                 if (n == NULL)
                 {
@@ -200,7 +207,10 @@ yf_palloc_block(yf_pool_t *pool, size_t size)
 
         psize = (size_t)(pool->d.end - (char *)pool);
 
-        m = yf_memalign(YF_POOL_ALIGNMENT, psize, pool->log);
+        if (psize >= YF_HPAGE_MIN_SIZE)
+                m = yf_page_alloc(psize, pool->log);
+        else
+                m = yf_memalign(YF_POOL_ALIGNMENT, psize, pool->log);
         if (m == NULL)
         {
                 return NULL;
@@ -202,9 +202,9 @@ yf_hnpool_t* yf_hnpool_create(yf_u32_t node_size
 
         node_size = yf_node_taken_size(node_size);
 
-        yf_hnpool_in_t* hnpool = yf_alloc(hnpool_size
+        yf_hnpool_in_t* hnpool = yf_page_alloc(hnpool_size
                         + node_pool_size + np_info_size
-                        + node_size * num_per_chunk);
+                        + (size_t)node_size * num_per_chunk, log);
         CHECK_RV(hnpool == NULL, NULL);
 
         hnpool->num_per_chunk = num_per_chunk;
@@ -260,7 +260,8 @@ void* yf_hnpool_alloc(yf_hnpool_t* hpool, yf_u64_t* id, yf_log_t* log)
                         
                         if (hp->used_chunk < hp->max_chunk) 
                         {
-                                char* mem = yf_alloc(hp->node_taken_size * hp->num_per_chunk);
+                                char* mem = yf_page_alloc((size_t)hp->node_taken_size 
+                                                * hp->num_per_chunk, log);
                                 CHECK_RV(mem == NULL, NULL);
                                 _yf_hnpool_init_child_pool(hp, mem, log);
 
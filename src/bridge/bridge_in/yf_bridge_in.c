@@ -38,45 +38,55 @@ static yf_bridge_creator_ptr yf_bridge_ci[16] =
 static void _bridge_task_timeout_handler(yf_tm_evt_t* evt, yf_time_t* start);
 
 
-//if dispatch_func == NULL, then the idle child will deal the task, else
-//the dispated target child will deal the task
-yf_bridge_t* yf_bridge_create(yf_bridge_cxt_t* bridge_ctx, yf_log_t* log)
+/*
+* the bridge with its per child arrays, task res buf and task ctx pool,
+* extra_size mem after them is ret by extra
+*/
+static yf_bridge_in_t* yf_bridge_alloc(yf_bridge_cxt_t* bridge_ctx
+                , yf_uint_t max_child_num, size_t extra_size, void** extra
+                , yf_log_t* log)
 {
         yf_bridge_in_t* bridge_in;
         yf_node_pool_t* node_pool;
-        yf_bridge_creator_ptr creator_pfc;
         
         size_t bridge_size = yf_align_mem(sizeof(yf_bridge_in_t));
         size_t task_buf_size = yf_align_mem(bridge_ctx->max_task_size);
 
         size_t task_cb_size = yf_node_taken_size(sizeof(yf_task_ctx_t));
 
-        CHECK_RV(bridge_ctx->child_num > YF_BRIDGE_MAX_CHILD_NUM 
-                        || bridge_ctx->child_num == 0, NULL);
+        size_t child_size = yf_align_mem(sizeof(char*) * max_child_num) 
+                        + yf_align_mem(sizeof(yf_uint_t) * max_child_num) 
+                        + yf_align_mem(sizeof(yf_task_queue_t*) * max_child_num) 
+                        + yf_align_mem(sizeof(yf_bridge_parent_stat_t) * max_child_num) 
+                        + yf_align_mem(sizeof(yf_bridge_child_stat_t) * max_child_num) 
+                        + yf_align_mem(sizeof(yf_bridge_res_batch_t) * max_child_num);
+        
+        size_t pool_size = yf_align_mem(bridge_ctx->max_task_num * task_cb_size);
         
-        bridge_in = yf_alloc(bridge_size + task_buf_size 
-                        + bridge_ctx->max_task_num * task_cb_size);
+        bridge_in = yf_alloc(bridge_size + child_size + task_buf_size 
+                        + pool_size + extra_size);
         
         CHECK_RV(bridge_in == NULL, NULL);
         
-        yf_memzero(bridge_in, sizeof(yf_bridge_in_t));
+        yf_memzero(bridge_in, bridge_size + child_size);
         yf_set_be_magic(bridge_in);
         
         bridge_in->ctx = *bridge_ctx;
-        bridge_ctx->queue_capacity = yf_align_mem(bridge_ctx->queue_capacity);
-        
-        if (bridge_ctx->max_task_size >= (bridge_ctx->queue_capacity>>2))
-        {
-                yf_log_error(YF_LOG_DEBUG, log, 0, 
-                        "max_task_size val=%d not right to queue cap=%d, reset to %d",
-                        bridge_ctx->max_task_size, 
-                        bridge_ctx->queue_capacity, 
-                        bridge_ctx->queue_capacity>>2);
-                
-                bridge_ctx->max_task_size = bridge_ctx->queue_capacity>>2;
-        }
-        
-        bridge_in->task_res_buf = (char*)bridge_in + bridge_size;
+        bridge_in->ctx.max_child_num = max_child_num;
+
+        bridge_in->task_buf = yf_mem_off(bridge_in, bridge_size);
+        bridge_in->task_execut = yf_mem_off(bridge_in->task_buf, 
+                        yf_align_mem(sizeof(char*) * max_child_num));
+        bridge_in->reserve_res_tq = yf_mem_off(bridge_in->task_execut, 
+                        yf_align_mem(sizeof(yf_uint_t) * max_child_num));
+        bridge_in->parent_stat = yf_mem_off(bridge_in->reserve_res_tq, 
+                        yf_align_mem(sizeof(yf_task_queue_t*) * max_child_num));
+        bridge_in->child_stat = yf_mem_off(bridge_in->parent_stat, 
+                        yf_align_mem(sizeof(yf_bridge_parent_stat_t) * max_child_num));
+        bridge_in->res_batch = yf_mem_off(bridge_in->child_stat, 
+                        yf_align_mem(sizeof(yf_bridge_child_stat_t) * max_child_num));
+
+        bridge_in->task_res_buf = (char*)bridge_in + bridge_size + child_size;
 
         node_pool = &bridge_in->task_cb_info_pool;
 
@@ -86,7 +96,80 @@ yf_bridge_t* yf_bridge_create(yf_bridge_cxt_t* bridge_ctx, yf_log_t* log)
 
         yf_init_node_pool(node_pool, log);
 
-        creator_pfc = yf_bridge_ci[yf_bridge_creator_index(bridge_ctx)];
+        if (extra)
+                *extra = yf_mem_off(node_pool->nodes_array, pool_size);
+        return bridge_in;
+}
+
+
+//if dispatch_func == NULL, then the idle child will deal the task, else
+//the dispated target child will deal the task
+yf_bridge_t* yf_bridge_create(yf_bridge_cxt_t* bridge_ctx, yf_log_t* log)
+{
+        yf_bridge_in_t* bridge_in;
+        yf_bridge_creator_ptr creator_pfc;
+        size_t lane_capacity;
+        size_t parents_size = 0;
+        void* parents = NULL;
+        //normalized here, the caller's ctx never changed
+        yf_bridge_cxt_t  ctx = *bridge_ctx;
+
+        yf_uint_t max_child_num = bridge_ctx->max_child_num ? 
+                        bridge_ctx->max_child_num : bridge_ctx->child_num;
+
+        CHECK_RV(max_child_num > YF_BRIDGE_MAX_CHILD_NUM 
+                        || bridge_ctx->child_num > max_child_num
+                        || bridge_ctx->child_num == 0
+                        || bridge_ctx->max_parent_num > YF_BRIDGE_MAX_PARENT_NUM, NULL);
+
+        if (bridge_ctx->max_parent_num > 1)
+                parents_size = yf_align_mem(sizeof(yf_bridge_in_t*) * bridge_ctx->max_parent_num)
+                                + yf_align_mem(sizeof(yf_atomic_t) * bridge_ctx->max_parent_num)
+                                + bridge_ctx->max_parent_num;
+
+        ctx.queue_capacity = yf_align_mem(ctx.queue_capacity);
+
+        ctx.task_lane_num = yf_max(ctx.task_lane_num, 1);
+        ctx.task_lane_num = yf_min(ctx.task_lane_num, YF_TQ_MAX_LANE);
+        //each lane must hold the max task
+        lane_capacity = ctx.queue_capacity / ctx.task_lane_num;
+        
+        if (ctx.max_task_size >= (lane_capacity>>2))
+        {
+                yf_log_error(YF_LOG_DEBUG, log, 0, 
+                        "max_task_size val=%d not right to queue cap=%d, lanes=%d, reset to %d",
+                        ctx.max_task_size, 
+                        ctx.queue_capacity, 
+                        ctx.task_lane_num, 
+                        lane_capacity>>2);
+                
+                ctx.max_task_size = lane_capacity>>2;
+        }
+
+        bridge_in = yf_bridge_alloc(&ctx, max_child_num, 
+                        parents_size, &parents, log);
+        CHECK_RV(bridge_in == NULL, NULL);
+
+        if (parents_size)
+        {
+                yf_memzero(parents, parents_size);
+                bridge_in->parents = parents;
+                bridge_in->parent_refs = yf_mem_off(parents, yf_align_mem(
+                                sizeof(yf_bridge_in_t*) * bridge_ctx->max_parent_num));
+                bridge_in->parent_used = yf_mem_off(bridge_in->parent_refs, yf_align_mem(
+                                sizeof(yf_atomic_t) * bridge_ctx->max_parent_num));
+                bridge_in->parents[0] = bridge_in;
+                bridge_in->parent_used[0] = 1;
+                bridge_in->parent_num = 1;
+                yf_lock_init(&bridge_in->parent_lock);
+        }
+
+        if (yf_bridge_res_batched(bridge_in) && bridge_in->ctx.res_batch_ms == 0)
+                bridge_in->ctx.res_batch_ms = 1;
+        bridge_in->dispatch_seed = (yf_u32_t)yf_now_times.clock_time.tv_sec 
+                        ^ (yf_u32_t)(yf_uint_ptr_t)bridge_in;
+
+        creator_pfc = yf_bridge_ci[yf_bridge_creator_index(&ctx)];
         
         if (creator_pfc == NULL)
         {
@@ -114,7 +197,8 @@ yf_int_t  yf_bridge_destory(yf_bridge_t* bridge, yf_log_t* log)
         bridge_in->destory(bridge_in, log);
 
         //TODO, fix bug here...
-        if (bridge_in->ctx.child_ins_type == YF_BRIDGE_INS_PROC)
+        if (bridge_in->ctx.child_ins_type == YF_BRIDGE_INS_PROC 
+                        || bridge_in->parent_no)
                 yf_free(bridge_in);
         return YF_OK;
 }
@@ -128,6 +212,22 @@ yf_bridge_cxt_t* yf_bridge_ctx(yf_bridge_t* bridge)
 }
 
 
+static void  yf_bridge_hist_add(yf_bridge_hist_t* hist, yf_s64_t ms)
+{
+        yf_u32_t  index = 0;
+        yf_u64_t  val = yf_max(ms, 0);
+
+        hist->cnt++;
+        hist->sum_ms += val;
+        if (val > hist->max_ms)
+                hist->max_ms = val;
+
+        for (; val && index < YF_BRIDGE_HIST_BUCKETS - 1; val >>= 1)
+                ++index;
+        hist->buckets[index]++;
+}
+
+
 yf_int_t yf_attach_res_bridge(yf_bridge_t* bridge
                 , yf_evt_driver_t* evt_driver, yf_task_res_handle handler, yf_log_t* log)
 {
@@ -141,60 +241,357 @@ yf_int_t yf_attach_res_bridge(yf_bridge_t* bridge
 }
 
 
-//will return taskid>0 if success, else ret -1
-yf_u64_t yf_send_task(yf_bridge_t* bridge
-                , void* task, size_t len, yf_u32_t hash
-                , void* data, yf_u32_t timeout_ms, yf_log_t* log)
+static yf_int_t yf_bridge_parent_lock_res_tq(yf_bridge_in_t* bridge
+                , yf_task_queue_t** tq, yf_int_t* child_no, yf_log_t* log)
+{
+        *tq = bridge->res_tqs[*child_no];
+        return YF_OK;
+}
+
+
+static void yf_bridge_parent_res_signal(yf_bridge_in_t* bridge
+                , yf_task_queue_t* tq, yf_int_t child_no, yf_log_t* log)
+{
+        yf_trigger_user_evt(bridge->res_evt);
+}
+
+
+static void _bridge_parent_res_handler(yf_user_event_t* evt, yf_u64_t cnt)
+{
+        yf_int_t  i1;
+        yf_bridge_in_t* bridge_in = evt->data;
+
+        for (i1 = 0; i1 < bridge_in->ctx.child_num; i1++)
+                yf_bridge_on_task_res_valiable(bridge_in, i1, evt->log);
+}
+
+
+static void yf_bridge_parent_release(yf_bridge_in_t* bridge_in, yf_uint_t parent_no)
+{
+        yf_lock(&bridge_in->parent_lock);
+        bridge_in->parent_used[parent_no] = 0;
+        --bridge_in->parent_num;
+        yf_unlock(&bridge_in->parent_lock);
+}
+
+
+/*
+* attached parent, in its thread, wait its tasks done (res handled here,
+* its timers cant fire now), then unlink it, wait the childs sending res
+* to it unpin, free its res evt, the slot can be taken again
+*/
+static void yf_bridge_parent_destory(yf_bridge_in_t* parent, yf_log_t* log)
+{
+        yf_uint_t  i1, executing;
+        yf_uint_t  parent_no = parent->parent_no;
+        yf_bridge_in_t* bridge_in = parent->parents[0];
+
+        while (1)
+        {
+                executing = 0;
+                for (i1 = 0; i1 < parent->ctx.child_num; i1++)
+                {
+                        yf_bridge_on_task_res_valiable(parent, i1, log);
+                        executing += parent->task_execut[i1];
+                }
+                if (executing == 0)
+                        break;
+                yf_msleep(1);
+        }
+
+        bridge_in->parents[parent_no] = NULL;
+        yf_memory_barrier();
+
+        while (bridge_in->parent_refs[parent_no])
+                yf_sched_yield();
+
+        yf_free_user_evt(parent->res_evt);
+        yf_bridge_parent_release(bridge_in, parent_no);
+
+        yf_log_debug1(YF_LOG_DEBUG, log, 0, "parent_%d detached", parent_no);
+}
+
+
+yf_bridge_t* yf_attach_parent(yf_bridge_t* bridge
+                , yf_evt_driver_t* evt_driver, yf_task_res_handle handler, yf_log_t* log)
+{
+        yf_uint_t  i1, parent_no;
+        yf_bridge_in_t* parent;
+        char* extra;
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        assert(yf_check_be_magic(bridge_in));
+
+        yf_uint_t  child_num = bridge_in->ctx.max_child_num;
+        size_t  tq_size = yf_align_mem(bridge_in->ctx.queue_capacity);
+        size_t  tqs_size = yf_align_mem(sizeof(yf_task_queue_t*) * child_num);
+
+        if (bridge_in->parents == NULL 
+                        || bridge_in->ctx.child_ins_type != YF_BRIDGE_INS_THREAD)
+        {
+                yf_log_error(YF_LOG_WARN, log, 0, 
+                                "multi parents need max_parent_num > 1 and thread childs");
+                return NULL;
+        }
+
+        yf_lock(&bridge_in->parent_lock);
+        for (parent_no = 1; parent_no < bridge_in->ctx.max_parent_num; parent_no++)
+        {
+                if (!bridge_in->parent_used[parent_no])
+                {
+                        bridge_in->parent_used[parent_no] = 1;
+                        ++bridge_in->parent_num;
+                        break;
+                }
+        }
+        yf_unlock(&bridge_in->parent_lock);
+
+        if (parent_no >= bridge_in->ctx.max_parent_num)
+        {
+                yf_log_error(YF_LOG_WARN, log, 0, "max_parent_num=%d parents attached", 
+                                bridge_in->ctx.max_parent_num);
+                return NULL;
+        }
+
+        parent = yf_bridge_alloc(&bridge_in->ctx, child_num, 
+                        tqs_size + child_num * tq_size, (void**)&extra, log);
+        if (parent == NULL)
+        {
+                yf_bridge_parent_release(bridge_in, parent_no);
+                return NULL;
+        }
+
+        //res sent back to this parent at once
+        parent->ctx.res_batch_num = 0;
+        parent->ctx.res_batch_bytes = 0;
+
+        parent->bridge_data = bridge_in->bridge_data;
+        parent->blob_arena = bridge_in->blob_arena;
+        parent->parents = bridge_in->parents;
+        parent->parent_refs = bridge_in->parent_refs;
+        parent->parent_no = parent_no;
+        parent->task_cb_info_pool.pool_index = parent_no;
+        parent->dispatch_seed = bridge_in->dispatch_seed ^ parent_no;
+
+        parent->res_tqs = (yf_task_queue_t**)extra;
+        for (i1 = 0; i1 < child_num; i1++)
+        {
+                parent->res_tqs[i1] = yf_init_task_queue(
+                                extra + tqs_size + i1 * tq_size, tq_size, log);
+        }
+
+        //send to the same childs, res from them to self
+        parent->lock_tq = bridge_in->lock_tq;
+        parent->unlock_tq = bridge_in->unlock_tq;
+        parent->task_signal = bridge_in->task_signal;
+        parent->child_no = bridge_in->child_no;
+        parent->lock_res_tq = yf_bridge_parent_lock_res_tq;
+        parent->task_res_signal = yf_bridge_parent_res_signal;
+        parent->destory = yf_bridge_parent_destory;
+
+        parent->task_res_handler = handler;
+        parent->parent_evt_driver = evt_driver;
+
+        if (yf_alloc_user_evt(evt_driver, &parent->res_evt, log) != YF_OK)
+        {
+                yf_log_error(YF_LOG_WARN, log, 0, "alloc parent res evt failed");
+                yf_free(parent);
+                yf_bridge_parent_release(bridge_in, parent_no);
+                return NULL;
+        }
+        parent->res_evt->data = parent;
+        parent->res_evt->log = log;
+        parent->res_evt->user_evt_handler = _bridge_parent_res_handler;
+
+        //childs find it by the task id's parent no
+        yf_memory_barrier();
+        bridge_in->parents[parent_no] = parent;
+
+        yf_log_debug1(YF_LOG_DEBUG, log, 0, "parent_%d attached", parent_no);
+        return  (yf_bridge_t*)parent;
+}
+
+
+//outstanding tasks first, then pending bytes in its tq
+static yf_u64_t  yf_bridge_child_load(yf_bridge_in_t* bridge_in
+                , yf_int_t child_no, yf_log_t* log)
 {
-        yf_task_ctx_t* task_ctx;
-        task_info_t  task_info;
-        yf_u64_t  task_id;
-        yf_int_t  ret;
-        yf_int_t  child_no;
         yf_task_queue_t* tq = NULL;
-        
+        size_t  buf_size = 0;
+
+        if (bridge_in->lock_tq(bridge_in, &tq, &child_no, log) == YF_OK)
+        {
+                buf_size = yf_min(yf_task_lanes_size(tq), 0xffffffff);
+                if (bridge_in->unlock_tq)
+                        bridge_in->unlock_tq(bridge_in, tq, child_no, log);
+        }
+
+        return ((yf_u64_t)bridge_in->task_execut[child_no] << 32) | buf_size;
+}
+
+
+yf_int_t  yf_bridge_stat(yf_bridge_t* bridge, yf_int_t child_no
+                , yf_bridge_stat_t* stat, yf_log_t* log)
+{
+        yf_task_queue_t* tq = NULL;
+        yf_bridge_parent_stat_t* pstat;
+        yf_bridge_child_stat_t* cstat;
         yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
         assert(yf_check_be_magic(bridge_in));
 
-        if (unlikely(len > bridge_in->ctx.max_task_size))
+        if (child_no < 0 || child_no >= bridge_in->ctx.max_child_num)
         {
-                yf_log_error(YF_LOG_ERR, log, 0, "task len=%d too big > max_task_size=%d", 
-                                len, bridge_in->ctx.max_task_size);
-                return -1;
+                yf_log_error(YF_LOG_WARN, log, 0, "stat child_no=%d out of range", child_no);
+                return YF_ERROR;
+        }
+
+        pstat = bridge_in->parent_stat + child_no;
+        cstat = bridge_in->child_stat + child_no;
+
+        stat->sent = pstat->sent;
+        stat->push_fail = pstat->push_fail;
+        stat->timeout = pstat->timeout;
+        stat->cancelled = pstat->cancelled;
+        stat->round_trip = pstat->round_trip;
+
+        stat->received = cstat->received;
+        stat->expired = cstat->expired;
+        stat->res_push_fail = cstat->res_push_fail;
+        stat->parked = cstat->parked;
+        stat->wait = cstat->wait;
+        stat->service = cstat->service;
+
+        stat->executing = bridge_in->task_execut[child_no];
+        stat->queue_bytes = 0;
+
+        if (bridge_in->lock_tq(bridge_in, &tq, &child_no, log) == YF_OK)
+        {
+                stat->queue_bytes = yf_task_lanes_size(tq);
+                if (bridge_in->unlock_tq)
+                        bridge_in->unlock_tq(bridge_in, tq, child_no, log);
         }
+        return YF_OK;
+}
+
+
+static yf_int_t  yf_bridge_least_load(yf_bridge_in_t* bridge_in, yf_log_t* log)
+{
+        yf_int_t  i1, child_no = 0;
+        yf_u64_t  load, min_load = yf_bridge_child_load(bridge_in, 0, log);
+
+        for (i1 = 1; i1 < bridge_in->ctx.child_num; i1++)
+        {
+                load = yf_bridge_child_load(bridge_in, i1, log);
+                if (load < min_load)
+                {
+                        min_load = load;
+                        child_no = i1;
+                }
+        }
+        return child_no;
+}
+
+
+//xorshift, parent only
+static yf_u32_t  yf_bridge_rand(yf_bridge_in_t* bridge_in)
+{
+        yf_u32_t  x = bridge_in->dispatch_seed;
+        if (unlikely(x == 0))
+                x = 0x9e3779b9;
+
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        bridge_in->dispatch_seed = x;
+        return x;
+}
+
+
+static yf_int_t  yf_bridge_two_choice(yf_bridge_in_t* bridge_in, yf_log_t* log)
+{
+        yf_int_t  child_num = bridge_in->ctx.child_num;
+        yf_int_t  c1, c2;
+
+        if (child_num == 1)
+                return 0;
+
+        //two different childs
+        c1 = yf_bridge_rand(bridge_in) % child_num;
+        c2 = yf_bridge_rand(bridge_in) % (child_num - 1);
+        if (c2 >= c1)
+                ++c2;
+
+        return yf_bridge_child_load(bridge_in, c2, log) 
+                        < yf_bridge_child_load(bridge_in, c1, log) ? c2 : c1;
+}
+
+
+static yf_int_t  yf_send_task_lock(yf_bridge_in_t* bridge_in, yf_u32_t hash
+                , yf_task_queue_t** tq, yf_int_t* child_no, yf_log_t* log)
+{
+        yf_int_t  ret;
 
         //get child_no
         switch (bridge_in->ctx.task_dispatch_type)
         {
                 case YF_TASK_DISTPATCH_HASH_MOD:
-                        child_no = hash % bridge_in->ctx.child_num;
+                        *child_no = hash % bridge_in->ctx.child_num;
+                        break;
+                case YF_TASK_DISTPATCH_JUMP_HASH:
+                        *child_no = yf_jump_hash(hash, bridge_in->ctx.child_num);
+                        break;
+                case YF_TASK_DISTPATCH_LEAST_LOAD:
+                        *child_no = yf_bridge_least_load(bridge_in, log);
+                        break;
+                case YF_TASK_DISTPATCH_TWO_CHOICE:
+                        *child_no = yf_bridge_two_choice(bridge_in, log);
                         break;
                 default:
-                        child_no = YF_ANY_CHILD_NO;//default
+                        *child_no = YF_ANY_CHILD_NO;//default
                         break;
         }
 
+        ret = bridge_in->lock_tq(bridge_in, tq, child_no, log);
+        if (unlikely(ret != YF_OK))
+        {
+                yf_log_error(YF_LOG_WARN, log, 0, "lock tq failed");
+                return YF_ERROR;
+        }
+        assert(*child_no >= 0 && *child_no < bridge_in->ctx.child_num);
+        return YF_OK;
+}
+
+
+static void  yf_free_task_ctx(yf_bridge_in_t* bridge_in
+                , yf_task_ctx_t* task_ctx, yf_log_t* log)
+{
+        if (task_ctx->tm_evt)
+        {
+                yf_free_tm_evt(task_ctx->tm_evt);
+        }
+        yf_free_node_to_pool(&bridge_in->task_cb_info_pool, task_ctx, log);
+}
+
+
+//alloc task ctx and set its timer, fill task_info
+static yf_task_ctx_t* yf_send_task_ctx(yf_bridge_in_t* bridge_in
+                , yf_int_t child_no, void* data, yf_u32_t timeout_ms
+                , task_info_t* task_info, yf_log_t* log)
+{
+        yf_task_ctx_t* task_ctx;
+        yf_int_t  ret;
+
         task_ctx = yf_alloc_node_from_pool(&bridge_in->task_cb_info_pool, log);
         if (unlikely(task_ctx == NULL))
         {
                 yf_log_error(YF_LOG_WARN, log, 0, "alloc task cb failed");
-                return -1;
+                return NULL;
         }
 
         yf_memzero(task_ctx, sizeof(yf_task_ctx_t));
         task_ctx->data = data;
         task_ctx->bridge_in = bridge_in;
-        
-        task_id = yf_get_id_by_node(&bridge_in->task_cb_info_pool, task_ctx, log);
-        
-        ret = bridge_in->lock_tq(bridge_in, &tq, &child_no, log);
-        if (unlikely(ret != YF_OK))
-        {
-                yf_log_error(YF_LOG_WARN, log, 0, "lock tq failed");
-                goto failed;
-        }
-        assert(child_no >= 0 && child_no < bridge_in->ctx.child_num);
         task_ctx->child_no = child_no;
+        task_ctx->send_time = yf_now_times.clock_time;
 
         if (timeout_ms == 0 && bridge_in->ctx.child_ins_type == YF_BRIDGE_INS_PROC)
         {
@@ -210,7 +607,8 @@ yf_u64_t yf_send_task(yf_bridge_t* bridge
                 if (unlikely(ret != YF_OK))
                 {
                         yf_log_error(YF_LOG_WARN, log, 0, "alloc tm evt failed");
-                        goto failed;
+                        yf_free_task_ctx(bridge_in, task_ctx, log);
+                        return NULL;
                 }
 
                 yf_time_t  tm_set;
@@ -222,22 +620,53 @@ yf_u64_t yf_send_task(yf_bridge_t* bridge
                 assert(ret == YF_OK);
         }
 
-        yf_memzero_st(task_info);
+        yf_memzero(task_info, sizeof(task_info_t));
         
         //note, must use wall_time, cause cross proc maybe
-        yf_real_walltime(&task_info.inqueue_time);
-        task_info.id = task_id;
-        task_info.timeout_ms = yf_min(1<<20, timeout_ms);
+        yf_real_walltime(&task_info->inqueue_time);
+        task_info->id = yf_get_id_by_node(&bridge_in->task_cb_info_pool, task_ctx, log);
+        task_info->timeout_ms = yf_min(1<<20, timeout_ms);
+        return task_ctx;
+}
 
-        ret = yf_task_push(tq, &task_info, task, len, log);
-        if (unlikely(ret != YF_OK))
+
+//target child busy, ring a parked sibling, then it will steal the task
+static void  yf_bridge_wake_thief(yf_bridge_in_t* bridge_in
+                , yf_int_t child_no, yf_log_t* log)
+{
+        yf_int_t  i1, thief_no;
+        yf_task_queue_t* tq;
+
+        for (i1 = 1; i1 < bridge_in->ctx.child_num; i1++)
         {
-                yf_log_error(YF_LOG_WARN, log, 0, "yf_task_push failed");
-                goto failed;
+                thief_no = (child_no + i1) % bridge_in->ctx.child_num;
+                bridge_in->lock_tq(bridge_in, &tq, &thief_no, log);
+
+                if (yf_task_need_signal(tq))
+                {
+                        yf_log_debug2(YF_LOG_DEBUG, log, 0, 
+                                        "child_%d busy, wake child_%d to steal", 
+                                        child_no, thief_no);
+                        bridge_in->task_signal(bridge_in, tq, thief_no, log);
+                        return;
+                }
         }
+}
+
+
+//task pushed, signal child and unlock
+static void  yf_send_task_done(yf_bridge_in_t* bridge_in, yf_task_queue_t* tq
+                , yf_int_t child_no, task_info_t* task_info, yf_log_t* log)
+{
+        bridge_in->parent_stat[child_no].sent++;
 
         if (bridge_in->task_signal)
-                bridge_in->task_signal(bridge_in, tq, child_no, log);
+        {
+                if (!yf_bridge_tq_spsc(bridge_in) || yf_task_need_signal(tq))
+                        bridge_in->task_signal(bridge_in, tq, child_no, log);
+                else if (yf_bridge_steal(bridge_in))
+                        yf_bridge_wake_thief(bridge_in, child_no, log);
+        }
 
         if (bridge_in->unlock_tq)
                 bridge_in->unlock_tq(bridge_in, tq, child_no, log);
@@ -246,40 +675,466 @@ yf_u64_t yf_send_task(yf_bridge_t* bridge
 
         yf_log_debug5(YF_LOG_DEBUG, log, 0, 
                         "task id=%L send to child_%d success, time=[%d-%d], executing=%d", 
-                        task_id, child_no, 
-                        task_info.inqueue_time.tv_sec, task_info.inqueue_time.tv_msec,
+                        task_info->id, child_no, 
+                        task_info->inqueue_time.tv_sec, task_info->inqueue_time.tv_msec,
                         bridge_in->task_execut[child_no]);
-        return task_id;
+}
 
-failed:
-        if (task_ctx->tm_evt)
+
+//will return taskid>0 if success, else ret -1
+yf_u64_t yf_send_task_pri(yf_bridge_t* bridge
+                , void* task, size_t len, yf_u32_t hash, yf_u32_t priority
+                , void* data, yf_u32_t timeout_ms, yf_log_t* log)
+{
+        yf_task_ctx_t* task_ctx;
+        task_info_t  task_info;
+        yf_int_t  ret;
+        yf_int_t  child_no;
+        yf_task_queue_t* tq = NULL;
+        yf_u32_t  blob = 0;
+        char* blob_buf;
+
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        assert(yf_check_be_magic(bridge_in));
+
+        if (unlikely(len > bridge_in->ctx.max_task_size 
+                        && bridge_in->blob_arena == NULL))
         {
-                yf_free_tm_evt(task_ctx->tm_evt);
+                yf_log_error(YF_LOG_ERR, log, 0, "task len=%d too big > max_task_size=%d", 
+                                len, bridge_in->ctx.max_task_size);
+                return -1;
         }
-        yf_free_node_to_pool(&bridge_in->task_cb_info_pool, task_ctx, log);
-        
-        if (tq && bridge_in->unlock_tq)
+
+        CHECK_RV(yf_send_task_lock(bridge_in, hash, &tq, &child_no, log) != YF_OK, -1);
+
+        task_ctx = yf_send_task_ctx(bridge_in, child_no, data, timeout_ms, 
+                        &task_info, log);
+        if (unlikely(task_ctx == NULL))
+                goto failed;
+        task_ctx->priority = priority;
+
+        //too big, copy to a blob, queue the handle
+        if (unlikely(len > bridge_in->ctx.max_task_size))
+        {
+                blob_buf = yf_blob_alloc(bridge_in->blob_arena, len, 
+                                task_info.id, &blob, log);
+                if (unlikely(blob_buf == NULL))
+                {
+                        bridge_in->parent_stat[child_no].push_fail++;
+                        yf_free_task_ctx(bridge_in, task_ctx, log);
+                        goto failed;
+                }
+
+                yf_memcpy(blob_buf, task, len);
+                task_ctx->blob = blob;
+                task_info.blob = 1;
+                task = &blob;
+                len = sizeof(blob);
+        }
+
+        //doorbell always on the base lane
+        if (yf_bridge_tq_mpsc(bridge_in))
+                ret = yf_task_push_mp(yf_tq_lane(tq, priority), &task_info, task, len, log);
+        else
+                ret = yf_task_push(yf_tq_lane(tq, priority), &task_info, task, len, log);
+        if (unlikely(ret != YF_OK))
+        {
+                bridge_in->parent_stat[child_no].push_fail++;
+                yf_log_error(YF_LOG_WARN, log, 0, "yf_task_push failed");
+                if (blob)
+                        yf_blob_free(bridge_in->blob_arena, blob);
+                yf_free_task_ctx(bridge_in, task_ctx, log);
+                goto failed;
+        }
+
+        yf_send_task_done(bridge_in, tq, child_no, &task_info, log);
+        return task_info.id;
+
+failed:
+        if (bridge_in->unlock_tq)
                 bridge_in->unlock_tq(bridge_in, tq, child_no, log);
         return -1;
 }
 
 
-//if in block type, call this will block, else will ret quickly with no effects
-void yf_poll_task_res(yf_bridge_t* bridge, yf_log_t* log)
+void* yf_send_task_reserve(yf_bridge_t* bridge
+                , size_t len, yf_u32_t hash, yf_log_t* log)
+{
+        char* task;
+        yf_int_t  child_no;
+        yf_task_queue_t* tq = NULL;
+
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        assert(yf_check_be_magic(bridge_in));
+        assert(bridge_in->reserve_tq == NULL);
+
+        if (unlikely(yf_bridge_tq_mpsc(bridge_in)))
+        {
+                yf_log_error(YF_LOG_ERR, log, 0, "zero copy send not for multi parents");
+                return NULL;
+        }
+
+        if (unlikely(len > bridge_in->ctx.max_task_size))
+        {
+                yf_log_error(YF_LOG_ERR, log, 0, "task len=%d too big > max_task_size=%d", 
+                                len, bridge_in->ctx.max_task_size);
+                return NULL;
+        }
+
+        CHECK_RV(yf_send_task_lock(bridge_in, hash, &tq, &child_no, log) != YF_OK, NULL);
+
+        task = yf_task_reserve(yf_tq_lane(tq, YF_TASK_PRI_NORMAL), len, log);
+        if (unlikely(task == NULL))
+        {
+                bridge_in->parent_stat[child_no].push_fail++;
+                if (bridge_in->unlock_tq)
+                        bridge_in->unlock_tq(bridge_in, tq, child_no, log);
+                return NULL;
+        }
+
+        bridge_in->reserve_tq = tq;
+        bridge_in->reserve_child_no = child_no;
+        return task;
+}
+
+
+yf_u64_t yf_send_task_commit(yf_bridge_t* bridge
+                , size_t len, void* data, yf_u32_t timeout_ms, yf_log_t* log)
+{
+        yf_task_ctx_t* task_ctx;
+        task_info_t  task_info;
+
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        assert(yf_check_be_magic(bridge_in));
+
+        yf_task_queue_t* tq = bridge_in->reserve_tq;
+        yf_int_t  child_no = bridge_in->reserve_child_no;
+        assert(tq);
+        bridge_in->reserve_tq = NULL;
+
+        task_ctx = yf_send_task_ctx(bridge_in, child_no, data, timeout_ms, 
+                        &task_info, log);
+        if (unlikely(task_ctx == NULL))
+        {
+                //reserved room not published, just drop it
+                if (bridge_in->unlock_tq)
+                        bridge_in->unlock_tq(bridge_in, tq, child_no, log);
+                return -1;
+        }
+        task_ctx->priority = YF_TASK_PRI_NORMAL;
+
+        yf_task_commit(yf_tq_lane(tq, YF_TASK_PRI_NORMAL), &task_info, len, log);
+
+        yf_send_task_done(bridge_in, tq, child_no, &task_info, log);
+        return task_info.id;
+}
+
+
+//a removed child gets no new task, its last task done, it can be retired
+static void  yf_bridge_task_done(yf_bridge_in_t* bridge_in
+                , yf_int_t child_no, yf_log_t* log)
+{
+        bridge_in->task_execut[child_no] -= 1;
+
+        if (bridge_in->task_execut[child_no] == 0 
+                        && child_no >= (yf_int_t)bridge_in->ctx.child_num
+                        && bridge_in->child_idle)
+                bridge_in->child_idle(bridge_in, child_no, log);
+}
+
+
+//mark the task dead in its child's tq, the child skip it if not taken yet
+static void  yf_bridge_cancel_queued(yf_bridge_in_t* bridge_in
+                , yf_task_ctx_t* task_ctx, yf_u64_t task_id, yf_log_t* log)
+{
+        yf_task_queue_t* tq = NULL;
+        yf_int_t  child_no = task_ctx->child_no;
+
+        if (unlikely(bridge_in->lock_tq(bridge_in, &tq, &child_no, log) != YF_OK))
+                return;
+
+        yf_task_cancel(yf_tq_lane(tq, task_ctx->priority), task_id);
+
+        if (bridge_in->unlock_tq)
+                bridge_in->unlock_tq(bridge_in, tq, child_no, log);
+
+        //not taken by the child yet, then it never will
+        if (task_ctx->blob && yf_blob_reclaim(bridge_in->blob_arena, 
+                        task_ctx->blob, task_id) == YF_OK)
+        {
+                yf_log_debug2(YF_LOG_DEBUG, log, 0, "task id=%L blob=%d reclaimed", 
+                                task_id, task_ctx->blob);
+        }
+}
+
+
+yf_int_t yf_cancel_task(yf_bridge_t* bridge, yf_u64_t task_id, yf_log_t* log)
+{
+        yf_task_ctx_t* task_ctx;
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        assert(yf_check_be_magic(bridge_in));
+
+        //the id of failed send
+        if (unlikely(task_id == (yf_u64_t)-1))
+                return YF_ERROR;
+
+        //caller's id, not trusted, must be of this parent's pool
+        if (unlikely(yf_bridge_parent_no(task_id) != bridge_in->parent_no
+                        || ((task_id >> 32) & ((1<<24)-1)) 
+                                >= bridge_in->task_cb_info_pool.total_num))
+        {
+                yf_log_error(YF_LOG_WARN, log, 0, "cancel task id=%L invalid, parent_%d", 
+                                task_id, bridge_in->parent_no);
+                return YF_ERROR;
+        }
+
+        task_ctx = yf_get_node_by_id(&bridge_in->task_cb_info_pool, task_id, log);
+        if (task_ctx == NULL)
+        {
+                yf_log_debug1(YF_LOG_DEBUG, log, 0, "cancel task id=%L not found", task_id);
+                return YF_ERROR;
+        }
+
+        yf_bridge_cancel_queued(bridge_in, task_ctx, task_id, log);
+        yf_bridge_task_done(bridge_in, task_ctx->child_no, log);
+        bridge_in->parent_stat[task_ctx->child_no].cancelled++;
+
+        yf_log_debug2(YF_LOG_DEBUG, log, 0, "task id=%L cancelled, child_%d", 
+                        task_id, task_ctx->child_no);
+
+        yf_free_task_ctx(bridge_in, task_ctx, log);
+        return YF_OK;
+}
+
+
+//if in block type, call this will block, else will ret quickly with no effects
+void yf_poll_task_res(yf_bridge_t* bridge, yf_log_t* log)
+{
+        yf_int_t  child_no;
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        assert(yf_check_be_magic(bridge_in));
+
+        if (bridge_in->wait_task_res == NULL)
+                return;
+        
+        bridge_in->wait_task_res(bridge_in, &child_no, log);
+        if (child_no < 0)
+                return;
+
+        yf_log_debug1(YF_LOG_DEBUG, log, 0, "poll task res, child_%d ret res", child_no);
+        yf_bridge_on_task_res_valiable(bridge_in, child_no, log);
+}
+
+
+yf_int_t yf_bridge_resize(yf_bridge_t* bridge, yf_uint_t child_num, yf_log_t* log)
+{
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        assert(yf_check_be_magic(bridge_in));
+
+        if (bridge_in->resize == NULL || bridge_in->parents)
+        {
+                yf_log_error(YF_LOG_WARN, log, 0, "bridge type cant be resized");
+                return YF_ERROR;
+        }
+        if (child_num == 0 || child_num > bridge_in->ctx.max_child_num)
+        {
+                yf_log_error(YF_LOG_WARN, log, 0, "resize child_num=%d not in [1, %d]", 
+                                child_num, bridge_in->ctx.max_child_num);
+                return YF_ERROR;
+        }
+
+        if (child_num != bridge_in->ctx.child_num)
+        {
+                yf_log_error(YF_LOG_NOTICE, log, 0, "bridge resize child_num %d->%d", 
+                                bridge_in->ctx.child_num, child_num);
+        }
+        return bridge_in->resize(bridge_in, child_num, log);
+}
+
+
+static void _bridge_elastic_handler(yf_tm_evt_t* evt, yf_time_t* start)
+{
+        yf_uint_t  i1, executing = 0;
+        yf_time_t  tm_check;
+        yf_bridge_in_t* bridge_in = evt->data;
+        yf_bridge_elastic_t* elastic = &bridge_in->elastic;
+        yf_uint_t  child_num = bridge_in->ctx.child_num;
+
+        for (i1 = 0; i1 < child_num; i1++)
+                executing += bridge_in->task_execut[i1];
+
+        //no res come back, latency is out of date
+        if (bridge_in->res_num == 0 && executing == 0)
+                bridge_in->latency_ms = 0;
+        bridge_in->res_num = 0;
+
+        if ((elastic->up_tasks && executing > elastic->up_tasks * child_num)
+                || (elastic->up_latency_ms 
+                        && bridge_in->latency_ms > elastic->up_latency_ms))
+        {
+                if (child_num < elastic->max_child_num)
+                        ++child_num;
+        }
+        else if ((elastic->down_tasks || elastic->down_latency_ms)
+                && (!elastic->down_tasks 
+                        || executing < elastic->down_tasks * child_num)
+                && (!elastic->down_latency_ms 
+                        || bridge_in->latency_ms < elastic->down_latency_ms))
+        {
+                if (child_num > elastic->min_child_num)
+                        --child_num;
+        }
+
+        yf_log_debug4(YF_LOG_DEBUG, evt->log, 0, 
+                        "elastic check, executing=%d, latency=%d, child_num %d->%d", 
+                        executing, bridge_in->latency_ms, 
+                        bridge_in->ctx.child_num, child_num);
+
+        //called even not changed, removed child may be retired now
+        yf_bridge_resize((yf_bridge_t*)bridge_in, child_num, evt->log);
+
+        yf_ms_2_time(elastic->check_ms, &tm_check);
+        yf_register_tm_evt(evt, &tm_check);
+}
+
+
+yf_int_t yf_bridge_set_elastic(yf_bridge_t* bridge
+                , yf_bridge_elastic_t* elastic, yf_log_t* log)
+{
+        yf_time_t  tm_check;
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        assert(yf_check_be_magic(bridge_in));
+
+        if (bridge_in->resize == NULL || bridge_in->parent_evt_driver == NULL
+                        || bridge_in->parents)
+        {
+                yf_log_error(YF_LOG_WARN, log, 0, 
+                                "elastic need resizable bridge and evt drived parent");
+                return YF_ERROR;
+        }
+
+        bridge_in->elastic = *elastic;
+        elastic = &bridge_in->elastic;
+
+        if (elastic->max_child_num == 0 
+                        || elastic->max_child_num > bridge_in->ctx.max_child_num)
+                elastic->max_child_num = bridge_in->ctx.max_child_num;
+        elastic->min_child_num = yf_max(elastic->min_child_num, 1);
+        elastic->min_child_num = yf_min(elastic->min_child_num, elastic->max_child_num);
+        if (elastic->check_ms == 0)
+                elastic->check_ms = 1000;
+
+        if (bridge_in->elastic_evt == NULL)
+        {
+                CHECK_OK(yf_alloc_tm_evt(bridge_in->parent_evt_driver, 
+                                &bridge_in->elastic_evt, log));
+                bridge_in->elastic_evt->data = bridge_in;
+                bridge_in->elastic_evt->timeout_handler = _bridge_elastic_handler;
+        }
+
+        yf_ms_2_time(elastic->check_ms, &tm_check);
+        return yf_register_tm_evt(bridge_in->elastic_evt, &tm_check);
+}
+
+
+//fail the tasks the dead child taken but not answered, queued ones left
+//for the new child (see yf_bridge_fail_queued if no new one); cancel the
+//taken one, it may be the killer, and its res sent before death (if any)
+//just dropped
+void  yf_bridge_fail_inflight(yf_bridge_in_t* bridge_in
+                , yf_int_t child_no, yf_log_t* log)
+{
+        yf_uint_t  i1;
+        yf_u64_t  task_id;
+        yf_task_ctx_t* task_ctx;
+        yf_bridge_inflight_t* inflight;
+
+        if (bridge_in->inflight == NULL)
+                return;
+
+        inflight = bridge_in->inflight + child_no;
+        if (inflight->blob)
+        {
+                yf_blob_free(bridge_in->blob_arena, inflight->blob);
+                inflight->blob = 0;
+        }
+
+        for (i1 = 0; i1 < YF_BRIDGE_INFLIGHT_SLOTS; i1++)
+        {
+                task_id = inflight->ids[i1];
+                if (task_id == 0)
+                        continue;
+                inflight->ids[i1] = 0;
+
+                //res handled, timeout or cancelled already
+                task_ctx = yf_get_node_by_id(&bridge_in->task_cb_info_pool, task_id, log);
+                if (task_ctx == NULL || task_ctx->child_no != child_no)
+                        continue;
+
+                bridge_in->task_execut[child_no] -= 1;
+                yf_bridge_cancel_queued(bridge_in, task_ctx, task_id, log);
+
+                yf_log_error(YF_LOG_WARN, log, 0, 
+                                "fail task id=%L taken by dead child_%d, execute=%d", 
+                                task_id, child_no, bridge_in->task_execut[child_no]);
+
+                bridge_in->task_res_handler((yf_bridge_t*)bridge_in, 
+                                NULL, 0, task_id, 
+                                YF_TASK_ERROR, task_ctx->data, log);
+
+                yf_free_task_ctx(bridge_in, task_ctx, log);
+        }
+}
+
+
+//the dead child removed, no one take its queued tasks, pop and fail them
+void  yf_bridge_fail_queued(yf_bridge_in_t* bridge_in
+                , yf_int_t child_no, yf_log_t* log)
 {
-        yf_int_t  child_no;
-        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
-        assert(yf_check_be_magic(bridge_in));
+        yf_u32_t  i1;
+        task_info_t  task_info;
+        yf_task_ctx_t* task_ctx;
+        yf_task_queue_t* tq = NULL;
+        size_t  task_len;
+        yf_int_t  tq_no = child_no;
 
-        if (bridge_in->wait_task_res == NULL)
-                return;
-        
-        bridge_in->wait_task_res(bridge_in, &child_no, log);
-        if (child_no < 0)
+        if (unlikely(bridge_in->lock_tq(bridge_in, &tq, &tq_no, log) != YF_OK))
                 return;
 
-        yf_log_debug1(YF_LOG_DEBUG, log, 0, "poll task res, child_%d ret res", child_no);
-        yf_bridge_on_task_res_valiable(bridge_in, child_no, log);
+        for (i1 = 0; i1 < tq->lane_num; i1++)
+        {
+                while (1)
+                {
+                        task_len = bridge_in->ctx.max_task_size;
+                        if (yf_task_pop(yf_tq_lane(tq, i1), &task_info, 
+                                        bridge_in->task_res_buf, &task_len, log) != YF_OK)
+                                break;
+
+                        //cancelled or timeout already
+                        task_ctx = yf_get_node_by_id(&bridge_in->task_cb_info_pool, 
+                                        task_info.id, log);
+                        if (task_ctx == NULL || task_ctx->child_no != child_no)
+                                continue;
+
+                        bridge_in->task_execut[child_no] -= 1;
+                        if (task_ctx->blob)
+                                yf_blob_reclaim(bridge_in->blob_arena, 
+                                                task_ctx->blob, task_info.id);
+
+                        yf_log_error(YF_LOG_WARN, log, 0, 
+                                        "fail task id=%L queued to removed child_%d, execute=%d", 
+                                        task_info.id, child_no, bridge_in->task_execut[child_no]);
+
+                        bridge_in->task_res_handler((yf_bridge_t*)bridge_in, 
+                                        NULL, 0, task_info.id, 
+                                        YF_TASK_ERROR, task_ctx->data, log);
+
+                        yf_free_task_ctx(bridge_in, task_ctx, log);
+                }
+        }
+
+        if (bridge_in->unlock_tq)
+                bridge_in->unlock_tq(bridge_in, tq, tq_no, log);
 }
 
 
@@ -292,8 +1147,10 @@ static void _bridge_task_timeout_handler(yf_tm_evt_t* evt, yf_time_t* start)
         yf_u64_t task_id = yf_get_id_by_node(&bridge_in->task_cb_info_pool, 
                         task_ctx, evt->log);
 
-        // 1
-        bridge_in->task_execut[task_ctx->child_no] -= 1;
+        // 1, nobody wait it now
+        yf_bridge_task_done(bridge_in, task_ctx->child_no, evt->log);
+        bridge_in->parent_stat[task_ctx->child_no].timeout++;
+        yf_bridge_cancel_queued(bridge_in, task_ctx, task_id, evt->log);
 
         yf_log_error(YF_LOG_WARN, evt->log, 0, 
                         "timeout task id=%L by child_%d timeout arrive, execute=%d", 
@@ -315,6 +1172,139 @@ static void _bridge_task_timeout_handler(yf_tm_evt_t* evt, yf_time_t* start)
 * ------child's api------
 */
 
+static void  yf_bridge_res_batch_reset(yf_bridge_res_batch_t* batch)
+{
+        if (batch->tm_evt)
+                yf_unregister_tm_evt(batch->tm_evt);
+        batch->num = 0;
+        batch->bytes = 0;
+}
+
+
+//the first pending res waited res_batch_ms, by real time, the cached one
+//not updated while the child busy
+static yf_int_t  yf_bridge_res_batch_due(yf_bridge_in_t* bridge_in
+                , yf_bridge_res_batch_t* batch)
+{
+        yf_time_t  now;
+
+        yf_real_walltime(&now);
+        return yf_time_diff_ms(&now, &batch->first_time) 
+                        >= (yf_s64_t)bridge_in->ctx.res_batch_ms;
+}
+
+
+//res pushed with res tq locked, signal the parent now, or later if batched
+static void  yf_bridge_res_signal(yf_bridge_in_t* bridge_in, yf_task_queue_t* tq
+                , yf_int_t child_no, yf_bridge_res_batch_t* batch
+                , size_t len, yf_log_t* log)
+{
+        yf_time_t  tm;
+
+        if (bridge_in->task_res_signal == NULL)
+                return;
+
+        if (yf_bridge_res_batched(bridge_in))
+        {
+                if (batch->num++ == 0)
+                {
+                        yf_real_walltime(&batch->first_time);
+                        if (batch->tm_evt)
+                        {
+                                yf_ms_2_time(bridge_in->ctx.res_batch_ms, &tm);
+                                yf_register_tm_evt(batch->tm_evt, &tm);
+                        }
+                }
+                batch->bytes += len;
+
+                if ((bridge_in->ctx.res_batch_num == 0 
+                                        || batch->num < bridge_in->ctx.res_batch_num)
+                                && (bridge_in->ctx.res_batch_bytes == 0 
+                                        || batch->bytes < bridge_in->ctx.res_batch_bytes)
+                                && !yf_bridge_res_batch_due(bridge_in, batch))
+                        return;
+
+                yf_log_debug2(YF_LOG_DEBUG, log, 0, "flush res batch num=%d, bytes=%d", 
+                                batch->num, batch->bytes);
+                yf_bridge_res_batch_reset(batch);
+        }
+
+        if (!yf_bridge_rtq_spsc(bridge_in) || yf_task_need_signal(tq))
+                bridge_in->task_res_signal(bridge_in, tq, child_no, log);
+}
+
+
+//signal the parent for the pending res, child call
+static void  yf_bridge_flush_res(yf_bridge_in_t* bridge_in
+                , yf_int_t child_no, yf_log_t* log)
+{
+        yf_task_queue_t* tq = NULL;
+        yf_bridge_res_batch_t* batch = bridge_in->res_batch + child_no;
+
+        if (batch->num == 0)
+                return;
+
+        if (unlikely(bridge_in->lock_res_tq(bridge_in, &tq, &child_no, log) != YF_OK))
+                return;
+
+        yf_log_debug2(YF_LOG_DEBUG, log, 0, "flush res batch num=%d, bytes=%d", 
+                        batch->num, batch->bytes);
+        yf_bridge_res_batch_reset(batch);
+
+        if (!yf_bridge_rtq_spsc(bridge_in) || yf_task_need_signal(tq))
+                bridge_in->task_res_signal(bridge_in, tq, child_no, log);
+
+        if (bridge_in->unlock_res_tq)
+                bridge_in->unlock_res_tq(bridge_in, tq, child_no, log);
+}
+
+
+static void _bridge_res_batch_handler(yf_tm_evt_t* evt, yf_time_t* start)
+{
+        yf_bridge_in_t* bridge_in = evt->data;
+
+        yf_bridge_flush_res(bridge_in, 
+                        bridge_in->child_no(bridge_in, evt->log), evt->log);
+}
+
+
+//full slots, the task just left to the parent's timer
+static void  yf_bridge_inflight_add(yf_bridge_in_t* bridge_in
+                , yf_int_t child_no, yf_u64_t id)
+{
+        yf_uint_t  i1, slot;
+        yf_bridge_inflight_t* inflight = bridge_in->inflight + child_no;
+
+        for (i1 = 0; i1 < YF_BRIDGE_INFLIGHT_SLOTS; i1++)
+        {
+                slot = (id + i1) % YF_BRIDGE_INFLIGHT_SLOTS;
+                if (inflight->ids[slot] == 0)
+                {
+                        inflight->ids[slot] = id;
+                        return;
+                }
+        }
+}
+
+
+static void  yf_bridge_inflight_del(yf_bridge_in_t* bridge_in
+                , yf_int_t child_no, yf_u64_t id)
+{
+        yf_uint_t  i1, slot;
+        yf_bridge_inflight_t* inflight = bridge_in->inflight + child_no;
+
+        for (i1 = 0; i1 < YF_BRIDGE_INFLIGHT_SLOTS; i1++)
+        {
+                slot = (id + i1) % YF_BRIDGE_INFLIGHT_SLOTS;
+                if (inflight->ids[slot] == id)
+                {
+                        inflight->ids[slot] = 0;
+                        return;
+                }
+        }
+}
+
+
 yf_int_t  yf_bridge_child_no(yf_bridge_t* bridge, yf_log_t* log)
 {
         yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
@@ -322,6 +1312,32 @@ yf_int_t  yf_bridge_child_no(yf_bridge_t* bridge, yf_log_t* log)
         return  bridge_in->child_no(bridge_in, log);
 }
 
+//cross node tq traffic cost much on multi sockets, so the tq go with the child
+static void  yf_bridge_bind_child(yf_bridge_in_t* bridge_in
+                , yf_int_t child_no, yf_log_t* log)
+{
+        yf_int_t  node;
+        yf_task_queue_t* tq = NULL;
+        char* cpus = bridge_in->ctx.child_cpus[
+                        child_no % yf_max(bridge_in->ctx.child_cpu_num, 1)];
+
+        if (cpus == NULL || yf_bind_cpus(cpus, log) != YF_OK)
+                return;
+
+        node = yf_cur_numa_node();
+        if (node < 0 || !yf_bridge_tq_spsc(bridge_in))
+                return;
+
+        if (bridge_in->lock_tq(bridge_in, &tq, &child_no, log) != YF_OK)
+                return;
+
+        yf_prefer_numa_node(tq, bridge_in->ctx.queue_capacity, node, log);
+
+        yf_log_debug3(YF_LOG_DEBUG, log, 0, "child_%d bind cpus=%s, node=%d", 
+                        child_no, cpus, node);
+}
+
+
 //child call this after born and init
 //if in block type, set evt_driver=NULL
 yf_int_t yf_attach_bridge(yf_bridge_t* bridge
@@ -351,6 +1367,21 @@ yf_int_t yf_attach_bridge(yf_bridge_t* bridge
 
         bridge_in->task_handler = handler;
 
+        if (bridge_in->ctx.child_cpus)
+                yf_bridge_bind_child(bridge_in, child_no, log);
+
+        //blocked childs flush before wait
+        if (yf_bridge_res_batched(bridge_in) && evt_driver 
+                        && bridge_in->res_batch[child_no].tm_evt == NULL)
+        {
+                if (yf_alloc_tm_evt(evt_driver, &bridge_in->res_batch[child_no].tm_evt, 
+                                log) != YF_OK)
+                        return YF_ERROR;
+                bridge_in->res_batch[child_no].tm_evt->data = bridge_in;
+                bridge_in->res_batch[child_no].tm_evt->timeout_handler 
+                                = _bridge_res_batch_handler;
+        }
+
         if (bridge_in->ctx.child_ins_type == YF_BRIDGE_INS_PROC)
                 bridge_in->task_buf[child_no] = bridge_in->task_res_buf;
         else //TODO, free...
@@ -382,14 +1413,53 @@ void yf_poll_task(yf_bridge_t* bridge, yf_log_t* log)
 }
 
 
+static yf_int_t yf_send_task_res_to(yf_bridge_in_t* bridge_in
+                , void* task_res, size_t len, task_info_t* task_info, yf_log_t* log);
+
 //if task_res==NULLL or len==0, then no res body
 yf_int_t yf_send_task_res_in(yf_bridge_in_t* bridge_in
                 , void* task_res, size_t len, task_info_t* task_info, yf_log_t* log)
 {
-        yf_task_ctx_t* task_ctx;
+        yf_int_t  ret;
+        yf_bridge_in_t* parent;
+        yf_uint_t  parent_no;
+
+        if (bridge_in->parents == NULL 
+                        || (parent_no = yf_bridge_parent_no(task_info->id)) == 0)
+                return yf_send_task_res_to(bridge_in, task_res, len, task_info, log);
+
+        //res go back to the parent sent the task, pinned, so not freed then
+        yf_atomic_fetch_add(bridge_in->parent_refs + parent_no, 1);
+
+        parent = bridge_in->parents[parent_no];
+        if (parent)
+                ret = yf_send_task_res_to(parent, task_res, len, task_info, log);
+        else {
+                yf_log_error(YF_LOG_WARN, log, 0, 
+                                "task res id=%L dropped, parent_%d detached", 
+                                task_info->id, parent_no);
+                ret = YF_ERROR;
+        }
+
+        yf_atomic_fetch_sub(bridge_in->parent_refs + parent_no, 1);
+        return ret;
+}
+
+
+static yf_int_t yf_send_task_res_to(yf_bridge_in_t* bridge_in
+                , void* task_res, size_t len, task_info_t* task_info, yf_log_t* log)
+{
         yf_int_t  ret;
         yf_task_queue_t* tq = NULL;
-        yf_int_t child_no = bridge_in->child_no(bridge_in, log);
+        yf_u32_t  blob = 0;
+        char* blob_buf;
+        yf_int_t  child_no;
+        yf_bridge_child_stat_t* cstat;
+        yf_bridge_res_batch_t* batch;
+
+        child_no = bridge_in->child_no(bridge_in, log);
+        cstat = bridge_in->child_stat + child_no;
+        batch = bridge_in->res_batch + child_no;
 
         ret = bridge_in->lock_res_tq(bridge_in, &tq, &child_no, log);
         if (unlikely(ret != YF_OK))
@@ -398,6 +1468,21 @@ yf_int_t yf_send_task_res_in(yf_bridge_in_t* bridge_in
                 return YF_ERROR;
         }
 
+        //task_info may be the task's one
+        task_info->blob = 0;
+        if (len > bridge_in->ctx.max_task_size && bridge_in->blob_arena)
+        {
+                blob_buf = yf_blob_alloc(bridge_in->blob_arena, len, 
+                                task_info->id, &blob, log);
+                if (blob_buf)
+                {
+                        yf_memcpy(blob_buf, task_res, len);
+                        task_info->blob = 1;
+                        task_res = &blob;
+                        len = sizeof(blob);
+                }
+        }
+
         if (len > bridge_in->ctx.max_task_size)
         {
                 yf_log_error(YF_LOG_ERR, log, 0, "task res len=%d too big > max_task_size=%d", 
@@ -409,17 +1494,22 @@ yf_int_t yf_send_task_res_in(yf_bridge_in_t* bridge_in
         }
 
         ret = yf_task_push(tq, task_info, task_res, len, log);
+        if (unlikely(ret != YF_OK && blob))
+                yf_blob_free(bridge_in->blob_arena, blob);
+
+        //after push, if died between, the parent fail it and drop the res
+        if (ret == YF_OK && bridge_in->inflight)
+                yf_bridge_inflight_del(bridge_in, child_no, task_info->id);
         
-        if (ret == YF_OK && bridge_in->task_res_signal)
-        {
-                bridge_in->task_res_signal(bridge_in, tq, child_no, log);
-        }
+        if (ret == YF_OK)
+                yf_bridge_res_signal(bridge_in, tq, child_no, batch, len, log);
 
         if (bridge_in->unlock_res_tq)
                 bridge_in->unlock_res_tq(bridge_in, tq, child_no, log);
 
         if (unlikely(ret != YF_OK))
         {
+                cstat->res_push_fail++;
                 yf_log_error(YF_LOG_WARN, log, 0, "task res id=%L by child_%d send back failed", 
                         task_info->id, child_no);
         }
@@ -445,6 +1535,133 @@ yf_int_t yf_send_task_res(yf_bridge_t* bridge
 }
 
 
+void* yf_send_task_res_reserve(yf_bridge_t* bridge, size_t len, yf_log_t* log)
+{
+        char* task_res;
+        yf_task_queue_t* tq = NULL;
+
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        assert(yf_check_be_magic(bridge_in));
+
+        yf_int_t child_no = bridge_in->child_no(bridge_in, log);
+        yf_bridge_child_stat_t* cstat = bridge_in->child_stat + child_no;
+        assert(bridge_in->reserve_res_tq[child_no] == NULL);
+
+        //the parent not known untill commit
+        if (unlikely(bridge_in->parents))
+        {
+                yf_log_error(YF_LOG_ERR, log, 0, "zero copy res not for multi parents");
+                return NULL;
+        }
+
+        if (len > bridge_in->ctx.max_task_size)
+        {
+                yf_log_error(YF_LOG_ERR, log, 0, "task res len=%d too big > max_task_size=%d", 
+                                len, bridge_in->ctx.max_task_size);
+                return NULL;
+        }
+
+        if (unlikely(bridge_in->lock_res_tq(bridge_in, &tq, &child_no, log) != YF_OK))
+        {
+                yf_log_error(YF_LOG_WARN, log, 0, "lock res tq failed");
+                return NULL;
+        }
+
+        task_res = yf_task_reserve(tq, len, log);
+        if (unlikely(task_res == NULL))
+        {
+                cstat->res_push_fail++;
+                if (bridge_in->unlock_res_tq)
+                        bridge_in->unlock_res_tq(bridge_in, tq, child_no, log);
+                return NULL;
+        }
+
+        bridge_in->reserve_res_tq[child_no] = tq;
+        return task_res;
+}
+
+
+yf_int_t yf_send_task_res_commit(yf_bridge_t* bridge
+                , size_t len, yf_u64_t id, yf_int_t status, yf_log_t* log)
+{
+        task_info_t task_info;
+
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        assert(yf_check_be_magic(bridge_in));
+
+        yf_int_t child_no = bridge_in->child_no(bridge_in, log);
+        yf_task_queue_t* tq = bridge_in->reserve_res_tq[child_no];
+        assert(tq);
+        bridge_in->reserve_res_tq[child_no] = NULL;
+
+        yf_memzero_st(task_info);
+        task_info.id = id;
+        task_info.status = status;
+
+        yf_task_commit(tq, &task_info, len, log);
+        if (bridge_in->inflight)
+                yf_bridge_inflight_del(bridge_in, child_no, id);
+
+        yf_bridge_res_signal(bridge_in, tq, child_no, 
+                        bridge_in->res_batch + child_no, len, log);
+
+        if (bridge_in->unlock_res_tq)
+                bridge_in->unlock_res_tq(bridge_in, tq, child_no, log);
+
+        yf_log_debug2(YF_LOG_DEBUG, log, 0, "task res id=%L by child_%d send back success", 
+                        id, child_no);
+        return YF_OK;
+}
+
+
+
+/*
+* steal one task from the busiest sibling, the owner hold the consumer lock
+* just for one copy, so wait it is ok; ret YF_AGAIN if nothing to steal
+*/
+static yf_int_t  yf_bridge_steal_task(yf_bridge_in_t* bridge_in, yf_int_t child_no
+                , task_info_t* task_info, char* task, size_t* task_len, yf_log_t* log)
+{
+        yf_int_t  i1, no;
+        yf_int_t  victim_no = -1;
+        yf_int_t  ret;
+        size_t  buf_size, max_size = 0;
+        yf_task_queue_t* tq;
+
+        for (i1 = 0; i1 < bridge_in->ctx.child_num; i1++)
+        {
+                if (i1 == child_no)
+                        continue;
+
+                no = i1;
+                bridge_in->lock_tq(bridge_in, &tq, &no, log);
+
+                buf_size = yf_task_lanes_size(tq);
+                if (buf_size > max_size)
+                {
+                        max_size = buf_size;
+                        victim_no = i1;
+                }
+        }
+
+        if (victim_no < 0)
+                return YF_AGAIN;
+
+        bridge_in->lock_tq(bridge_in, &tq, &victim_no, log);
+
+        yf_task_consumer_lock(tq);
+        ret = yf_task_pop(yf_task_lane_next(tq), task_info, task, task_len, log);
+        yf_task_consumer_unlock(tq);
+
+        if (ret == YF_OK)
+        {
+                yf_log_debug3(YF_LOG_DEBUG, log, 0, 
+                                "task id=%L stolen from child_%d by child_%d", 
+                                task_info->id, victim_no, child_no);
+        }
+        return ret;
+}
+
 
 void  yf_bridge_on_task_valiable(yf_bridge_in_t* bridge_in
                 , yf_int_t child_no, yf_log_t* log)
@@ -454,15 +1671,29 @@ void  yf_bridge_on_task_valiable(yf_bridge_in_t* bridge_in
         yf_s64_t  diff_ms;
         yf_time_t walltime;
         yf_task_queue_t* tq = NULL;
+        yf_task_queue_t* ltq = NULL;
         char* task_buf = bridge_in->task_buf[child_no];
+        //child_no may be changed by lock_tq (bt)
+        yf_bridge_child_stat_t* cstat = bridge_in->child_stat + child_no;
+        yf_int_t  self_no = child_no;
+        yf_time_t  end_time;
+        char* task;
+        yf_u32_t  blob;
         
         assert(task_buf);
         size_t  task_len;
 
+        yf_int_t  steal = yf_bridge_steal(bridge_in);
+        yf_int_t  in_place = yf_bridge_tq_spsc(bridge_in) && !steal;
+        yf_bridge_res_batch_t* batch = yf_bridge_res_batched(bridge_in) 
+                        ? bridge_in->res_batch + self_no : NULL;
+
         while (1)
         {
-                task_len = bridge_in->ctx.max_task_size;
-                
+                //busy, no idle flush, the res_batch_ms bound kept between tasks
+                if (batch && batch->num && yf_bridge_res_batch_due(bridge_in, batch))
+                        yf_bridge_flush_res(bridge_in, self_no, log);
+
                 ret = bridge_in->lock_tq(bridge_in, &tq, &child_no, log);
                 if (unlikely(ret != YF_OK))
                 {
@@ -470,16 +1701,60 @@ void  yf_bridge_on_task_valiable(yf_bridge_in_t* bridge_in
                         return;
                 }
 
-                ret = yf_task_pop(tq, &task_info, task_buf, &task_len, log);
+                //single consumer, handle the task in the queue directly
+                if (in_place)
+                {
+                        yf_task_unpark(tq);
+                        ltq = yf_task_lane_next(tq);
+                        ret = yf_task_peek_edf(ltq, bridge_in->ctx.task_edf_window, 
+                                        &task_info, &task, &task_len, log);
+                }
+                //siblings may steal, copy out with consumer lock, then steal if empty
+                else if (steal)
+                {
+                        yf_task_unpark(tq);
+                        task = task_buf;
+                        task_len = bridge_in->ctx.max_task_size;
+
+                        yf_task_consumer_lock(tq);
+                        ret = yf_task_pop(yf_task_lane_next(tq), &task_info, task, &task_len, log);
+                        yf_task_consumer_unlock(tq);
 
-                if (bridge_in->unlock_tq)
+                        if (ret == YF_AGAIN)
+                                ret = yf_bridge_steal_task(bridge_in, child_no, 
+                                                &task_info, task, &task_len, log);
+                }
+                else {
+                        task = task_buf;
+                        task_len = bridge_in->ctx.max_task_size;
+                        ret = yf_task_pop(yf_task_lane_next(tq), &task_info, task, &task_len, log);
                         bridge_in->unlock_tq(bridge_in, tq, child_no, log);
+                }
 
                 if (likely(ret == YF_OK))
                 {
+                        //the blob may be reclaimed (task cancelled or timeout)
+                        blob = task_info.blob ? *(yf_u32_t*)task : 0;
+                        if (unlikely(blob))
+                        {
+                                task = yf_blob_take(bridge_in->blob_arena, blob, 
+                                                task_info.id, &task_len);
+                                if (task == NULL)
+                                {
+                                        yf_log_debug2(YF_LOG_DEBUG, log, 0, 
+                                                        "task id=%L blob=%d reclaimed, skip", 
+                                                        task_info.id, blob);
+                                        if (in_place)
+                                                yf_task_release(ltq, log);
+                                        continue;
+                                }
+                        }
+
                         yf_real_walltime(&walltime);
                         
                         diff_ms = yf_time_diff_ms(&walltime, &task_info.inqueue_time);
+                        cstat->received++;
+                        yf_bridge_hist_add(&cstat->wait, diff_ms);
                         
                         yf_log_debug3(YF_LOG_DEBUG, log, 0, 
                                         "task id=%L recevied by child_%d success, diff_ms=%L", 
@@ -492,17 +1767,44 @@ void  yf_bridge_on_task_valiable(yf_bridge_in_t* bridge_in
                                                 task_info.id, child_no);
 
                                 task_info.timeout = 1;
+                                cstat->expired++;
                                 yf_send_task_res_in(bridge_in, NULL, 0, &task_info, log);
                         }
                         else {
+                                if (bridge_in->inflight)
+                                {
+                                        yf_bridge_inflight_add(bridge_in, child_no, task_info.id);
+                                        bridge_in->inflight[child_no].blob = blob;
+                                }
+
                                 bridge_in->task_handler((yf_bridge_t*)bridge_in, 
-                                                task_buf, task_len, task_info.id, log);
+                                                task, task_len, task_info.id, log);
+
+                                yf_real_walltime(&end_time);
+                                yf_bridge_hist_add(&cstat->service, 
+                                                yf_time_diff_ms(&end_time, &walltime));
+                        }
+
+                        if (blob)
+                        {
+                                if (bridge_in->inflight)
+                                        bridge_in->inflight[child_no].blob = 0;
+                                yf_blob_free(bridge_in->blob_arena, blob);
                         }
+                        if (in_place)
+                                yf_task_release(ltq, log);
                         continue;
                 }
 
                 if (ret == YF_AGAIN)
                 {
+                        //task may arrive before parked, then no doorbell...
+                        if ((in_place || steal) && yf_task_park(tq) != YF_OK)
+                                continue;
+
+                        //idle now, no more res soon
+                        if (batch)
+                                yf_bridge_flush_res(bridge_in, self_no, log);
                         yf_log_debug0(YF_LOG_DEBUG, log, 0, "no task, wait again...");
                 }
                 else
@@ -520,17 +1822,19 @@ void  yf_bridge_on_task_res_valiable(yf_bridge_in_t* bridge_in
         task_info_t  task_info;
         yf_int_t  ret;
         yf_int_t  status;
+        yf_s64_t  latency_ms;
         yf_task_ctx_t* task_ctx;
+        yf_bridge_parent_stat_t* pstat;
         yf_task_queue_t* tq = NULL;
         char* task_buf = bridge_in->task_res_buf;
+        char* task;
+        yf_u32_t  blob;
         
         assert(task_buf);
         size_t  task_len;
 
         while (1)
         {
-                task_len = bridge_in->ctx.max_task_size;
-                
                 ret = bridge_in->lock_res_tq(bridge_in, &tq, &child_no, log);
                 if (unlikely(ret != YF_OK))
                 {
@@ -538,13 +1842,30 @@ void  yf_bridge_on_task_res_valiable(yf_bridge_in_t* bridge_in
                         return;
                 }
 
-                ret = yf_task_pop(tq, &task_info, task_buf, &task_len, log);
-
-                if (bridge_in->unlock_res_tq)
+                //single consumer, handle the res in the queue directly
+                if (yf_bridge_rtq_spsc(bridge_in))
+                {
+                        yf_task_unpark(tq);
+                        ret = yf_task_peek(tq, &task_info, &task, &task_len, log);
+                }
+                else {
+                        task = task_buf;
+                        task_len = bridge_in->ctx.max_task_size;
+                        ret = yf_task_pop(tq, &task_info, task, &task_len, log);
                         bridge_in->unlock_res_tq(bridge_in, tq, child_no, log);
+                }
 
                 if (likely(ret == YF_OK))
                 {
+                        //res blob never reclaimed, just take it
+                        blob = task_info.blob ? *(yf_u32_t*)task : 0;
+                        if (unlikely(blob))
+                        {
+                                task = yf_blob_take(bridge_in->blob_arena, blob, 
+                                                task_info.id, &task_len);
+                                assert(task);
+                        }
+
                         task_ctx = yf_get_node_by_id(&bridge_in->task_cb_info_pool, 
                                         task_info.id, log);
                         if (unlikely(task_ctx == NULL))
@@ -552,6 +1873,10 @@ void  yf_bridge_on_task_res_valiable(yf_bridge_in_t* bridge_in
                                 yf_log_error(YF_LOG_WARN, log, 0, 
                                         "task res id=%L sent by child_%d cant found now", 
                                         task_info.id, child_no);
+                                if (blob)
+                                        yf_blob_free(bridge_in->blob_arena, blob);
+                                if (yf_bridge_rtq_spsc(bridge_in))
+                                        yf_task_release(tq, log);
                                 continue;
                         }
                         
@@ -561,8 +1886,26 @@ void  yf_bridge_on_task_res_valiable(yf_bridge_in_t* bridge_in
                         else if (task_info.error)
                                 status = YF_TASK_ERROR;
 
-                        assert(child_no == task_ctx->child_no);
-                        bridge_in->task_execut[child_no] -= 1;
+                        //task may be stolen, the res come from the thief's tq,
+                        //or an attached parent of bt, res tq per child
+                        assert(child_no == task_ctx->child_no 
+                                        || bridge_in->ctx.task_dispatch_type 
+                                                == YF_TASK_DISTPATCH_STEAL
+                                        || (bridge_in->res_tqs 
+                                                && !yf_bridge_tq_spsc(bridge_in)));
+                        yf_bridge_task_done(bridge_in, task_ctx->child_no, log);
+
+                        //avg latency (ewma), for elastic
+                        latency_ms = yf_time_diff_ms(&yf_now_times.clock_time, 
+                                        &task_ctx->send_time);
+                        bridge_in->latency_ms = (bridge_in->latency_ms * 7 
+                                        + yf_max(latency_ms, 0)) >> 3;
+                        ++bridge_in->res_num;
+
+                        pstat = bridge_in->parent_stat + task_ctx->child_no;
+                        yf_bridge_hist_add(&pstat->round_trip, latency_ms);
+                        if (status == YF_TASK_TIMEOUT)
+                                pstat->timeout++;
 
                         if (task_ctx->tm_evt)
                         {
@@ -572,18 +1915,26 @@ void  yf_bridge_on_task_res_valiable(yf_bridge_in_t* bridge_in
                         yf_log_debug3(YF_LOG_DEBUG, log, 0, 
                                         "task res id=%L sent by childd_%d ret, execute=%d", 
                                         task_info.id, child_no, 
-                                        bridge_in->task_execut[child_no]);
+                                        bridge_in->task_execut[task_ctx->child_no]);
                         
                         bridge_in->task_res_handler((yf_bridge_t*)bridge_in, 
-                                        task_buf, task_len, task_info.id, 
+                                        task, task_len, task_info.id, 
                                         status, task_ctx->data, log);
 
                         yf_free_node_to_pool(&bridge_in->task_cb_info_pool, task_ctx, log);
+
+                        if (blob)
+                                yf_blob_free(bridge_in->blob_arena, blob);
+
+                        if (yf_bridge_rtq_spsc(bridge_in))
+                                yf_task_release(tq, log);
                         continue;
                 }
 
                 if (ret == YF_AGAIN)
                 {
+                        if (yf_bridge_rtq_spsc(bridge_in) && yf_task_park(tq) != YF_OK)
+                                continue;
                         yf_log_debug0(YF_LOG_DEBUG, log, 0, "no task res, wait again...");
                 }
                 else
@@ -13,6 +13,53 @@
 
 #define  YF_ANY_CHILD_NO 0xfffe
 
+//see yf_bridge_stat_t
+typedef struct yf_bridge_parent_stat_s
+{
+        yf_u64_t  sent;
+        yf_u64_t  push_fail;
+        yf_u64_t  timeout;
+        yf_u64_t  cancelled;
+        yf_bridge_hist_t  round_trip;
+}
+yf_bridge_parent_stat_t;
+
+//written by the child, may live in shm, padded to not share cache line
+typedef struct yf_bridge_child_stat_s
+{
+        yf_u64_t  received;
+        yf_u64_t  expired;
+        yf_u64_t  res_push_fail;
+        yf_u64_t  parked;
+        yf_bridge_hist_t  wait;
+        yf_bridge_hist_t  service;
+        char  pad[YF_TQ_CACHE_LINE];
+}
+yf_bridge_child_stat_t;
+
+//task ids a proc child taken but not answered yet, in shm, so the parent
+//can fail them at once if the child died; slot by id, 0 means free
+#define YF_BRIDGE_INFLIGHT_SLOTS 64
+
+typedef struct yf_bridge_inflight_s
+{
+        volatile yf_u64_t  ids[YF_BRIDGE_INFLIGHT_SLOTS];
+        //blob taken by the handling task, not freed if the child died
+        volatile yf_u32_t  blob;
+}
+yf_bridge_inflight_t;
+
+//res pending signal of a child, see ctx.res_batch_num
+typedef struct yf_bridge_res_batch_s
+{
+        yf_uint_t  num;
+        size_t  bytes;
+        yf_time_t  first_time;
+        //evt drived child, flush the batch if no more res come
+        yf_tm_evt_t* tm_evt;
+}
+yf_bridge_res_batch_t;
+
 
 typedef struct yf_bridge_in_s
 {
@@ -24,8 +71,51 @@ typedef struct yf_bridge_in_s
         void* bridge_data;
 
         char* task_res_buf;
-        char* task_buf[YF_BRIDGE_MAX_CHILD_NUM];
-        yf_uint_t  task_execut[YF_BRIDGE_MAX_CHILD_NUM];
+        //per child, size = ctx.max_child_num
+        char** task_buf;
+        yf_uint_t*  task_execut;
+        //two choice dispatch random state
+        yf_u32_t  dispatch_seed;
+
+        //zero copy send, tq locked between reserve and commit
+        yf_task_queue_t* reserve_tq;
+        yf_int_t  reserve_child_no;
+        yf_task_queue_t** reserve_res_tq;
+
+        //elastic
+        yf_bridge_elastic_t  elastic;
+        yf_tm_evt_t* elastic_evt;
+        yf_uint_t  latency_ms;
+        yf_uint_t  res_num;
+
+        //per child, child_stat set by proc creator in shm
+        yf_bridge_parent_stat_t* parent_stat;
+        yf_bridge_child_stat_t* child_stat;
+
+        //set by creator if ctx.blob_arena_size, in shm for proc childs
+        yf_blob_arena_t* blob_arena;
+
+        //per child, set by proc creator in shm, NULL for thread childs
+        yf_bridge_inflight_t* inflight;
+
+        //per child, used by the child self
+        yf_bridge_res_batch_t* res_batch;
+
+        //multi parents, parents[0] is the created bridge, the attached
+        //ones share its childs (bridge_data), parent_no is the task ctx
+        //pool index, so in the task id; parent_num set in parents[0]
+        struct yf_bridge_in_s** parents;
+        //per slot, childs pin it while sending res to the parent there
+        yf_atomic_t* parent_refs;
+        //per slot, taken by an attached (or attaching) parent
+        char* parent_used;
+        yf_uint_t  parent_no;
+        yf_uint_t  parent_num;
+        yf_lock_t  parent_lock;
+
+        //attached parent, its res tq per child, res_evt rung by childs
+        yf_task_queue_t** res_tqs;
+        yf_user_event_t* res_evt;
 
         //all can call
         //may change child_no if arg is ptr...
@@ -59,6 +149,14 @@ typedef struct yf_bridge_in_s
 
         void (*destory)(struct yf_bridge_in_s* bridge, yf_log_t* log);
 
+        //set ctx.child_num, start new childs, retire removed childs
+        yf_int_t (*resize)(struct yf_bridge_in_s* bridge
+                        , yf_uint_t child_num, yf_log_t* log);
+
+        //removed child's last task done (res, timeout or cancel), may be null
+        void (*child_idle)(struct yf_bridge_in_s* bridge
+                        , yf_int_t child_no, yf_log_t* log);
+
         /*
         * child call
         */
@@ -89,12 +187,34 @@ typedef struct yf_task_ctx_s
         yf_tm_evt_t* tm_evt;
         yf_bridge_in_t* bridge_in;
         yf_int_t  child_no;
+        yf_u32_t  priority;
+        //blob handle if task sent in blob
+        yf_u32_t  blob;
+        yf_time_t  send_time;
 }
 yf_task_ctx_t;
 
 
 #define __yf_bridge_set_ac(brige, ac, prefix) (brige)->ac = prefix ## _ ## ac;
 
+//single consumer queue (no lock), task handled in place, consumer park
+#define yf_bridge_tq_spsc(bridge) ((bridge)->unlock_tq == NULL)
+#define yf_bridge_rtq_spsc(bridge) ((bridge)->unlock_res_tq == NULL)
+
+//parents push to the same child tq without lock
+#define yf_bridge_tq_mpsc(bridge) ((bridge)->parents && yf_bridge_tq_spsc(bridge))
+
+#define yf_bridge_parent_no(id) ((yf_uint_t)((id) >> 56))
+
+#define yf_bridge_res_batched(bridge) ((bridge)->ctx.res_batch_num > 1 \
+                || (bridge)->ctx.res_batch_bytes)
+
+//child threads steal from each other, tq consumed with consumer lock
+#define yf_bridge_steal(bridge) ( \
+                (bridge)->ctx.task_dispatch_type == YF_TASK_DISTPATCH_STEAL \
+                && (bridge)->ctx.child_ins_type == YF_BRIDGE_INS_THREAD \
+                && yf_bridge_tq_spsc(bridge))
+
 
 yf_int_t yf_send_task_res_in(yf_bridge_in_t* bridge_in
                 , void* task_res, size_t len, task_info_t* task_info, yf_log_t* log);
@@ -107,6 +227,13 @@ void  yf_bridge_on_task_res_valiable(yf_bridge_in_t* bridge_in
 
 yf_int_t  yf_bridge_get_idle_tq(yf_bridge_in_t* bridge_in);
 
+//parent call after the child died, before it respawned
+void  yf_bridge_fail_inflight(yf_bridge_in_t* bridge_in
+                , yf_int_t child_no, yf_log_t* log);
+//parent call after a removed child died, it wont respawn
+void  yf_bridge_fail_queued(yf_bridge_in_t* bridge_in
+                , yf_int_t child_no, yf_log_t* log);
+
 #include "yf_bridge_signal.h"
 
 
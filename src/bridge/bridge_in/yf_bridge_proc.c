@@ -12,17 +12,47 @@ typedef struct yf_bridge_proc_s
         yf_pid_t* pids;
         yf_task_queue_t** tqs;
         yf_task_queue_t** rtqs;
+        //eventfd pair per child, opened before fork, so inherited
+        yf_socket_t* efds;
+        //in shm, just if childs blocked
+        yf_bridge_futex_t* futexes;
         yf_shm_t  shm;
         yf_int_t  child_no;
         yf_log_t* plog;
         yf_evt_driver_t* evt_driver;
+        yf_int_t  res_attached;
 }
 yf_bridge_proc_t;
 
 
 static void yf_bridge_proc_exit_cb(struct  yf_process_s* proc);
-static void yf_bridge_child_proc_spawn(yf_bridge_in_t* bridge_in
+static yf_int_t yf_bridge_child_proc_spawn(yf_bridge_in_t* bridge_in
                 , yf_int_t child_no, yf_int_t respawn, yf_log_t* log);
+static yf_int_t yf_bridge_proc_resize(yf_bridge_in_t* bridge
+                , yf_uint_t child_num, yf_log_t* log);
+static void yf_bridge_proc_child_idle(yf_bridge_in_t* bridge
+                , yf_int_t child_no, yf_log_t* log);
+
+//efd pair if opened, else the proc's socketpair
+#define yf_bridge_proc_socks(bridge_proc, child_no, proc) \
+                ((bridge_proc)->channels[child_no].efd \
+                        ? (bridge_proc)->efds + 2 * (child_no) : (proc)->channel)
+
+//the proc's socketpair is owned by the bridge even if not used
+static void yf_bridge_proc_close_channel(yf_bridge_proc_t* bridge_proc
+                , yf_int_t child_no, yf_process_t* proc, yf_log_t* log)
+{
+        yf_bridge_channel_t* bc = bridge_proc->channels + child_no;
+
+        if (bc->efd)
+        {
+                yf_close_channel(bridge_proc->efds + 2 * child_no, log);
+                yf_close_channel(proc->channel, log);
+        }
+        else
+                yf_close_channel(bc->channels, log);
+}
+
 
 static yf_int_t yf_bridge_proc_lock_tq(yf_bridge_in_t* bridge
                 , yf_task_queue_t** tq, yf_int_t* child_no, yf_log_t* log)
@@ -54,6 +84,13 @@ static void yf_bridge_proc_task_signal(yf_bridge_in_t* bridge
 {
         yf_bridge_proc_t* bridge_proc = (yf_bridge_proc_t*)bridge->bridge_data;
 
+        //blocked child sleep on its futex
+        if (bridge_proc->futexes)
+        {
+                yf_bridge_futex_signal(bridge_proc->futexes + child_no, log);
+                return;
+        }
+
         yf_int_t ret = yf_bridge_channel_signal(bridge_proc->channels + child_no, 1, log);
         assert(ret == YF_OK);
 }
@@ -72,7 +109,7 @@ static yf_int_t yf_bridge_proc_attach_res_bridge(yf_bridge_in_t* bridge
                 proc = yf_processes + yf_pid_slot(bridge_proc->pids[i1]);
                 
                 ret = yf_bridge_channel_init(bridge_proc->channels + i1, 
-                                bridge, proc->channel, 
+                                bridge, yf_bridge_proc_socks(bridge_proc, i1, proc), 
                                 evt_driver, 1, i1, log);
                 if (ret != YF_OK)
                 {
@@ -80,6 +117,7 @@ static yf_int_t yf_bridge_proc_attach_res_bridge(yf_bridge_in_t* bridge
                         return ret;
                 }
         }
+        bridge_proc->res_attached = 1;
         return YF_OK;
 }
 
@@ -90,8 +128,12 @@ static void yf_bridge_proc_destory(yf_bridge_in_t* bridge, yf_log_t* log)
         yf_process_t* proc;
         yf_bridge_proc_t* bridge_proc = (yf_bridge_proc_t*)bridge->bridge_data;
 
-        for ( i1 = 0; i1 <  bridge->ctx.child_num; i1++ )
+        for ( i1 = 0; i1 <  bridge->ctx.max_child_num; i1++ )
         {
+                //retired
+                if (bridge_proc->pids[i1] == YF_INVALID_PID)
+                        continue;
+
                 proc = yf_processes + yf_pid_slot(bridge_proc->pids[i1]);
                 
                 if (proc->pid == YF_INVALID_PID)
@@ -107,7 +149,7 @@ static void yf_bridge_proc_destory(yf_bridge_in_t* bridge, yf_log_t* log)
                 }
                 
                 yf_bridge_channel_uninit(bridge_proc->channels + i1, 1, log);
-                yf_close_channel(bridge_proc->channels[i1].channels, log);
+                yf_bridge_proc_close_channel(bridge_proc, i1, proc, log);
         }
         
         yf_named_shm_destory(&bridge_proc->shm);
@@ -139,7 +181,7 @@ static yf_int_t yf_bridge_proc_attach_bridge(yf_bridge_in_t* bridge
         yf_bridge_proc_t* bridge_proc = (yf_bridge_proc_t*)bridge->bridge_data;
 
         yf_int_t ret = yf_bridge_channel_init(bridge_proc->channels + child_no, 
-                        bridge, proc->channel, 
+                        bridge, yf_bridge_proc_socks(bridge_proc, child_no, proc), 
                         evt_driver, 0, child_no, log);
         if (ret != YF_OK)
         {
@@ -155,6 +197,25 @@ static void yf_bridge_proc_wait_task(yf_bridge_in_t* bridge
                 , yf_int_t child_no, yf_log_t* log)
 {
         yf_bridge_proc_t* bridge_proc = (yf_bridge_proc_t*)bridge->bridge_data;
+        yf_bridge_futex_t* bf;
+        yf_u32_t  seen;
+
+        if (bridge_proc->futexes)
+        {
+                bf = bridge_proc->futexes + child_no;
+                seen = bf->seq;
+                //load seq before parked, pair with the cas in yf_task_need_signal
+                yf_memory_barrier();
+
+                //unparked, the parent has rung (or will ring) the futex
+                if (bridge_proc->tqs[child_no]->parked)
+                {
+                        bridge->child_stat[child_no].parked++;
+                        yf_bridge_futex_wait(bf, seen, log);
+                        yf_update_time(NULL, NULL, log);
+                }
+                return;
+        }
         
         yf_bridge_channel_wait(bridge_proc->channels + child_no, 0, log);        
 }
@@ -168,12 +229,16 @@ yf_int_t  yf_bridge_pp_creator(yf_bridge_in_t* bridge_in, yf_log_t* log)
 
         CHECK_RV(bridge_in->ctx.exec_func == NULL, YF_ERROR);
         
-        size_t  channls_size = sizeof(yf_bridge_channel_t) * bridge_in->ctx.child_num;
-        size_t  pid_size = yf_align_mem(sizeof(yf_pid_t) * bridge_in->ctx.child_num);
-        size_t  tq_size = sizeof(yf_task_queue_t*) * bridge_in->ctx.child_num;
+        //all sized by max, for elastic
+        size_t  channls_size = sizeof(yf_bridge_channel_t) * bridge_in->ctx.max_child_num;
+        size_t  pid_size = yf_align_mem(sizeof(yf_pid_t) * bridge_in->ctx.max_child_num);
+        size_t  tq_size = sizeof(yf_task_queue_t*) * bridge_in->ctx.max_child_num;
+        size_t  efd_size = yf_align_mem(sizeof(yf_socket_t) * bridge_in->ctx.max_child_num * 2);
+        size_t  tqs_size, stat_size, inflight_size, futex_size = 0;
+        size_t  blob_size = 0;
         
         size_t  all_size = sizeof(yf_bridge_proc_t) 
-                        + channls_size + pid_size + 2 * tq_size;
+                        + channls_size + pid_size + efd_size + 2 * tq_size;
         
         yf_bridge_proc_t* bridge_proc = yf_alloc(all_size);
         CHECK_RV(bridge_proc==NULL, YF_ERROR);
@@ -185,13 +250,27 @@ yf_int_t  yf_bridge_pp_creator(yf_bridge_in_t* bridge_in, yf_log_t* log)
 
         bridge_proc->channels = yf_mem_off(bridge_proc, sizeof(yf_bridge_proc_t));
         bridge_proc->pids = yf_mem_off(bridge_proc->channels, channls_size);
-        bridge_proc->tqs = yf_mem_off(bridge_proc->pids, pid_size);
+        bridge_proc->efds = yf_mem_off(bridge_proc->pids, pid_size);
+        bridge_proc->tqs = yf_mem_off(bridge_proc->efds, efd_size);
         bridge_proc->rtqs = yf_mem_off(bridge_proc->tqs, tq_size);
 
         bridge_proc->shm.key = YF_INVALID_SHM_KEY;
         bridge_proc->shm.log = log;
-        bridge_proc->shm.size = 2 * bridge_in->ctx.child_num 
-                                * bridge_in->ctx.queue_capacity;
+        //tqs, rtqs, child stats and inflight ids (written by child procs), 
+        //futexes, then blob arena
+        tqs_size = bridge_in->ctx.max_child_num * bridge_in->ctx.queue_capacity;
+        stat_size = yf_align_mem(sizeof(yf_bridge_child_stat_t) 
+                                * bridge_in->ctx.max_child_num);
+        inflight_size = sizeof(yf_bridge_inflight_t) * bridge_in->ctx.max_child_num;
+#ifdef  YF_BRIDGE_HAVE_FUTEX
+        if (bridge_in->ctx.child_poll_type == YF_BRIDGE_BLOCKED)
+                futex_size = sizeof(yf_bridge_futex_t) * bridge_in->ctx.max_child_num;
+#endif
+        if (bridge_in->ctx.blob_arena_size)
+                blob_size = yf_blob_arena_size(bridge_in->ctx.blob_arena_size, 
+                                bridge_in->ctx.blob_chunk_size);
+        bridge_proc->shm.size = 2 * tqs_size + stat_size + inflight_size 
+                        + futex_size + blob_size;
         yf_str_set(&bridge_proc->shm.name, "bridge_proc");
 
         ret = yf_named_shm_attach(&bridge_proc->shm);
@@ -201,15 +280,18 @@ yf_int_t  yf_bridge_pp_creator(yf_bridge_in_t* bridge_in, yf_log_t* log)
                 return YF_ERROR;
         }
 
-        for ( i1 = 0; i1 < bridge_in->ctx.child_num; i1++ )
+        for ( i1 = 0; i1 < bridge_in->ctx.max_child_num; i1++ )
         {
-                bridge_proc->tqs[i1] = yf_init_task_queue(
+                bridge_proc->pids[i1] = YF_INVALID_PID;
+                bridge_proc->tqs[i1] = yf_init_task_lanes(
                                 yf_mem_off(bridge_proc->shm.addr, i1 * bridge_in->ctx.queue_capacity), 
-                                bridge_in->ctx.queue_capacity, log);
+                                bridge_in->ctx.queue_capacity, 
+                                bridge_in->ctx.task_lane_num, 
+                                bridge_in->ctx.task_lane_weighted, log);
                 
                 bridge_proc->rtqs[i1] = yf_init_task_queue(
                                 yf_mem_off(bridge_proc->shm.addr, 
-                                        (bridge_proc->shm.size>>1) + i1 * bridge_in->ctx.queue_capacity), 
+                                        tqs_size + i1 * bridge_in->ctx.queue_capacity), 
                                 bridge_in->ctx.queue_capacity, log);
                 
                 if (bridge_proc->tqs[i1] == NULL || bridge_proc->rtqs[i1] == NULL)
@@ -221,6 +303,26 @@ yf_int_t  yf_bridge_pp_creator(yf_bridge_in_t* bridge_in, yf_log_t* log)
                 }
         }
 
+        bridge_in->child_stat = yf_mem_off(bridge_proc->shm.addr, 2 * tqs_size);
+        bridge_in->inflight = yf_mem_off(bridge_in->child_stat, stat_size);
+        if (futex_size)
+                bridge_proc->futexes = yf_mem_off(bridge_in->inflight, inflight_size);
+
+        if (blob_size)
+        {
+                bridge_in->blob_arena = yf_init_blob_arena(
+                                yf_mem_off(bridge_proc->shm.addr, 
+                                        2 * tqs_size + stat_size 
+                                        + inflight_size + futex_size), 
+                                blob_size, bridge_in->ctx.blob_chunk_size, log);
+                if (bridge_in->blob_arena == NULL)
+                {
+                        yf_named_shm_destory(&bridge_proc->shm);
+                        yf_free(bridge_proc);
+                        return  YF_ERROR;
+                }
+        }
+
         //set actions
         __yf_bridge_set_ac(bridge_in, lock_tq, yf_bridge_proc);
         __yf_bridge_set_ac(bridge_in, lock_res_tq, yf_bridge_proc);
@@ -231,16 +333,128 @@ yf_int_t  yf_bridge_pp_creator(yf_bridge_in_t* bridge_in, yf_log_t* log)
         __yf_bridge_set_ac(bridge_in, task_res_signal, yf_bridge_proc);
         __yf_bridge_set_ac(bridge_in, attach_bridge, yf_bridge_proc);
         __yf_bridge_set_ac(bridge_in, wait_task, yf_bridge_proc);        
+        __yf_bridge_set_ac(bridge_in, resize, yf_bridge_proc);
+        __yf_bridge_set_ac(bridge_in, child_idle, yf_bridge_proc);
 
         for ( i1 = 0; i1 < bridge_in->ctx.child_num ; i1++ )
         {
-                yf_bridge_child_proc_spawn(bridge_in, i1, -1, log);
+                ret = yf_bridge_child_proc_spawn(bridge_in, i1, -1, log);
+                assert(ret == YF_OK);
         }
 
         return YF_OK;
 }
 
 
+//retired child exit, free the slot for later spawn
+static void yf_bridge_proc_retired_cb(struct  yf_process_s* proc)
+{
+        proc->pid = YF_INVALID_PID;
+}
+
+
+static void yf_bridge_proc_retire(yf_bridge_in_t* bridge_in
+                , yf_int_t child_no, yf_log_t* log)
+{
+        yf_bridge_proc_t* bridge_proc = (yf_bridge_proc_t*)bridge_in->bridge_data;
+        yf_bridge_channel_t* bridge_chl = bridge_proc->channels + child_no;
+        yf_process_t* proc = yf_processes + yf_pid_slot(bridge_proc->pids[child_no]);
+
+        proc->exit_cb = yf_bridge_proc_retired_cb;
+
+        if (kill(proc->pid, yf_signal_value(YF_TERMINATE_SIGNAL)) != 0)
+        {
+                yf_log_error(YF_LOG_WARN, log, yf_errno, 
+                                "retire child_%d, pid=%P failed", 
+                                child_no, proc->pid);
+        }
+
+        if (bridge_proc->res_attached)
+                yf_bridge_channel_uninit(bridge_chl, 1, log);
+        yf_bridge_proc_close_channel(bridge_proc, child_no, proc, log);
+
+        yf_log_error(YF_LOG_NOTICE, log, 0, "bridge child_%d retired, pid=%P", 
+                        child_no, bridge_proc->pids[child_no]);
+
+        bridge_proc->pids[child_no] = YF_INVALID_PID;
+}
+
+
+/*
+* removed child get no new task, but should send back the executing
+* tasks' res, so just retired after its tasks all done, here if idle
+* already, else by child_idle when its last task done
+*/
+static yf_int_t yf_bridge_proc_resize(yf_bridge_in_t* bridge
+                , yf_uint_t child_num, yf_log_t* log)
+{
+        yf_uint_t  i1;
+        yf_int_t  ret = YF_OK;
+        yf_process_t* proc;
+        yf_bridge_proc_t* bridge_proc = (yf_bridge_proc_t*)bridge->bridge_data;
+
+        for ( i1 = bridge->ctx.child_num; i1 < child_num; i1++ )
+        {
+                //removed but not retired yet, reuse it
+                if (bridge_proc->pids[i1] != YF_INVALID_PID)
+                        continue;
+
+                //dead child may not park, new child need the doorbell
+                bridge_proc->tqs[i1]->parked = 1;
+
+                ret = yf_bridge_child_proc_spawn(bridge, i1, -1, log);
+                if (ret != YF_OK)
+                        break;
+
+                if (bridge_proc->res_attached)
+                {
+                        proc = yf_processes + yf_pid_slot(bridge_proc->pids[i1]);
+                        ret = yf_bridge_channel_init(bridge_proc->channels + i1, 
+                                        bridge, yf_bridge_proc_socks(bridge_proc, i1, proc), 
+                                        bridge_proc->evt_driver, 1, i1, log);
+                        assert(ret == YF_OK);
+                }
+        }
+        if (ret != YF_OK)
+                child_num = i1;
+        bridge->ctx.child_num = child_num;
+
+        for ( i1 = child_num; i1 < bridge->ctx.max_child_num; i1++ )
+        {
+                if (bridge_proc->pids[i1] != YF_INVALID_PID 
+                                && bridge->task_execut[i1] == 0)
+                        yf_bridge_proc_retire(bridge, i1, log);
+        }
+        return ret;
+}
+
+
+/*
+* may be called in the child's channel evt handler, so just stop it,
+* the channel closed in exit_cb (removed child, no respawn)
+*/
+static void yf_bridge_proc_child_idle(yf_bridge_in_t* bridge
+                , yf_int_t child_no, yf_log_t* log)
+{
+        yf_bridge_proc_t* bridge_proc = (yf_bridge_proc_t*)bridge->bridge_data;
+        yf_pid_t  pid = bridge_proc->pids[child_no];
+
+        if (pid == YF_INVALID_PID)
+                return;
+
+        if (kill(pid, yf_signal_value(YF_TERMINATE_SIGNAL)) != 0)
+        {
+                yf_log_error(YF_LOG_WARN, log, yf_errno, 
+                                "retire idle child_%d, pid=%P failed", 
+                                child_no, pid);
+                return;
+        }
+
+        yf_log_error(YF_LOG_NOTICE, log, 0, "bridge idle child_%d retiring, pid=%P", 
+                        child_no, pid);
+}
+
+
 void yf_bridge_proc_exit_cb(struct  yf_process_s* proc)
 {
         yf_int_t  child_no, ret;
@@ -248,17 +462,34 @@ void yf_bridge_proc_exit_cb(struct  yf_process_s* proc)
         yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)proc->data;
         yf_bridge_proc_t* bridge_proc = (yf_bridge_proc_t*)bridge_in->bridge_data;
 
-        for (child_no = 0; child_no < bridge_in->ctx.child_num; ++child_no)
+        for (child_no = 0; child_no < bridge_in->ctx.max_child_num; ++child_no)
         {
                 if (proc->pid == bridge_proc->pids[child_no])
                         break;
         }
-        assert(child_no < bridge_in->ctx.child_num);
+        assert(child_no < bridge_in->ctx.max_child_num);
 
         bridge_chl = bridge_proc->channels + child_no;
+
+        //taken but not answered, no need to wait the timer
+        yf_bridge_fail_inflight(bridge_in, child_no, bridge_proc->plog);
+
+        //removed child, no respawn, nobody take its queued tasks
+        if (child_no >= bridge_in->ctx.child_num)
+        {
+                yf_bridge_fail_queued(bridge_in, child_no, bridge_proc->plog);
+                yf_bridge_channel_uninit(bridge_chl, 1, bridge_proc->plog);
+                yf_bridge_proc_close_channel(bridge_proc, child_no, proc, bridge_proc->plog);
+                bridge_proc->pids[child_no] = YF_INVALID_PID;
+                proc->pid = YF_INVALID_PID;
+                return;
+        }
+
+        //dead child may not park, new child need the doorbell
+        bridge_proc->tqs[child_no]->parked = 1;
         
         yf_bridge_channel_uninit(bridge_chl, 1, bridge_proc->plog);
-        yf_close_channel(bridge_chl->channels, bridge_proc->plog);
+        yf_bridge_proc_close_channel(bridge_proc, child_no, proc, bridge_proc->plog);
 
         yf_log_error(YF_LOG_WARN, bridge_proc->plog, 0, 
                         "bridge child_%d respawn, exit_err=%d, exit_status=%d", 
@@ -266,20 +497,27 @@ void yf_bridge_proc_exit_cb(struct  yf_process_s* proc)
                         yf_proc_exit_err(proc->status), 
                         yf_proc_exit_code(proc->status));
 
-        yf_bridge_child_proc_spawn(bridge_in, child_no, 
+        ret = yf_bridge_child_proc_spawn(bridge_in, child_no, 
                         yf_pid_slot(proc->pid), bridge_proc->plog);
+        assert(ret == YF_OK);
 
-        ret = yf_bridge_channel_init(bridge_chl, bridge_in, proc->channel, 
+        ret = yf_bridge_channel_init(bridge_chl, bridge_in, 
+                                        yf_bridge_proc_socks(bridge_proc, child_no, proc), 
                                         bridge_proc->evt_driver, 1, 
                                         child_no, bridge_proc->plog);
         assert(ret == YF_OK);
 }
 
 
-static void yf_bridge_child_proc_spawn(yf_bridge_in_t* bridge_in
+static yf_int_t yf_bridge_child_proc_spawn(yf_bridge_in_t* bridge_in
                 , yf_int_t child_no, yf_int_t respawn, yf_log_t* log)
 {
         yf_bridge_proc_t* bridge_proc = (yf_bridge_proc_t*)bridge_in->bridge_data;
+        yf_bridge_channel_t* bc = bridge_proc->channels + child_no;
+        yf_socket_t* efds = bridge_proc->efds + 2 * child_no;
+
+        //cheaper than the proc's socketpair, a counter write/read per signal
+        bc->efd = (yf_bridge_open_efd(efds, log) == YF_OK);
         
         bridge_proc->child_no = child_no;
         bridge_proc->pids[child_no] = yf_spawn_process(
@@ -287,5 +525,12 @@ static void yf_bridge_child_proc_spawn(yf_bridge_in_t* bridge_in
                         bridge_in, "bridge", 
                         respawn<0 ? YF_PROC_CHILD : respawn, yf_bridge_proc_exit_cb, log);
         
-        assert (bridge_proc->pids[child_no] != YF_INVALID_PID);        
+        if (bridge_proc->pids[child_no] == YF_INVALID_PID)
+        {
+                yf_log_error(YF_LOG_WARN, log, 0, "spawn child_%d failed", child_no);
+                if (bc->efd)
+                        yf_close_channel(efds, log);
+                return YF_ERROR;
+        }
+        return YF_OK;
 }
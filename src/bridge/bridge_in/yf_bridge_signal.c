@@ -2,12 +2,44 @@
 #include <base_struct/yf_core.h>
 #include "yf_bridge_in.h"
 
+#ifdef  HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+
+#ifdef  YF_BRIDGE_HAVE_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
 /*
 * channel
 */
 static void yf_channel_parent_readable(yf_fd_event_t* evt);
 static void yf_channel_child_readable(yf_fd_event_t* evt);
 
+yf_int_t  yf_bridge_open_efd(yf_socket_t* fds, yf_log_t* log)
+{
+#ifdef  HAVE_SYS_EVENTFD_H
+        fds[0] = eventfd(0, EFD_CLOEXEC);
+        if (fds[0] < 0)
+        {
+                yf_log_error(YF_LOG_WARN, log, yf_errno, "eventfd failed");
+                return YF_ERROR;
+        }
+        fds[1] = eventfd(0, EFD_CLOEXEC);
+        if (fds[1] < 0)
+        {
+                yf_log_error(YF_LOG_WARN, log, yf_errno, "eventfd failed");
+                yf_close(fds[0]);
+                return YF_ERROR;
+        }
+        return YF_OK;
+#else
+        return YF_ERROR;
+#endif
+}
+
+
 yf_int_t  yf_bridge_channel_init(yf_bridge_channel_t* bc
                 , yf_bridge_in_t* bridge
                 , yf_socket_t* channels, yf_evt_driver_t* evt_driver
@@ -116,6 +148,20 @@ yf_int_t  yf_bridge_channel_signal(yf_bridge_channel_t* bc
         yf_fd_t  fd = bc->channels[is_parent?0:1];
         yf_channel_t  channel = {0};
         
+        //ring the peer's eventfd
+        if (bc->efd)
+        {
+                yf_u64_t  one = 1;
+                fd = bc->channels[is_parent?1:0];
+                if (unlikely(yf_write(fd, &one, sizeof(one)) != sizeof(one)))
+                {
+                        yf_log_error(YF_LOG_ERR, log, yf_errno, 
+                                        "bridge efd signal failed, fd=%d", fd);
+                        return  YF_ERROR;
+                }
+                return YF_OK;
+        }
+        
         channel.command = YF_CMD_DATA;
         yf_int_t ret = yf_write_channel(fd, &channel, log);
         
@@ -142,6 +188,19 @@ yf_int_t  yf_bridge_channel_wait(yf_bridge_channel_t* bc
         yf_int_t blocked = is_parent ? bc->pblocked : bc->cblocked;
         yf_int_t tmp_block = 1;
 
+        //one read take all the rings
+        if (bc->efd)
+        {
+                yf_u64_t  cnt;
+                if (yf_read(fd, &cnt, sizeof(cnt)) < 0 && !YF_EAGAIN(yf_errno))
+                {
+                        yf_log_error(YF_LOG_ERR, log, yf_errno, 
+                                        "bridge efd wait failed, fd=%d", fd);
+                        return  YF_ERROR;
+                }
+                return YF_OK;
+        }
+
         //read all from channel...
         while (1)
         {
@@ -196,6 +255,49 @@ yf_int_t  yf_bridge_channel_wait(yf_bridge_channel_t* bc
 }
 
 
+/*
+* futex, not private, the word may be shared by procs
+*/
+#ifdef  YF_BRIDGE_HAVE_FUTEX
+
+#define yf_futex(addr, op, val) syscall(SYS_futex, addr, op, val, NULL, NULL, 0)
+
+void  yf_bridge_futex_signal(yf_bridge_futex_t* bf, yf_log_t* log)
+{
+        yf_atomic_fetch_add(&bf->seq, 1);
+
+        if (unlikely(yf_futex(&bf->seq, FUTEX_WAKE, 1) < 0))
+        {
+                yf_log_error(YF_LOG_ERR, log, yf_errno, "bridge futex wake failed");
+        }
+}
+
+void  yf_bridge_futex_wait(yf_bridge_futex_t* bf, yf_u32_t seen, yf_log_t* log)
+{
+        //EAGAIN if seq changed already
+        if (yf_futex(&bf->seq, FUTEX_WAIT, seen) < 0 
+                        && !YF_EAGAIN(yf_errno) && yf_errno != YF_EINTR)
+        {
+                yf_log_error(YF_LOG_ERR, log, yf_errno, "bridge futex wait failed");
+        }
+}
+
+#else
+
+void  yf_bridge_futex_signal(yf_bridge_futex_t* bf, yf_log_t* log)
+{
+        yf_atomic_fetch_add(&bf->seq, 1);
+}
+
+void  yf_bridge_futex_wait(yf_bridge_futex_t* bf, yf_u32_t seen, yf_log_t* log)
+{
+        if (bf->seq == seen)
+                yf_msleep(1);
+}
+
+#endif
+
+
 //TODO, if channel broken, then...
 
 void yf_channel_parent_readable(yf_fd_event_t* evt)
@@ -287,9 +389,16 @@ yf_int_t  yf_bridge_mutex_signal(yf_bridge_mutex_t* bm, yf_int_t alreay_locked
 }
 
 yf_int_t  yf_bridge_mutex_wait(yf_bridge_mutex_t* bm
-                , yf_log_t* log)
+                , yf_task_queue_t* tq, yf_log_t* log)
 {
         yf_mutex_lock(bm->mutex, log);
+
+        //task pushed after the child's pop, its signal found no waiter
+        if (!yf_task_queue_empty(tq))
+        {
+                yf_mutex_unlock(bm->mutex, log);
+                return YF_OK;
+        }
         
         bm->wait_num++;
         yf_cond_wait(bm->cond, bm->mutex, log);
@@ -16,6 +16,8 @@ typedef struct yf_bridge_channel_s
         yf_u32_t  owner:1;
         yf_u32_t  pblocked:1;
         yf_u32_t  cblocked:1;
+        //channels are two eventfd, [0] parent's, [1] child's
+        yf_u32_t  efd:1;
         yf_u32_t  child_no:16;
         yf_fd_event_t*  channel_pevts[2];
         yf_fd_event_t*  channel_cevts[2];
@@ -23,6 +25,9 @@ typedef struct yf_bridge_channel_s
 }
 yf_bridge_channel_t;
 
+//thread bridge doorbell, cheaper than socketpair, YF_ERROR if no eventfd
+yf_int_t  yf_bridge_open_efd(yf_socket_t* fds, yf_log_t* log);
+
 yf_int_t  yf_bridge_channel_init(yf_bridge_channel_t* bc
                 , yf_bridge_in_t* bridge
                 , yf_socket_t* channels, yf_evt_driver_t* evt_driver
@@ -37,6 +42,26 @@ yf_int_t  yf_bridge_channel_signal(yf_bridge_channel_t* bc
 yf_int_t  yf_bridge_channel_wait(yf_bridge_channel_t* bc
                 , yf_int_t is_parent, yf_log_t* log);
 
+/*
+* futex, lives in shm, for blocked proc childs, no fd read/write pair
+* waker bump seq then wake, waiter sleep only if seq still the seen one
+*/
+#ifdef  HAVE_LINUX_FUTEX_H
+#define YF_BRIDGE_HAVE_FUTEX 1
+#endif
+
+typedef struct yf_bridge_futex_s
+{
+        volatile yf_u32_t  seq;
+        char  pad[YF_TQ_CACHE_LINE - sizeof(yf_u32_t)];
+}
+yf_bridge_futex_t;
+
+void  yf_bridge_futex_signal(yf_bridge_futex_t* bf, yf_log_t* log);
+
+//ret at once if seq != seen, may ret spuriously (signal), caller check again
+void  yf_bridge_futex_wait(yf_bridge_futex_t* bf, yf_u32_t seen, yf_log_t* log);
+
 /*
 * mutex+cond
 */
@@ -64,7 +89,8 @@ yf_int_t  yf_bridge_mutex_unlock(yf_bridge_mutex_t* bm
 yf_int_t  yf_bridge_mutex_signal(yf_bridge_mutex_t* bm, yf_int_t alreay_locked
                 , yf_log_t* log);
 
+//wait only if tq empty (checked with the mutex), so no lost signal
 yf_int_t  yf_bridge_mutex_wait(yf_bridge_mutex_t* bm
-                , yf_log_t* log);
+                , yf_task_queue_t* tq, yf_log_t* log);
 
 #endif
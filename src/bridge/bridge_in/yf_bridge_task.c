@@ -5,22 +5,37 @@
 #define yf_tq_head_len yf_align(sizeof(yf_task_queue_t), YF_ALIGNMENT)
 #define yf_tq_buf(tq) ((char*)(tq) + yf_tq_head_len)
 
-static void yf_tq_buf_add(yf_task_queue_t* queue, size_t* write_off
-                , char* buf, size_t len, yf_log_t* log);
-
-static yf_int_t yf_tq_buf_get(yf_task_queue_t* queue, size_t* read_off
-                , char* buf, size_t len, yf_log_t* log);
-
 typedef struct yf_task_head_s
 {
         yf_u32_t  magic;
         yf_u32_t  task_len;
         yf_u32_t  inqueue_time;
+        //YF_TQ_REC_xxx
+        yf_u32_t  skip;
 
         task_info_t task_info;
 }
 yf_task_head_t;
 
+#define YF_TQ_REC_LIVE 0
+//tail room mark, no task, next task at the ring head
+#define YF_TQ_REC_TAIL 1
+//consumed out of order by edf peek
+#define YF_TQ_REC_DONE 2
+
+#define yf_tq_rec_len(task_len) yf_align_mem(sizeof(yf_task_head_t) + (task_len))
+
+//node offset in high 32 bits, seq in low, both go up/down one by one, so mix
+#define yf_tq_cancel_slot(id) (((((yf_u32_t)(id) * 2654435761u) \
+                ^ ((yf_u32_t)((id) >> 32) * 2246822507u)) >> 16) % YF_TQ_CANCEL_SLOTS)
+#define yf_tq_cancelled(queue, id) ((queue)->cancel_ids[yf_tq_cancel_slot(id)] == (id))
+
+//ms, never timeout task is the last
+#define yf_tq_deadline(info) ((info)->timeout_ms \
+                ? (yf_u64_t)(info)->inqueue_time.tv_sec * 1000 \
+                        + (info)->inqueue_time.tv_msec + (info)->timeout_ms \
+                : (yf_u64_t)-1)
+
 
 yf_task_queue_t*  yf_init_task_queue(char* buf, size_t size, yf_log_t* log)
 {
@@ -41,46 +56,453 @@ yf_task_queue_t*  yf_init_task_queue(char* buf, size_t size, yf_log_t* log)
 
         yf_memzero(buf, yf_tq_head_len);
         yf_set_magic(queue->magic);
-        queue->capacity = size - yf_tq_head_len;
-        
+        //task head must be aligned in ring
+        queue->capacity = (size - yf_tq_head_len) & ~(YF_ALIGNMENT - 1);
+        //no consumer yet, first task must ring
+        queue->parked = 1;
+        yf_lock_init(&queue->consumer_lock);
+        queue->lane_num = 1;
+        //-1 is never a task id
+        yf_memset((void*)queue->cancel_ids, 0xff, sizeof(queue->cancel_ids));
+
         return queue;
 }
 
 
+yf_task_queue_t*  yf_init_task_lanes(char* buf, size_t size
+                , yf_u32_t lane_num, yf_u32_t weighted, yf_log_t* log)
+{
+        yf_u32_t  i1;
+        yf_task_queue_t* queue = (yf_task_queue_t*)buf;
+        size_t  lane_size;
+
+        if (lane_num <= 1)
+                return yf_init_task_queue(buf, size, log);
+
+        if (yf_check_magic(queue->magic))
+                return queue;
+
+        lane_num = yf_min(lane_num, YF_TQ_MAX_LANE);
+        lane_size = (size / lane_num) & ~(YF_ALIGNMENT - 1);
+
+        for (i1 = 0; i1 < lane_num; i1++)
+        {
+                yf_init_task_queue(buf + i1 * lane_size, lane_size, log);
+        }
+
+        queue->lane_num = lane_num;
+        queue->lane_weighted = weighted;
+        queue->lane_size = lane_size;
+        //first turn go to lane 0
+        queue->lane_cur = lane_num - 1;
+        queue->lane_left = 0;
+
+        yf_log_debug2(YF_LOG_DEBUG, log, 0, "task lanes inited, num=%d, lane size=%d", 
+                        lane_num, lane_size);
+        return queue;
+}
+
+
+static yf_int_t  yf_tq_has_task(yf_task_queue_t* queue)
+{
+        size_t  read_off = queue->read_offset;
+        yf_task_head_t* head;
+
+        if (yf_tq_data_len(queue->capacity, read_off, yf_tq_wo(queue, 
+                        yf_atomic_load_acquire(&queue->write_offset))) == 0)
+                return 0;
+        if (!queue->mp)
+                return 1;
+
+        //the first record may be claimed only, its producer ring after publish
+        if (queue->capacity - read_off < sizeof(yf_task_head_t))
+                read_off = 0;
+        head = (yf_task_head_t*)(yf_tq_buf(queue) + read_off);
+        return yf_atomic_load_acquire(&head->magic) == YF_MAGIC_VAL;
+}
+
+yf_task_queue_t*  yf_task_lane_next(yf_task_queue_t* queue)
+{
+        yf_u32_t  i1;
+        yf_task_queue_t* lane;
+
+        if (queue->lane_num <= 1)
+                return queue;
+
+        if (!queue->lane_weighted)
+        {
+                for (i1 = 0; i1 < queue->lane_num; i1++)
+                {
+                        lane = yf_tq_lane(queue, i1);
+                        if (yf_tq_has_task(lane))
+                                return lane;
+                }
+                return queue;
+        }
+
+        //empty lane lose its turns
+        for (i1 = 0; i1 <= queue->lane_num; i1++)
+        {
+                lane = yf_tq_lane(queue, queue->lane_cur);
+                if (queue->lane_left && yf_tq_has_task(lane))
+                {
+                        --queue->lane_left;
+                        return lane;
+                }
+
+                queue->lane_cur = (queue->lane_cur + 1) % queue->lane_num;
+                queue->lane_left = 1 << (queue->lane_num - 1 - queue->lane_cur);
+        }
+        return queue;
+}
+
+
+size_t  yf_task_lanes_size(yf_task_queue_t* queue)
+{
+        yf_u32_t  i1;
+        size_t  size = 0;
+
+        for (i1 = 0; i1 < queue->lane_num; i1++)
+                size += yf_tq_buf_size(yf_tq_lane(queue, i1));
+        return size;
+}
+
+
+/*
+* producer side, only touch the consumer's read_offset if the cached one
+* show not enough free space
+*/
+static size_t yf_tq_writable(yf_task_queue_t* queue, size_t write_off
+                , size_t require_len)
+{
+        size_t free_cap = yf_tq_free_len(queue->capacity,
+                        queue->cached_read_offset, write_off);
+
+        if (free_cap <= require_len)
+        {
+                queue->cached_read_offset = yf_atomic_load_acquire(&queue->read_offset);
+                free_cap = yf_tq_free_len(queue->capacity,
+                                queue->cached_read_offset, write_off);
+        }
+        return free_cap;
+}
+
+
+//consumer side, same as above
+static size_t yf_tq_readable(yf_task_queue_t* queue, size_t read_off
+                , size_t require_len)
+{
+        size_t data_len = yf_tq_data_len(queue->capacity,
+                        read_off, queue->cached_write_offset);
+
+        if (data_len < require_len)
+        {
+                queue->cached_write_offset = yf_tq_wo(queue, 
+                                yf_atomic_load_acquire(&queue->write_offset));
+                data_len = yf_tq_data_len(queue->capacity,
+                                read_off, queue->cached_write_offset);
+        }
+        return data_len;
+}
+
+
+/*
+* task always put contiguous in ring, if tail room not enough, then put
+* at the ring head, tail room marked by a skip head (if room enough for a
+* head, else the consumer skip it implicitly)
+* if full, return YF_AGAIN
+*/
+static yf_int_t yf_tq_place(yf_task_queue_t* queue, size_t write_off
+                , size_t task_len, size_t* rec_off, size_t* free_cap)
+{
+        size_t rec_len = yf_tq_rec_len(task_len);
+        size_t tail_cap = queue->capacity - write_off;
+        size_t require_len = rec_len;
+
+        if (tail_cap < rec_len)
+                require_len += tail_cap;
+
+        //note, must > , then can push sucess...
+        *free_cap = yf_tq_writable(queue, write_off, require_len);
+        if (unlikely(*free_cap <= require_len))
+                return  YF_AGAIN;
+
+        *rec_off = tail_cap < rec_len ? 0 : write_off;
+        return YF_OK;
+}
+
+
+//ret the write_off after the task
+static size_t yf_tq_fill_head(yf_task_queue_t* queue, size_t write_off
+                , size_t rec_off, task_info_t* task_info, size_t task_len)
+{
+        yf_task_head_t* task_head;
+        size_t tail_cap = queue->capacity - write_off;
+
+        if (rec_off != write_off && tail_cap >= sizeof(yf_task_head_t))
+        {
+                task_head = (yf_task_head_t*)(yf_tq_buf(queue) + write_off);
+                task_head->magic = YF_MAGIC_VAL;
+                task_head->skip = YF_TQ_REC_TAIL;
+                task_head->task_len = tail_cap - sizeof(yf_task_head_t);
+        }
+
+        task_head = (yf_task_head_t*)(yf_tq_buf(queue) + rec_off);
+        task_head->magic = YF_MAGIC_VAL;
+        task_head->skip = YF_TQ_REC_LIVE;
+        task_head->task_len = task_len;
+        task_head->inqueue_time = yf_now_times.clock_time.tv_sec;
+        task_head->task_info = *task_info;
+
+        return (rec_off + yf_tq_rec_len(task_len)) % queue->capacity;
+}
+
+
+/*
+* find the task at read_off, skip the tail room, done and cancelled tasks
+* if empty, return YF_AGAIN, read_off may be moved even so
+*/
+static yf_int_t yf_tq_locate(yf_task_queue_t* queue, size_t* read_off
+                , yf_task_head_t** task_head, yf_log_t* log)
+{
+        yf_task_head_t* head;
+
+        while (1)
+        {
+                //any data means a task, published or claimed (mp) 
+                if (yf_tq_readable(queue, *read_off, 1) == 0)
+                {
+                        yf_log_debug1(YF_LOG_DEBUG, log, 0, "tq empty, r=%d", *read_off);
+                        return YF_AGAIN;
+                }
+
+                if (queue->capacity - *read_off < sizeof(yf_task_head_t))
+                {
+                        *read_off = 0;
+                        continue;
+                }
+
+                head = (yf_task_head_t*)(yf_tq_buf(queue) + *read_off);
+
+                //claimed but not published yet, the ones after it wait too
+                if (yf_atomic_load_acquire(&head->magic) != YF_MAGIC_VAL)
+                {
+                        assert(queue->mp);
+                        yf_log_debug1(YF_LOG_DEBUG, log, 0, "tq unpublished, r=%d", *read_off);
+                        return YF_AGAIN;
+                }
+
+                if (head->skip == YF_TQ_REC_TAIL)
+                {
+                        *read_off = 0;
+                        continue;
+                }
+
+                if (head->skip == YF_TQ_REC_DONE 
+                        || unlikely(yf_tq_cancelled(queue, head->task_info.id)))
+                {
+                        yf_log_debug2(YF_LOG_DEBUG, log, 0, "tq skip task id=%L, skip=%d", 
+                                        head->task_info.id, head->skip);
+                        *read_off = (*read_off + yf_tq_rec_len(head->task_len)) 
+                                        % queue->capacity;
+                        continue;
+                }
+
+                *task_head = head;
+                return YF_OK;
+        }
+}
+
+
+/*
+* consumer, give back the room before read_off; if mp, zero it first, so
+* a head claimed later never looks published before its producer write it
+*/
+static void yf_tq_give_back(yf_task_queue_t* queue, size_t read_off)
+{
+        size_t  off = queue->read_offset;
+
+        if (queue->mp && off != read_off)
+        {
+                if (read_off < off)
+                {
+                        yf_memzero(yf_tq_buf(queue) + off, queue->capacity - off);
+                        off = 0;
+                }
+                yf_memzero(yf_tq_buf(queue) + off, read_off - off);
+        }
+
+        yf_atomic_store_release(&queue->read_offset, read_off);
+}
+
+
+/*
+* write task at write_off, not published untill write_offset stored
+* if full, return YF_AGAIN
+*/
+static yf_int_t yf_task_push_in(yf_task_queue_t* queue, size_t* write_off
+                , task_info_t* task_info, char* task, size_t task_len
+                , size_t* free_cap, yf_log_t* log)
+{
+        size_t rec_off;
+
+        CHECK_OK(yf_tq_place(queue, *write_off, task_len, &rec_off, free_cap));
+
+        if (task_len)
+                yf_memcpy(yf_tq_buf(queue) + rec_off + sizeof(yf_task_head_t),
+                                task, task_len);
+
+        *write_off = yf_tq_fill_head(queue, *write_off, rec_off, task_info, task_len);
+        return YF_OK;
+}
+
+
+/*
+* read task at read_off, if empty, return YF_AGAIN (read_off may be moved
+* over dead tasks); if buf too small, return YF_ERROR and read_off not moved
+*/
+static yf_int_t yf_task_pop_in(yf_task_queue_t* queue, size_t* read_off
+                , task_info_t* task_info, char* task, size_t* task_len, yf_log_t* log)
+{
+        yf_task_head_t* task_head;
+        size_t off = *read_off;
+
+        if (yf_tq_locate(queue, &off, &task_head, log) != YF_OK)
+        {
+                *read_off = off;
+                return YF_AGAIN;
+        }
+
+        if (unlikely(task_len && *task_len < task_head->task_len))
+        {
+                yf_log_error(YF_LOG_WARN, log, 0, "res buf size=%d not big enough<%d", 
+                                *task_len, task_head->task_len);
+                return YF_ERROR;
+        }
+
+        if (task_head->task_len)
+                yf_memcpy(task, task_head + 1, task_head->task_len);
+
+        if (task_info)
+                *task_info = task_head->task_info;
+        if (task_len)
+                *task_len = task_head->task_len;
+
+        *read_off = (off + yf_tq_rec_len(task_head->task_len)) % queue->capacity;
+        return YF_OK;
+}
+
+
 yf_int_t  yf_task_push(yf_task_queue_t* queue, task_info_t* task_info
                 , char* task, size_t task_len, yf_log_t* log)
 {
         assert(yf_check_magic(queue->magic));
-        
-        size_t free_cap = yf_tq_free_capacity(queue);
-        size_t require_len = task_len + sizeof(yf_task_head_t);
-        size_t write_off;
 
-        //note, must > , then can push sucess...
-        if (unlikely(free_cap <= require_len))
+        size_t free_cap;
+        size_t write_off = queue->write_offset;
+
+        if (unlikely(yf_task_push_in(queue, &write_off, task_info, task, task_len,
+                        &free_cap, log) != YF_OK))
         {
                 yf_log_error(YF_LOG_WARN, log, 0, "tq free_cap=%d, require_len=%d, push fail", 
-                                free_cap, require_len);
+                                free_cap, task_len + sizeof(yf_task_head_t));
                 return  YF_ERROR;
         }
 
-        yf_task_head_t task_head = {YF_MAGIC_VAL, task_len, 
-                        yf_now_times.clock_time.tv_sec, *task_info};
-
-        write_off = queue->write_offset;
-        
-        yf_tq_buf_add(queue, &write_off, (char*)&task_head, sizeof(yf_task_head_t), log);
-        if (task_len)
-                yf_tq_buf_add(queue, &write_off, task, task_len, log);
-
-        queue->write_offset = write_off;
+        yf_atomic_store_release(&queue->write_offset, write_off);
 
         yf_log_debug5(YF_LOG_DEBUG, log, 0, 
                         "tq cap=%d, free=%d, after task push, r=%d, w=%d, tlen=%d", 
                         queue->capacity, yf_tq_free_capacity(queue), 
-                        queue->read_offset, queue->write_offset, 
+                        queue->cached_read_offset, queue->write_offset,
                         task_len);
-        
+
+        return YF_OK;
+}
+
+
+void  yf_task_queue_set_mp(yf_task_queue_t* queue)
+{
+        yf_u32_t  i1;
+        yf_task_queue_t* lane;
+
+        for (i1 = 0; i1 < queue->lane_num; i1++)
+        {
+                lane = yf_tq_lane(queue, i1);
+                assert(lane->read_offset == lane->write_offset);
+
+                //the buf may be reused, old heads must not look published
+                yf_memzero(yf_tq_buf(lane), lane->capacity);
+                lane->pos_wrap = (((size_t)-1) >> 1) / lane->capacity * lane->capacity;
+                lane->mp = 1;
+        }
+}
+
+
+/*
+* claim [pos, pos + require_len) by cas on write_offset, a position never
+* goes back (but after pos_wrap, too many laps for a stale cas to see it
+* again), so a producer descheduled after load can't claim with a stale
+* free check; read_offset loaded after pos, the consumer never passes a
+* claimed record, so the free room got is never more than the real one
+*/
+yf_int_t  yf_task_push_mp(yf_task_queue_t* queue, task_info_t* task_info
+                , char* task, size_t task_len, yf_log_t* log)
+{
+        assert(yf_check_magic(queue->magic) && queue->mp);
+
+        yf_task_head_t* task_head;
+        size_t pos, next_pos, claim_off, rec_off, tail_cap, require_len, free_cap;
+        size_t rec_len = yf_tq_rec_len(task_len);
+
+        do {
+                pos = yf_atomic_load_acquire(&queue->write_offset);
+                claim_off = pos % queue->capacity;
+                tail_cap = queue->capacity - claim_off;
+                require_len = tail_cap < rec_len ? rec_len + tail_cap : rec_len;
+
+                free_cap = yf_tq_free_len(queue->capacity, 
+                                yf_atomic_load_acquire(&queue->read_offset), claim_off);
+                if (unlikely(free_cap <= require_len))
+                {
+                        yf_log_error(YF_LOG_WARN, log, 0, 
+                                        "tq free_cap=%d, require_len=%d, mp push fail", 
+                                        free_cap, require_len);
+                        return  YF_ERROR;
+                }
+
+                next_pos = pos + require_len;
+                if (next_pos >= queue->pos_wrap)
+                        next_pos -= queue->pos_wrap;
+        } 
+        while (!yf_atomic_cmp_swp(&queue->write_offset, pos, next_pos));
+
+        rec_off = tail_cap < rec_len ? 0 : claim_off;
+
+        //tail room mark, published at once, the consumer go to the head then
+        if (rec_off != claim_off && tail_cap >= sizeof(yf_task_head_t))
+        {
+                task_head = (yf_task_head_t*)(yf_tq_buf(queue) + claim_off);
+                task_head->skip = YF_TQ_REC_TAIL;
+                task_head->task_len = tail_cap - sizeof(yf_task_head_t);
+                yf_atomic_store_release(&task_head->magic, YF_MAGIC_VAL);
+        }
+
+        if (task_len)
+                yf_memcpy(yf_tq_buf(queue) + rec_off + sizeof(yf_task_head_t),
+                                task, task_len);
+
+        task_head = (yf_task_head_t*)(yf_tq_buf(queue) + rec_off);
+        task_head->skip = YF_TQ_REC_LIVE;
+        task_head->task_len = task_len;
+        task_head->inqueue_time = yf_now_times.clock_time.tv_sec;
+        task_head->task_info = *task_info;
+
+        //publish, the magic is the last one written
+        yf_atomic_store_release(&task_head->magic, YF_MAGIC_VAL);
+
+        yf_log_debug3(YF_LOG_DEBUG, log, 0, "tq mp push, claim=%d, pos=%d, tlen=%d", 
+                        claim_off, next_pos, task_len);
         return YF_OK;
 }
 
@@ -89,104 +511,446 @@ yf_int_t  yf_task_pop(yf_task_queue_t* queue, task_info_t* task_info
                 , char* task, size_t* task_len, yf_log_t* log)
 {
         assert(yf_check_magic(queue->magic));
-        
-        yf_task_head_t  task_head;
+
+        yf_int_t  ret;
         size_t read_off = queue->read_offset;
-        
-        CHECK_OK(yf_tq_buf_get(queue, &read_off, 
-                        (char*)&task_head, sizeof(yf_task_head_t), log));
-        assert(yf_check_magic(task_head.magic));
 
-        if (unlikely(task_len && *task_len < task_head.task_len))
+        ret = yf_task_pop_in(queue, &read_off, task_info, task, task_len, log);
+        if (ret != YF_OK)
         {
-                yf_log_error(YF_LOG_WARN, log, 0, "res buf size=%d not big enough<%d", 
-                                *task_len, task_head.task_len);
-                return YF_ERROR;
+                //dead tasks skipped, give the room back
+                if (ret == YF_AGAIN && read_off != queue->read_offset)
+                        yf_tq_give_back(queue, read_off);
+                return ret;
+        }
+
+        yf_tq_give_back(queue, read_off);
+
+        yf_log_debug3(YF_LOG_DEBUG, log, 0, "tq cap=%d, after task pop, r=%d, w=%d", 
+                        queue->capacity, queue->read_offset, queue->cached_write_offset);
+        return YF_OK;
+}
+
+
+yf_int_t  yf_task_push_batch(yf_task_queue_t* queue, yf_task_item_t* items
+                , yf_int_t num, yf_log_t* log)
+{
+        assert(yf_check_magic(queue->magic));
+
+        yf_int_t  i1;
+        size_t free_cap;
+        size_t write_off = queue->write_offset;
+
+        for (i1 = 0; i1 < num; ++i1)
+        {
+                if (yf_task_push_in(queue, &write_off, &items[i1].task_info,
+                                items[i1].task, items[i1].task_len,
+                                &free_cap, log) != YF_OK)
+                        break;
+        }
+
+        if (i1)
+                yf_atomic_store_release(&queue->write_offset, write_off);
+
+        yf_log_debug3(YF_LOG_DEBUG, log, 0, "tq batch push %d/%d, w=%d",
+                        i1, num, write_off);
+        return i1;
+}
+
+
+yf_int_t  yf_task_pop_batch(yf_task_queue_t* queue, yf_task_item_t* items
+                , yf_int_t num, yf_log_t* log)
+{
+        assert(yf_check_magic(queue->magic));
+
+        yf_int_t  i1;
+        size_t read_off = queue->read_offset;
+
+        for (i1 = 0; i1 < num; ++i1)
+        {
+                if (yf_task_pop_in(queue, &read_off, &items[i1].task_info,
+                                items[i1].task, &items[i1].task_len, log) != YF_OK)
+                        break;
+        }
+
+        if (read_off != queue->read_offset)
+                yf_tq_give_back(queue, read_off);
+
+        yf_log_debug3(YF_LOG_DEBUG, log, 0, "tq batch pop %d/%d, r=%d",
+                        i1, num, read_off);
+        return i1;
+}
+
+
+char* yf_task_reserve(yf_task_queue_t* queue, size_t task_len, yf_log_t* log)
+{
+        assert(yf_check_magic(queue->magic));
+
+        size_t free_cap;
+
+        if (unlikely(yf_tq_place(queue, queue->write_offset, task_len,
+                        &queue->reserve_offset, &free_cap) != YF_OK))
+        {
+                yf_log_error(YF_LOG_WARN, log, 0, "tq free_cap=%d, task_len=%d, reserve fail", 
+                                free_cap, task_len);
+                return NULL;
         }
 
-        if (task_head.task_len) {
-                CHECK_OK(yf_tq_buf_get(queue, &read_off, 
-                        task, task_head.task_len, log));
+        queue->reserve_len = task_len;
+        return yf_tq_buf(queue) + queue->reserve_offset + sizeof(yf_task_head_t);
+}
+
+
+void  yf_task_commit(yf_task_queue_t* queue, task_info_t* task_info
+                , size_t task_len, yf_log_t* log)
+{
+        assert(task_len <= queue->reserve_len);
+
+        size_t write_off = yf_tq_fill_head(queue, queue->write_offset,
+                        queue->reserve_offset, task_info, task_len);
+
+        yf_atomic_store_release(&queue->write_offset, write_off);
+
+        yf_log_debug2(YF_LOG_DEBUG, log, 0, "tq task commit, w=%d, tlen=%d", 
+                        write_off, task_len);
+}
+
+
+yf_int_t  yf_task_peek(yf_task_queue_t* queue, task_info_t* task_info
+                , char** task, size_t* task_len, yf_log_t* log)
+{
+        return yf_task_peek_edf(queue, 1, task_info, task, task_len, log);
+}
+
+
+yf_int_t  yf_task_peek_edf(yf_task_queue_t* queue, yf_u32_t window
+                , task_info_t* task_info, char** task, size_t* task_len, yf_log_t* log)
+{
+        assert(yf_check_magic(queue->magic));
+
+        yf_int_t  ret;
+        yf_u32_t  i1;
+        yf_task_head_t* task_head, *best;
+        size_t off = queue->read_offset;
+        size_t first_off, best_off;
+        yf_u64_t  deadline, best_deadline;
+
+        ret = yf_tq_locate(queue, &off, &task_head, log);
+
+        //dead tasks skipped, give the room back
+        if (off != queue->read_offset)
+                yf_tq_give_back(queue, off);
+        CHECK_OK(ret);
+
+        first_off = best_off = off;
+        best = task_head;
+        best_deadline = yf_tq_deadline(&task_head->task_info);
+
+        for (i1 = 1; i1 < window; i1++)
+        {
+                off = (off + yf_tq_rec_len(task_head->task_len)) % queue->capacity;
+                if (yf_tq_locate(queue, &off, &task_head, log) != YF_OK)
+                        break;
+
+                deadline = yf_tq_deadline(&task_head->task_info);
+                if (deadline < best_deadline)
+                {
+                        best_deadline = deadline;
+                        best_off = off;
+                        best = task_head;
+                }
         }
-        
-        queue->read_offset = read_off;
 
         if (task_info)
-                *task_info = task_head.task_info;
-        if (task_len)
-                *task_len = task_head.task_len;
+                *task_info = best->task_info;
+        *task = (char*)(best + 1);
+        *task_len = best->task_len;
 
-        yf_log_debug3(YF_LOG_DEBUG, log, 0, "tq cap=%d, after task pop, r=%d, w=%d", 
-                        queue->capacity, queue->read_offset, queue->write_offset);
+        queue->peek_rec_offset = best_off;
+        queue->peek_ooo = (best_off != first_off);
+        queue->peek_offset = (best_off + yf_tq_rec_len(best->task_len)) % queue->capacity;
         return YF_OK;
 }
 
 
-void yf_tq_buf_add(yf_task_queue_t* queue, size_t* write_off
-                , char* buf, size_t len, yf_log_t* log)
+void  yf_task_release(yf_task_queue_t* queue, yf_log_t* log)
 {
-        size_t tail_cap = queue->capacity - *write_off;
-        ssize_t rest_len = len - tail_cap;
-        
-        char* tq_buf = yf_tq_buf(queue);
+        yf_task_head_t* task_head;
 
-        yf_memcpy(tq_buf + *write_off, buf, rest_len > 0 ? tail_cap : len);
-        
-        /*yf_log_debug2(YF_LOG_DEBUG, log, 0, "write to %d len=%d", 
-                        *write_off, rest_len > 0 ? tail_cap : len);*/
-        
-        if (rest_len < 0)
+        //tasks before it not consumed yet, skipped once they are
+        if (queue->peek_ooo)
         {
-                *write_off += len;
-        }
-        else if (rest_len == 0) {
-                *write_off = 0;
+                task_head = (yf_task_head_t*)(yf_tq_buf(queue) + queue->peek_rec_offset);
+                task_head->skip = YF_TQ_REC_DONE;
+                queue->done_marked = 1;
+
+                yf_log_debug1(YF_LOG_DEBUG, log, 0, "tq task done out of order, off=%d", 
+                                queue->peek_rec_offset);
+                return;
         }
-        else {
-                //yf_log_debug1(YF_LOG_DEBUG, log, 0, "write to 0 len=%d", rest_len);
-                
-                yf_memcpy(tq_buf, buf + tail_cap, rest_len);
-                *write_off = rest_len;
+
+        //move over the done tasks after it too
+        if (queue->done_marked 
+                && yf_tq_locate(queue, &queue->peek_offset, &task_head, log) != YF_OK)
+                queue->done_marked = 0;
+
+        yf_tq_give_back(queue, queue->peek_offset);
+
+        yf_log_debug1(YF_LOG_DEBUG, log, 0, "tq task release, r=%d", queue->peek_offset);
+}
+
+
+void  yf_task_cancel(yf_task_queue_t* queue, yf_u64_t id)
+{
+        queue->cancel_ids[yf_tq_cancel_slot(id)] = id;
+}
+
+
+yf_int_t  yf_task_queue_empty(yf_task_queue_t* queue)
+{
+        yf_u32_t  i1;
+        yf_task_queue_t* lane;
+
+        for (i1 = 0; i1 < queue->lane_num; i1++)
+        {
+                lane = yf_tq_lane(queue, i1);
+                if (yf_tq_has_task(lane))
+                        return 0;
         }
+        return 1;
 }
 
 
-yf_int_t yf_tq_buf_get(yf_task_queue_t* queue, size_t* read_off
-                , char* buf, size_t len, yf_log_t* log)
+yf_int_t  yf_task_park(yf_task_queue_t* queue)
 {
-        size_t buf_size = ((queue)->write_offset + (queue)->capacity - *read_off) \
-                        % (queue)->capacity;
-        
-        if (buf_size < len)
+        queue->parked = 1;
+        //store parked before load write_offset, pair with yf_task_need_signal
+        yf_memory_barrier();
+
+        if (!yf_task_queue_empty(queue))
         {
-                yf_log_debug2(YF_LOG_DEBUG, log, 0, "tq buf size=%d < ask len=%d", 
-                                buf_size, len);
+                queue->parked = 0;
                 return YF_AGAIN;
         }
+        return YF_OK;
+}
+
+
+yf_int_t  yf_task_need_signal(yf_task_queue_t* queue)
+{
+        //store write_offset before load parked
+        yf_memory_barrier();
+
+        return queue->parked && yf_atomic_cmp_swp(&queue->parked, 1, 0);
+}
+
+
+/*
+* blob arena
+*/
+typedef struct yf_blob_head_s
+{
+        //task id, 0 if taken
+        yf_atomic_t  owner;
+        size_t  len;
+        yf_u32_t  chunks;
+}
+yf_blob_head_t;
+
+#define yf_blob_head_len yf_align_mem(sizeof(yf_blob_head_t))
+
+#define yf_blob_arena_head_len(chunk_num) yf_align_mem(sizeof(yf_blob_arena_t) \
+                + sizeof(yf_u64_t) * (((chunk_num) + 63) >> 6))
+
+#define yf_blob_chunk(arena, index) ((char*)(arena) + (arena)->data_offset \
+                + (size_t)(index) * (arena)->chunk_size)
+
+#define yf_blob_chunk_size(chunk_size) yf_align_mem(yf_max(chunk_size, \
+                2 * yf_blob_head_len))
+
+
+size_t  yf_blob_arena_size(size_t size, size_t chunk_size)
+{
+        yf_u32_t  chunk_num;
+
+        if (chunk_size == 0)
+                chunk_size = YF_BLOB_CHUNK_SIZE;
+        chunk_size = yf_blob_chunk_size(chunk_size);
+        chunk_num = size / chunk_size;
+
+        return  yf_blob_arena_head_len(chunk_num) + chunk_num * chunk_size;
+}
+
+
+yf_blob_arena_t*  yf_init_blob_arena(char* buf, size_t size
+                , size_t chunk_size, yf_log_t* log)
+{
+        yf_blob_arena_t* arena = (yf_blob_arena_t*)buf;
+        yf_u32_t  chunk_num;
+
+        if (yf_check_magic(arena->magic))
+        {
+                yf_log_debug2(YF_LOG_DEBUG, log, 0, 
+                                "blob arena already inited, chunks=%d, free=%d", 
+                                arena->chunk_num, arena->free_num);
+                return arena;
+        }
+
+        if (chunk_size == 0)
+                chunk_size = YF_BLOB_CHUNK_SIZE;
+        chunk_size = yf_blob_chunk_size(chunk_size);
+
+        //size is the whole buf, so the bitmap comes out of it
+        chunk_num = size / chunk_size;
+        while (chunk_num && yf_blob_arena_head_len(chunk_num) 
+                        + chunk_num * chunk_size > size)
+                --chunk_num;
+
+        if (chunk_num == 0)
+        {
+                yf_log_error(YF_LOG_ERR, log, 0, "too small blob arena, size=%d", size);
+                return NULL;
+        }
+
+        yf_memzero(buf, yf_blob_arena_head_len(chunk_num));
+        yf_set_magic(arena->magic);
+        yf_lock_init(&arena->lock);
+        arena->chunk_size = chunk_size;
+        arena->chunk_num = chunk_num;
+        arena->free_num = chunk_num;
+        arena->data_offset = yf_blob_arena_head_len(chunk_num);
+
+        yf_log_debug2(YF_LOG_DEBUG, log, 0, "blob arena inited, chunks=%d, chunk size=%d", 
+                        chunk_num, chunk_size);
+        return arena;
+}
+
+
+//first fit in [begin, chunk_num), ret -1 if not found
+static yf_s64_t  yf_blob_scan(yf_blob_arena_t* arena, yf_u32_t begin, yf_u32_t num)
+{
+        yf_u32_t  i1 = begin;
+        yf_u32_t  run = 0;
+
+        while (i1 < arena->chunk_num)
+        {
+                //full word
+                if ((i1 & 63) == 0 && arena->bits[i1 >> 6] == (yf_u64_t)-1)
+                {
+                        run = 0;
+                        i1 += 64;
+                        continue;
+                }
+
+                if (yf_test_bit(arena->bits[i1 >> 6], i1 & 63))
+                        run = 0;
+                else if (++run == num)
+                        return i1 + 1 - num;
+                ++i1;
+        }
+        return -1;
+}
+
 
-        size_t tail_cap = queue->capacity - *read_off;
-        ssize_t rest_len = len - tail_cap;
-        
-        char* tq_buf = yf_tq_buf(queue);
+static void  yf_blob_mark(yf_blob_arena_t* arena, yf_u32_t index
+                , yf_u32_t num, yf_int_t used)
+{
+        yf_u32_t  i1;
 
-        yf_memcpy(buf, tq_buf + *read_off, rest_len > 0 ? tail_cap : len);
-        
-        /*yf_log_debug2(YF_LOG_DEBUG, log, 0, "read from %d len=%d", 
-                        *read_off, rest_len > 0 ? tail_cap : len);*/
-        
-        if (rest_len < 0)
+        for (i1 = index; i1 < index + num; i1++)
         {
-                *read_off += len;
+                if (used)
+                        yf_set_bit(arena->bits[i1 >> 6], i1 & 63);
+                else
+                        yf_reset_bit(arena->bits[i1 >> 6], i1 & 63);
         }
-        else if (rest_len == 0) {
-                *read_off = 0;
+}
+
+
+char*  yf_blob_alloc(yf_blob_arena_t* arena, size_t len, yf_u64_t id
+                , yf_u32_t* handle, yf_log_t* log)
+{
+        yf_s64_t  index = -1;
+        yf_blob_head_t* head;
+        yf_u32_t  num = (yf_blob_head_len + len + arena->chunk_size - 1) 
+                        / arena->chunk_size;
+
+        assert(yf_check_magic(arena->magic));
+
+        yf_lock(&arena->lock);
+
+        if (num <= arena->free_num)
+        {
+                index = yf_blob_scan(arena, arena->hint, num);
+                if (index < 0 && arena->hint)
+                        index = yf_blob_scan(arena, 0, num);
         }
-        else {
-                //yf_log_debug1(YF_LOG_DEBUG, log, 0, "read from 0 len=%d", rest_len);
-                
-                yf_memcpy(buf + tail_cap, tq_buf, rest_len);
-                *read_off = rest_len;
+
+        if (index < 0)
+        {
+                yf_unlock(&arena->lock);
+                yf_log_error(YF_LOG_WARN, log, 0, "blob alloc failed, len=%d, free chunks=%d", 
+                                len, arena->free_num);
+                return NULL;
         }
 
+        yf_blob_mark(arena, index, num, 1);
+        arena->free_num -= num;
+        arena->hint = index + num < arena->chunk_num ? index + num : 0;
+
+        yf_unlock(&arena->lock);
+
+        head = (yf_blob_head_t*)yf_blob_chunk(arena, index);
+        head->owner = id;
+        head->len = len;
+        head->chunks = num;
+
+        *handle = index + 1;
+
+        yf_log_debug3(YF_LOG_DEBUG, log, 0, "blob alloc handle=%d, len=%d, chunks=%d", 
+                        *handle, len, num);
+        return (char*)head + yf_blob_head_len;
+}
+
+
+char*  yf_blob_take(yf_blob_arena_t* arena, yf_u32_t handle, yf_u64_t id
+                , size_t* len)
+{
+        yf_blob_head_t* head;
+
+        if (unlikely(handle == 0 || handle > arena->chunk_num))
+                return NULL;
+
+        head = (yf_blob_head_t*)yf_blob_chunk(arena, handle - 1);
+        if (!yf_atomic_cmp_swp(&head->owner, id, 0))
+                return NULL;
+
+        *len = head->len;
+        return (char*)head + yf_blob_head_len;
+}
+
+
+yf_int_t  yf_blob_reclaim(yf_blob_arena_t* arena, yf_u32_t handle, yf_u64_t id)
+{
+        size_t  len;
+
+        if (yf_blob_take(arena, handle, id, &len) == NULL)
+                return YF_AGAIN;
+
+        yf_blob_free(arena, handle);
         return YF_OK;
 }
+
+
+void  yf_blob_free(yf_blob_arena_t* arena, yf_u32_t handle)
+{
+        yf_blob_head_t* head;
+
+        assert(handle && handle <= arena->chunk_num);
+        head = (yf_blob_head_t*)yf_blob_chunk(arena, handle - 1);
+
+        yf_lock(&arena->lock);
+        yf_blob_mark(arena, handle - 1, head->chunks, 0);
+        arena->free_num += head->chunks;
+        yf_unlock(&arena->lock);
+}
@@ -15,39 +15,260 @@ typedef struct task_info_s
         yf_u32_t  timeout_ms:20;
         yf_u32_t  timeout:1;
         yf_u32_t  error:1;
+        //task body is a blob handle, see yf_blob_arena_t
+        yf_u32_t  blob:1;
 }
 task_info_t;
 
+/*
+* single producer single consumer ring, may live in shm shared by parent
+* and child procs, so use explicit pad (not aligned attr) to keep consumer
+* side and producer side on different cache lines, then the layout never
+* depends on build flags
+*/
+#define YF_TQ_CACHE_LINE  64
+
+//cancelled ids kept per queue, slot by id, newer cancel overwrite older
+#define YF_TQ_CANCEL_SLOTS  64
+
 typedef struct yf_task_queue_s
 {
         yf_u32_t magic;
         size_t  capacity;
 
+        //priority lanes, just set in the base (first) lane, lanes are
+        //contiguous (lane_size apart), lane 0 has the highest priority
+        yf_u32_t  lane_num;
+        yf_u32_t  lane_weighted;
+        size_t  lane_size;
+        //multi producers, write_offset is a claim position in [0, pos_wrap)
+        yf_u32_t  mp;
+        size_t  pos_wrap;
+        char  pad0[YF_TQ_CACHE_LINE];
+
         /*
         * note, if read_offset == write_offset, then tq is empty to read
         * the free size must > 0 (else cant identify empty with full)
         */
+        //consumer side, cached_write_offset is the last seen write_offset
         volatile size_t  read_offset;
+        size_t  cached_write_offset;
+        size_t  peek_offset;
+        //edf peek, the peeked record and if it is not the first one
+        //done_marked, tasks done out of order may be still in the ring
+        size_t  peek_rec_offset;
+        yf_u32_t  peek_ooo;
+        yf_u32_t  done_marked;
+        //only used if sibling consumers may steal from this queue
+        yf_lock_t  consumer_lock;
+        //weighted lanes draining, the lane now and its turns left
+        yf_u32_t  lane_cur;
+        yf_u32_t  lane_left;
+        char  pad1[YF_TQ_CACHE_LINE];
+
+        //producer side, cached_read_offset is the last seen read_offset
         volatile size_t  write_offset;
+        size_t  cached_read_offset;
+        size_t  reserve_offset;
+        size_t  reserve_len;
+        char  pad2[YF_TQ_CACHE_LINE];
+
+        //consumer parked (waiting the doorbell), set by consumer, clear by both
+        yf_atomic_t  parked;
+        char  pad3[YF_TQ_CACHE_LINE];
+
+        //set by the producer side, consumer skip the queued task if found
+        volatile yf_u64_t  cancel_ids[YF_TQ_CANCEL_SLOTS];
 }
 yf_task_queue_t;
 
+typedef struct yf_task_item_s
+{
+        task_info_t  task_info;
+        char*  task;
+        //push: task len; pop: in buf size, out task len
+        size_t  task_len;
+}
+yf_task_item_t;
+
 
 yf_task_queue_t*  yf_init_task_queue(char* buf, size_t size, yf_log_t* log);
 
+/*
+* priority lanes, buf split into lane_num queues, the base (first) one is
+* returned, its doorbell (park/need_signal) is shared by all lanes
+* strict: always drain the higher lane first
+* weighted: lane i take 2^(lane_num-1-i) tasks per round, no starving
+*/
+#define YF_TQ_MAX_LANE 4
+
+yf_task_queue_t*  yf_init_task_lanes(char* buf, size_t size
+                , yf_u32_t lane_num, yf_u32_t weighted, yf_log_t* log);
+
+//lane >= lane_num will use the last (lowest) lane
+#define yf_tq_lane(tq, lane) ((yf_task_queue_t*)((char*)(tq) \
+                + yf_min((yf_u32_t)(lane), (tq)->lane_num - 1) * (tq)->lane_size))
+
+//consumer, the lane to consume next, base if all empty
+yf_task_queue_t*  yf_task_lane_next(yf_task_queue_t* queue);
+
+//data size of all lanes, snapshot
+size_t  yf_task_lanes_size(yf_task_queue_t* queue);
+
 yf_int_t  yf_task_push(yf_task_queue_t* queue, task_info_t* task_info
                 , char* task, size_t task_len, yf_log_t* log);
 
+/*
+* multi producers single consumer, lock free, set before any push, then
+* every producer of the queue must push by yf_task_push_mp (no batch or
+* reserve then); if lanes, called with the base lane
+* room is claimed by cas on a position that never goes back (mod pos_wrap,
+* a multiple of capacity), each record published by its own head, so no
+* producer waits another; the consumer stops at the first record claimed
+* but not published yet, and zero the room it gives back, then stale data
+* never looks published
+*/
+void  yf_task_queue_set_mp(yf_task_queue_t* queue);
+
+yf_int_t  yf_task_push_mp(yf_task_queue_t* queue, task_info_t* task_info
+                , char* task, size_t task_len, yf_log_t* log);
+
 //if empty, will return YF_AGAIN...
 yf_int_t  yf_task_pop(yf_task_queue_t* queue, task_info_t* task_info
                 , char* task, size_t* task_len, yf_log_t* log);
 
+/*
+* batch, the offset is published once for all the tasks
+* return the num of tasks pushed/poped, push stop at the first task
+* which cant be put in, pop stop if empty or the item's buf too small
+*/
+yf_int_t  yf_task_push_batch(yf_task_queue_t* queue, yf_task_item_t* items
+                , yf_int_t num, yf_log_t* log);
+
+yf_int_t  yf_task_pop_batch(yf_task_queue_t* queue, yf_task_item_t* items
+                , yf_int_t num, yf_log_t* log);
+
+/*
+* zero copy, task is always contiguous in the ring (tail room skipped if
+* not enough), so can be filled/read in place
+* reserve ret NULL if full, commit len must <= reserved len
+*/
+char* yf_task_reserve(yf_task_queue_t* queue, size_t task_len, yf_log_t* log);
+
+void  yf_task_commit(yf_task_queue_t* queue, task_info_t* task_info
+                , size_t task_len, yf_log_t* log);
+
+//task ptr valid untill release, if empty, will return YF_AGAIN...
+yf_int_t  yf_task_peek(yf_task_queue_t* queue, task_info_t* task_info
+                , char** task, size_t* task_len, yf_log_t* log);
+
+void  yf_task_release(yf_task_queue_t* queue, yf_log_t* log);
+
+/*
+* earliest deadline first, peek the task with the min (inqueue_time +
+* timeout_ms) in the first window tasks, tasks never timeout come last,
+* same deadline in fifo order; window <= 1 same as yf_task_peek
+* if not the first task, release just mark it done, the read_offset
+* moves over it later
+*/
+yf_int_t  yf_task_peek_edf(yf_task_queue_t* queue, yf_u32_t window
+                , task_info_t* task_info, char** task, size_t* task_len, yf_log_t* log);
+
+/*
+* mark a queued task dead, then pop/peek skip it, may be called by the
+* producer side (with the producer's lock if any) at any time; if the task
+* already taken by the consumer, no effect
+*/
+void  yf_task_cancel(yf_task_queue_t* queue, yf_u64_t id);
+
+/*
+* doorbell suppression, consumer park before wait the doorbell, producer
+* ring it only if consumer parked, so no signal syscall while consumer busy
+* park ret YF_AGAIN if task arrived (not parked, go on consuming)
+* need_signal must be called after the task published
+* if lanes, both called with the base lane
+*/
+yf_int_t  yf_task_park(yf_task_queue_t* queue);
+
+/*
+* no lock, just a hint if producer/consumer run, all lanes checked
+*/
+yf_int_t  yf_task_queue_empty(yf_task_queue_t* queue);
+
+#define yf_task_unpark(queue) do { \
+                if ((queue)->parked) (queue)->parked = 0; } while (0)
+
+yf_int_t  yf_task_need_signal(yf_task_queue_t* queue);
+
+/*
+* work stealing, queue has multi consumers (owner + thieves), every pop
+* must hold the consumer lock (producer side still lock free)
+* peek/release cant be used, cause the lock would be held while handling
+*/
+#define yf_task_consumer_lock(queue) yf_lock(&(queue)->consumer_lock)
+#define yf_task_consumer_trylock(queue) yf_trylock(&(queue)->consumer_lock)
+#define yf_task_consumer_unlock(queue) yf_unlock(&(queue)->consumer_lock)
+
+/*
+* large payload side channel, a chunk arena shared by the parent and childs
+* (in shm for proc childs), payload bigger than a task queue can hold is
+* copied into a blob once, the task just carry the blob handle
+* a blob is stamped with its task id, the consumer take it by clear the id
+* and free it after handled, the producer reclaim it (cancel/timeout) in the
+* same way, so never both own it; handle 0 is never a blob
+*/
+#define YF_BLOB_CHUNK_SIZE 4096
+
+typedef struct yf_blob_arena_s
+{
+        yf_u32_t  magic;
+        //spin lock, works across procs
+        yf_lock_t  lock;
+        size_t  chunk_size;
+        yf_u32_t  chunk_num;
+        yf_u32_t  free_num;
+        //next search begin
+        yf_u32_t  hint;
+        size_t  data_offset;
+        //chunks used bitmap
+        yf_u64_t  bits[0];
+}
+yf_blob_arena_t;
+
+//buf size to hold a size bytes arena, chunk_size=0 use YF_BLOB_CHUNK_SIZE
+size_t  yf_blob_arena_size(size_t size, size_t chunk_size);
+
+yf_blob_arena_t*  yf_init_blob_arena(char* buf, size_t size
+                , size_t chunk_size, yf_log_t* log);
+
+//ret NULL if no contiguous room
+char*  yf_blob_alloc(yf_blob_arena_t* arena, size_t len, yf_u64_t id
+                , yf_u32_t* handle, yf_log_t* log);
+
+//consumer, ret NULL if reclaimed by the producer, then dont free it
+char*  yf_blob_take(yf_blob_arena_t* arena, yf_u32_t handle, yf_u64_t id
+                , size_t* len);
+
+//producer, free the blob if not taken yet, ret YF_AGAIN if taken
+yf_int_t  yf_blob_reclaim(yf_blob_arena_t* arena, yf_u32_t handle, yf_u64_t id);
+
+void  yf_blob_free(yf_blob_arena_t* arena, yf_u32_t handle);
+
+#define yf_tq_free_len(cap, ro, wo) ((ro) == (wo) ? (cap) \
+                : ((ro) + (cap) - (wo)) % (cap))
+#define yf_tq_data_len(cap, ro, wo) (((wo) + (cap) - (ro)) % (cap))
+
+//write_offset of a mp queue is a position, the ring offset of it
+#define yf_tq_wo(tq, wo) ((tq)->mp ? (wo) % (tq)->capacity : (wo))
+
+/*
+* just a snapshot, dont rely on it in the producer or consumer
+*/
 //if ro == wo, all free
-#define yf_tq_free_capacity(tq) ((tq)->read_offset == (tq)->write_offset ? (tq)->capacity \
-                : ((tq)->read_offset + (tq)->capacity - (tq)->write_offset) \
-                        % (tq)->capacity)
+#define yf_tq_free_capacity(tq) yf_tq_free_len((tq)->capacity \
+                , (tq)->read_offset, yf_tq_wo(tq, (tq)->write_offset))
 //if ro == wo, empty
-#define yf_tq_buf_size(tq) (((tq)->write_offset + (tq)->capacity - (tq)->read_offset) \
-                % (tq)->capacity)
+#define yf_tq_buf_size(tq) yf_tq_data_len((tq)->capacity \
+                , (tq)->read_offset, yf_tq_wo(tq, (tq)->write_offset))
 
 #endif
@@ -16,17 +16,21 @@ static int __cmp_tid(const void *p1, const void *p2)
 * all child threads), then iterate...all
 * though right here, but cause bug if child thread not sorted, changed again on 22:54
 */
-#define yf_bridge_tno(bridge, bridge_bt, child_no) \
+/*
+* changed on elastic, tids [0, sorted_num) sorted when created, threads added
+* later (resize) are appended, so iterate if not found
+*/
+#define yf_bridge_tno(bridge, bridge_bt, child_no, sorted_num) \
         child_no = -1; \
         yf_tid_t tid = yf_thread_self(); \
         yf_int_t i1 = 0; \
         if (bridge->ctx.exec_func) { \
-                yf_bsearch(tid, bridge_bt->tids, bridge->ctx.child_num, yf_bsearch_cmp, i1); \
-                assert(i1 < bridge->ctx.child_num && bridge_bt->tids[i1] == tid); \
-                child_no = i1; \
+                yf_bsearch(tid, bridge_bt->tids, sorted_num, yf_bsearch_cmp, i1); \
+                if (i1 < sorted_num && bridge_bt->tids[i1] == tid) \
+                        child_no = i1; \
         } \
-        else { \
-                for ( i1 = 0; i1 <  bridge->ctx.child_num; i1++ ) \
+        if (child_no < 0) { \
+                for ( i1 = 0; i1 <  bridge->ctx.max_child_num; i1++ ) \
                 { \
                         if (bridge_bt->tids[i1] == tid) {\
                                 child_no = i1; \
@@ -60,6 +64,12 @@ typedef struct yf_bridge_thr_s
         yf_task_queue_t** tqs;
         yf_task_queue_t** rtqs;
         yf_lock_t  attach_lock;
+
+        //childs [0, opened_num) have channel (and thread), never closed
+        yf_uint_t  opened_num;
+        yf_uint_t  sorted_num;
+        yf_evt_driver_t* evt_driver;
+        yf_int_t  res_attached;
 }
 yf_bridge_thr_t;
 
@@ -107,7 +117,7 @@ static yf_int_t yf_bridge_thr_attach_res_bridge(yf_bridge_in_t* bridge
         yf_int_t ret;
         yf_bridge_thr_t* bridge_thr = (yf_bridge_thr_t*)bridge->bridge_data;
         
-        for ( i1 = 0; i1 <  bridge->ctx.child_num; i1++ )
+        for ( i1 = 0; i1 <  bridge_thr->opened_num; i1++ )
         {
                 ret = yf_bridge_channel_init(bridge_thr->channels + i1, 
                                 bridge, bridge_thr->socks + 2*i1, 
@@ -118,6 +128,9 @@ static yf_int_t yf_bridge_thr_attach_res_bridge(yf_bridge_in_t* bridge
                         return ret;
                 }
         }
+
+        bridge_thr->evt_driver = evt_driver;
+        bridge_thr->res_attached = 1;
         return YF_OK;
 }
 
@@ -144,7 +157,7 @@ static yf_int_t yf_bridge_thr_child_no(yf_bridge_in_t* bridge, yf_log_t* log)
 {
         yf_bridge_thr_t* bridge_thr = (yf_bridge_thr_t*)bridge->bridge_data;
         yf_int_t  child_no = -1;
-        yf_bridge_tno(bridge, bridge_thr, child_no);
+        yf_bridge_tno(bridge, bridge_thr, child_no, bridge_thr->sorted_num);
         return child_no;
 }
 
@@ -203,22 +216,100 @@ static void yf_bridge_thr_wait_task(yf_bridge_in_t* bridge
         yf_bridge_channel_wait(bridge_thr->channels + child_no, 0, log);
 }
 
+
+/*
+* open child's channel, init parent side if res bridge attached, then
+* start the child thread if exec_func
+* should be called with attach_lock locked
+*/
+static yf_int_t yf_bridge_thr_open_child(yf_bridge_in_t* bridge
+                , yf_int_t child_no, yf_log_t* log)
+{
+        yf_int_t  ret;
+        yf_bridge_thr_t* bridge_thr = (yf_bridge_thr_t*)bridge->bridge_data;
+        yf_socket_t* socks = bridge_thr->socks + 2*child_no;
+
+        //TODO
+        if (yf_bridge_open_efd(socks, log) == YF_OK)
+                bridge_thr->channels[child_no].efd = 1;
+        else {
+                ret = yf_open_channel(socks, 0, 0, 1, log);
+                CHECK_OK(ret);
+        }
+
+        if (bridge_thr->res_attached)
+        {
+                ret = yf_bridge_channel_init(bridge_thr->channels + child_no, 
+                                bridge, socks, bridge_thr->evt_driver, 1, child_no, log);
+                if (unlikely(ret != YF_OK))
+                {
+                        yf_log_error(YF_LOG_WARN, log, 0, "init channel_%d failed", child_no);
+                        yf_close_channel(socks, log);
+                        return ret;
+                }
+        }
+
+        if (bridge->ctx.exec_func)
+        {
+                ret = yf_create_thread(bridge_thr->tids + child_no, 
+                                _yf_bridge_thr_t_exe, 
+                                bridge, log);
+                if (unlikely(ret != 0))
+                {
+                        yf_log_error(YF_LOG_WARN, log, 0, "create child_%d failed", child_no);
+                        if (bridge_thr->res_attached)
+                                yf_bridge_channel_uninit(bridge_thr->channels + child_no, 1, log);
+                        yf_close_channel(socks, log);
+                        return YF_ERROR;
+                }
+        }
+        return YF_OK;
+}
+
+
+//removed child threads just park when tq drained, reused if grow again
+static yf_int_t yf_bridge_thr_resize(yf_bridge_in_t* bridge
+                , yf_uint_t child_num, yf_log_t* log)
+{
+        yf_uint_t  i1;
+        yf_int_t  ret = YF_OK;
+        yf_bridge_thr_t* bridge_thr = (yf_bridge_thr_t*)bridge->bridge_data;
+
+        yf_lock(&bridge_thr->attach_lock);
+
+        for ( i1 = bridge_thr->opened_num; i1 < child_num; i1++ )
+        {
+                ret = yf_bridge_thr_open_child(bridge, i1, log);
+                if (ret != YF_OK)
+                        break;
+        }
+        bridge_thr->opened_num = yf_max(bridge_thr->opened_num, i1);
+
+        yf_unlock(&bridge_thr->attach_lock);
+
+        bridge->ctx.child_num = yf_min(child_num, bridge_thr->opened_num);
+        return ret;
+}
+
 yf_int_t  yf_bridge_et_creator(yf_bridge_in_t* bridge_in, yf_log_t* log)
 {
         yf_int_t i1 = 0;
         yf_int_t  ret;
         char* addr;
         
-        size_t  channls_size = sizeof(yf_bridge_channel_t) * bridge_in->ctx.child_num;
-        size_t  socks_size = yf_align_mem(sizeof(yf_socket_t) * bridge_in->ctx.child_num * 2);
-        size_t  tid_size = yf_align_mem(sizeof(yf_tid_t) * bridge_in->ctx.child_num);
-        size_t  tq_size = sizeof(yf_task_queue_t*) * bridge_in->ctx.child_num;
-        size_t  tq_cisze = bridge_in->ctx.child_num 
+        //all sized by max, for elastic
+        size_t  channls_size = sizeof(yf_bridge_channel_t) * bridge_in->ctx.max_child_num;
+        size_t  socks_size = yf_align_mem(sizeof(yf_socket_t) * bridge_in->ctx.max_child_num * 2);
+        size_t  tid_size = yf_align_mem(sizeof(yf_tid_t) * bridge_in->ctx.max_child_num);
+        size_t  tq_size = sizeof(yf_task_queue_t*) * bridge_in->ctx.max_child_num;
+        size_t  tq_cisze = bridge_in->ctx.max_child_num 
                                 * bridge_in->ctx.queue_capacity;
+        size_t  blob_size = bridge_in->ctx.blob_arena_size ? yf_blob_arena_size(
+                        bridge_in->ctx.blob_arena_size, bridge_in->ctx.blob_chunk_size) : 0;
         
         size_t  all_size = sizeof(yf_bridge_thr_t) 
                         + channls_size + socks_size + tid_size 
-                        + 2 * tq_size + 2 * tq_cisze;
+                        + 2 * tq_size + 2 * tq_cisze + blob_size;
         
         yf_bridge_thr_t* bridge_thr = yf_alloc(all_size);
         CHECK_RV(bridge_thr==NULL, YF_ERROR);
@@ -235,11 +326,13 @@ yf_int_t  yf_bridge_et_creator(yf_bridge_in_t* bridge_in, yf_log_t* log)
         bridge_thr->rtqs = yf_mem_off(bridge_thr->tqs, tq_size);
         addr = yf_mem_off(bridge_thr->rtqs, tq_size);
 
-        for ( i1 = 0; i1 < bridge_in->ctx.child_num; i1++ )
+        for ( i1 = 0; i1 < bridge_in->ctx.max_child_num; i1++ )
         {
-                bridge_thr->tqs[i1] = yf_init_task_queue(
+                bridge_thr->tqs[i1] = yf_init_task_lanes(
                                 yf_mem_off(addr, i1 * bridge_in->ctx.queue_capacity), 
-                                bridge_in->ctx.queue_capacity, log);
+                                bridge_in->ctx.queue_capacity, 
+                                bridge_in->ctx.task_lane_num, 
+                                bridge_in->ctx.task_lane_weighted, log);
                 
                 bridge_thr->rtqs[i1] = yf_init_task_queue(
                                 yf_mem_off(addr, tq_cisze + i1 * bridge_in->ctx.queue_capacity), 
@@ -253,6 +346,18 @@ yf_int_t  yf_bridge_et_creator(yf_bridge_in_t* bridge_in, yf_log_t* log)
                 }
         }
 
+        if (blob_size)
+        {
+                bridge_in->blob_arena = yf_init_blob_arena(
+                                yf_mem_off(addr, 2 * tq_cisze), 
+                                blob_size, bridge_in->ctx.blob_chunk_size, log);
+                if (bridge_in->blob_arena == NULL)
+                {
+                        yf_free(bridge_thr);
+                        return  YF_ERROR;
+                }
+        }
+
         //set actions
         __yf_bridge_set_ac(bridge_in, lock_tq, yf_bridge_thr);
         __yf_bridge_set_ac(bridge_in, lock_res_tq, yf_bridge_thr);
@@ -264,29 +369,30 @@ yf_int_t  yf_bridge_et_creator(yf_bridge_in_t* bridge_in, yf_log_t* log)
         __yf_bridge_set_ac(bridge_in, attach_bridge, yf_bridge_thr);
         __yf_bridge_set_ac(bridge_in, wait_task, yf_bridge_thr);
         __yf_bridge_set_ac(bridge_in, attach_child_ins, yf_bridge_thr);
+        __yf_bridge_set_ac(bridge_in, resize, yf_bridge_thr);
+
+        //parents push to the childs' tqs at the same time
+        if (yf_bridge_tq_mpsc(bridge_in))
+        {
+                for ( i1 = 0; i1 < bridge_in->ctx.max_child_num; i1++ )
+                        yf_task_queue_set_mp(bridge_thr->tqs[i1]);
+        }
 
         //locked, child thread should run after all child threads created..., 2013/02/23 22:58
         yf_lock(&bridge_thr->attach_lock);
 
         for ( i1 = 0; i1 < bridge_in->ctx.child_num ; i1++ )
         {
-                //TODO
-                ret = yf_open_channel(bridge_thr->socks + 2*i1, 0, 0, 1, log);
+                ret = yf_bridge_thr_open_child(bridge_in, i1, log);
                 assert(ret == YF_OK);
-
-                if (bridge_in->ctx.exec_func)
-                {
-                        ret = yf_create_thread(bridge_thr->tids + i1, 
-                                        _yf_bridge_thr_t_exe, 
-                                        bridge_in, log);
-                        assert(ret == 0);
-                }
         }
+        bridge_thr->opened_num = bridge_in->ctx.child_num;
 
         if (bridge_in->ctx.exec_func)
         {
                 yf_sort(bridge_thr->tids, bridge_in->ctx.child_num, 
                                 sizeof(bridge_thr->tids[0]), __cmp_tid);
+                bridge_thr->sorted_num = bridge_in->ctx.child_num;
         }
 
         yf_unlock(&bridge_thr->attach_lock);
@@ -299,6 +405,17 @@ yf_int_t  yf_bridge_et_creator(yf_bridge_in_t* bridge_in, yf_log_t* log)
 /*
 * bt creator...
 */
+#define YF_BRIDGE_SPIN_CHECK 64
+
+//per child, only its own child write
+typedef struct yf_bridge_spin_s
+{
+        //avg wait us (ewma, 1/8)
+        yf_u32_t  avg_us;
+        char  pad[YF_TQ_CACHE_LINE - sizeof(yf_u32_t)];
+}
+yf_bridge_spin_t;
+
 typedef struct yf_bridge_bt_s
 {
         yf_bridge_channel_t  channels;
@@ -306,6 +423,7 @@ typedef struct yf_bridge_bt_s
         yf_tid_t* tids;
         yf_task_queue_t* tqs;
         yf_task_queue_t* rtqs;
+        yf_bridge_spin_t* spins;
 
         yf_lock_t  attach_lock;
         yf_bridge_mutex_t  mutex;
@@ -384,7 +502,7 @@ static yf_int_t yf_bridge_bt_child_no(yf_bridge_in_t* bridge, yf_log_t* log)
 {
         yf_bridge_bt_t* bridge_bt = (yf_bridge_bt_t*)bridge->bridge_data;
         yf_int_t  child_no = -1;
-        yf_bridge_tno(bridge, bridge_bt, child_no);
+        yf_bridge_tno(bridge, bridge_bt, child_no, bridge->ctx.child_num);
 
         //yf_log_debug1(YF_LOG_DEBUG, log, 0, "child_no=%d", child_no);
         return child_no;
@@ -407,13 +525,63 @@ static yf_int_t yf_bridge_bt_attach_bridge(yf_bridge_in_t* bridge
         return YF_OK;
 }
 
+static yf_u64_t yf_bridge_spin_now_us()
+{
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (yf_u64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        return (yf_u64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+/*
+* spin with pause while the tasks come fast (avg wait < max), then a
+* short idle costs no futex sleep/wake; long idles go to the cond at once
+*/
 static void yf_bridge_bt_wait_task(yf_bridge_in_t* bridge
                 , yf_int_t child_no, yf_log_t* log)
 {
         yf_bridge_bt_t* bridge_bt = (yf_bridge_bt_t*)bridge->bridge_data;
-        
-        yf_bridge_mutex_wait(&bridge_bt->mutex, log);
+        yf_bridge_spin_t* spin;
+        yf_u64_t  begin, now, window, waited;
+        yf_uint_t  max_us = bridge->ctx.child_spin_us;
+        yf_uint_t  i1;
+
+        if (bridge_bt->spins == NULL)
+        {
+                bridge->child_stat[child_no].parked++;
+                yf_bridge_mutex_wait(&bridge_bt->mutex, bridge_bt->tqs, log);
+                goto end;
+        }
+
+        spin = bridge_bt->spins + child_no;
+        window = spin->avg_us < max_us ? yf_min(2 * spin->avg_us + 1, max_us) : 0;
+        now = begin = yf_bridge_spin_now_us();
+
+        while (now - begin < window)
+        {
+                for (i1 = 0; i1 < YF_BRIDGE_SPIN_CHECK; i1++)
+                        yf_cpu_pause();
+                if (!yf_task_queue_empty(bridge_bt->tqs))
+                        break;
+                now = yf_bridge_spin_now_us();
+        }
+
+        if (now - begin >= window)
+        {
+                bridge->child_stat[child_no].parked++;
+                yf_bridge_mutex_wait(&bridge_bt->mutex, bridge_bt->tqs, log);
+        }
 
+        //cap one long idle, else the avg need too many tasks to come back
+        waited = yf_min(yf_bridge_spin_now_us() - begin, 4 * (yf_u64_t)max_us);
+        spin->avg_us = (spin->avg_us * 7 + waited) >> 3;
+
+end:
         //should update time now after waking up...
         yf_update_time(NULL, NULL, log);
 }
@@ -439,14 +607,25 @@ yf_int_t  yf_bridge_bt_creator(yf_bridge_in_t* bridge_in, yf_log_t* log)
         if (bridge_in->ctx.task_dispatch_type != YF_TASK_DISTPATCH_IDLE)
                 return yf_bridge_et_creator(bridge_in, log);
 
+        //shared tq, not elastic
+        bridge_in->ctx.max_child_num = bridge_in->ctx.child_num;
+
         yf_int_t i1 = 0;
         yf_int_t  ret;
         
         size_t  tid_size = yf_align_mem(sizeof(yf_tid_t) * bridge_in->ctx.child_num);
         size_t  tq_cisze = bridge_in->ctx.child_num 
                                 * bridge_in->ctx.queue_capacity;
+        size_t  blob_size = bridge_in->ctx.blob_arena_size ? yf_blob_arena_size(
+                        bridge_in->ctx.blob_arena_size, bridge_in->ctx.blob_chunk_size) : 0;
+        
+        size_t  spin_size = 0;
         
-        size_t  all_size = sizeof(yf_bridge_bt_t) + tid_size + 2 * tq_cisze;
+        if (bridge_in->ctx.child_spin_us && YF_NCPU > 1)
+                spin_size = sizeof(yf_bridge_spin_t) * bridge_in->ctx.child_num;
+        
+        size_t  all_size = sizeof(yf_bridge_bt_t) + tid_size + 2 * tq_cisze + blob_size 
+                        + spin_size;
         
         yf_bridge_bt_t* bridge_bt = yf_alloc(all_size);
         CHECK_RV(bridge_bt==NULL, YF_ERROR);
@@ -456,8 +635,9 @@ yf_int_t  yf_bridge_bt_creator(yf_bridge_in_t* bridge_in, yf_log_t* log)
         
         bridge_bt->tids = yf_mem_off(bridge_bt, sizeof(yf_bridge_bt_t));
         
-        bridge_bt->tqs = yf_init_task_queue(yf_mem_off(bridge_bt->tids, tid_size), 
-                        tq_cisze, log);
+        bridge_bt->tqs = yf_init_task_lanes(yf_mem_off(bridge_bt->tids, tid_size), 
+                        tq_cisze, bridge_in->ctx.task_lane_num, 
+                        bridge_in->ctx.task_lane_weighted, log);
         bridge_bt->rtqs = yf_init_task_queue(yf_mem_off(bridge_bt->tqs, tq_cisze), 
                         tq_cisze, log);
         
@@ -468,7 +648,23 @@ yf_int_t  yf_bridge_bt_creator(yf_bridge_in_t* bridge_in, yf_log_t* log)
                 return  YF_ERROR;
         }
 
-        ret = yf_open_channel(bridge_bt->socks, 0, 0, 1, log);
+        if (spin_size)
+                bridge_bt->spins = yf_mem_off(bridge_bt->rtqs, tq_cisze + blob_size);
+
+        if (blob_size)
+        {
+                bridge_in->blob_arena = yf_init_blob_arena(
+                                yf_mem_off(bridge_bt->rtqs, tq_cisze), 
+                                blob_size, bridge_in->ctx.blob_chunk_size, log);
+                if (bridge_in->blob_arena == NULL)
+                {
+                        yf_free(bridge_bt);
+                        return  YF_ERROR;
+                }
+        }
+
+        //childs signal res with the mutex held, never block on a full channel
+        ret = yf_open_channel(bridge_bt->socks, 0, 1, 1, log);
         assert(ret == YF_OK);
 
         ret = yf_bridge_mutex_init(&bridge_bt->mutex, bridge_in, log);
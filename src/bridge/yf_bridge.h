@@ -17,6 +17,19 @@
 
 #define YF_TASK_DISTPATCH_HASH_MOD 1
 #define YF_TASK_DISTPATCH_IDLE 2
+//dispatch like idle, and idle child thread steal tasks from busy sibling
+#define YF_TASK_DISTPATCH_STEAL 3
+//least outstanding tasks child, tie broken by pending bytes in its tq
+#define YF_TASK_DISTPATCH_LEAST_LOAD 4
+//less loaded one of two random childs, no scan of all childs
+#define YF_TASK_DISTPATCH_TWO_CHOICE 5
+//jump consistent hash, keys keep their child if child_num changed
+#define YF_TASK_DISTPATCH_JUMP_HASH 6
+
+//task priority, lane 0 is the highest, see task_lane_num
+#define YF_TASK_PRI_HIGH 0
+#define YF_TASK_PRI_NORMAL 1
+#define YF_TASK_PRI_LOW 2
 
 #define YF_TASK_SUCESS 0
 #define YF_TASK_TIMEOUT 1
@@ -24,7 +37,9 @@
 
 extern const yf_str_t yf_task_rstatus_n[];
 
-#define YF_BRIDGE_MAX_CHILD_NUM 32
+#define YF_BRIDGE_MAX_CHILD_NUM 1024
+//parent no is kept in the task id's high 8 bits
+#define YF_BRIDGE_MAX_PARENT_NUM 256
 
 typedef  yf_u64_t yf_bridge_t;
 
@@ -59,7 +74,7 @@ typedef struct yf_bridge_cxt_s
         //though), you can create a bridge, then attach main thread with it
         void* exec_func;
         
-        //max = YF_BRIDGE_MAX_CHILD_NUM
+        //max = max_child_num
         yf_uint_t child_num;
 
         //note, must > real max task size + 64byte
@@ -72,12 +87,135 @@ typedef struct yf_bridge_cxt_s
         //can be used for biz...
         void* data;
         void* data2;
+
+        //elastic, child_num can be resized in [1, max_child_num] at runtime
+        //if 0, then = child_num (fixed), max = YF_BRIDGE_MAX_CHILD_NUM
+        //note, proc childs also limited by YF_MAX_PROCESSES
+        yf_uint_t max_child_num;
+
+        //priority lanes in each child's task queue (capacity split evenly),
+        //0/1 means no priority, max 4; priority >= lanes use the last lane
+        //weighted=0, strict priority, low lanes may starve
+        //weighted=1, lane i drained 2^(lanes-1-i) tasks each round
+        yf_uint_t task_lane_num;
+        yf_uint_t task_lane_weighted;
+
+        //earliest deadline first in the first task_edf_window tasks of a
+        //lane, 0/1 means fifo; just for single consumer tq (not bt/steal)
+        yf_uint_t task_edf_window;
+
+        //large payload, task/res bigger than max_task_size is passed in a
+        //blob arena (in shm for proc childs) shared by all childs, just the
+        //handle queued; 0 means no arena, then too big task/res fail
+        //blob_chunk_size default 4096, a blob take whole chunks
+        size_t blob_arena_size;
+        size_t blob_chunk_size;
+
+        //affinity, child i bound to cpu list child_cpus[i % child_cpu_num]
+        //(like "0-3,8", kept by ptr) when it attach, NULL means not bound;
+        //then its tq pages prefer the numa node it run on (not for bt)
+        char** child_cpus;
+        yf_uint_t child_cpu_num;
+
+        //child side res batching, res pushed at once, but the parent
+        //signalled once a batch: if res_batch_num res or res_batch_bytes
+        //pending, or the first pending one waited res_batch_ms (default 1),
+        //or the child has no task now; on if res_batch_num > 1 or bytes > 0;
+        //res_batch_ms checked on a res push and between tasks only, so a
+        //handler running longer delays the batch till it returns
+        yf_uint_t res_batch_num;
+        size_t res_batch_bytes;
+        yf_uint_t res_batch_ms;
+
+        //bt (blocked thread childs, idle dispatch) child spin before sleep on
+        //the cond, window tuned by the task inter-arrival it saw (twice the
+        //avg), not spin if avg over child_spin_us; 0 means never spin
+        yf_uint_t child_spin_us;
+
+        //multi parents, other threads attach as parents of the same childs
+        //(see yf_attach_parent), 0/1 means just the creator; thread childs
+        //only, max YF_BRIDGE_MAX_PARENT_NUM
+        yf_uint_t max_parent_num;
 }
 yf_bridge_cxt_t;
 
+/*
+* auto resize, checked every check_ms in parent's evt driver, one child
+* added or removed each check
+* grow if executing tasks per child > up_tasks or latency > up_latency_ms
+* shrink if executing tasks per child < down_tasks and latency < down_latency_ms
+* threshold=0 means not used, latency is the avg ms from send to res
+*/
+typedef struct yf_bridge_elastic_s
+{
+        yf_uint_t  up_tasks;
+        yf_uint_t  up_latency_ms;
+        yf_uint_t  down_tasks;
+        yf_uint_t  down_latency_ms;
+
+        //default [1, max_child_num]
+        yf_uint_t  min_child_num;
+        yf_uint_t  max_child_num;
+
+        //default 1000
+        yf_uint_t  check_ms;
+}
+yf_bridge_elastic_t;
+
+/*
+* instrumentation, ms histograms in log2 buckets:
+* buckets[0] = 0ms, buckets[i] = [2^(i-1), 2^i) ms, the last one also
+* for the bigger
+*/
+#define YF_BRIDGE_HIST_BUCKETS 16
+
+typedef struct yf_bridge_hist_s
+{
+        yf_u64_t  cnt;
+        yf_u64_t  sum_ms;
+        yf_u64_t  max_ms;
+        yf_u64_t  buckets[YF_BRIDGE_HIST_BUCKETS];
+}
+yf_bridge_hist_t;
+
+typedef struct yf_bridge_stat_s
+{
+        //parent side
+        yf_u64_t  sent;
+        //task queue full
+        yf_u64_t  push_fail;
+        //timeout res or parent timer
+        yf_u64_t  timeout;
+        yf_u64_t  cancelled;
+        //send to res handled
+        yf_bridge_hist_t  round_trip;
+
+        //child side, updated by the child without lock
+        yf_u64_t  received;
+        //already timeout when received, not handled
+        yf_u64_t  expired;
+        yf_u64_t  res_push_fail;
+        //blocked child went to sleep (cond or futex) for no task
+        yf_u64_t  parked;
+        //enqueue to dequeue
+        yf_bridge_hist_t  wait;
+        //task handler
+        yf_bridge_hist_t  service;
+
+        //snapshot now
+        yf_uint_t  executing;
+        size_t  queue_bytes;
+}
+yf_bridge_stat_t;
+
 
 yf_uint_t  yf_bridge_task_num(yf_bridge_t* bridge);
 
+//parent call, child_no in [0, max_child_num), ret YF_ERROR if out of range
+//queue_bytes is for the child's tq (shared by all childs in bt)
+yf_int_t  yf_bridge_stat(yf_bridge_t* bridge, yf_int_t child_no
+                , yf_bridge_stat_t* stat, yf_log_t* log);
+
 
 /*
 * ------parent's api------
@@ -96,15 +234,72 @@ yf_int_t  yf_bridge_destory(yf_bridge_t* bridge, yf_log_t* log);
 yf_int_t yf_attach_res_bridge(yf_bridge_t* bridge
                 , yf_evt_driver_t* evt_driver, yf_task_res_handle handler, yf_log_t* log);
 
+/*
+* multi parents, called in another thread with its own evt driver, ret a
+* bridge that thread send tasks with (yf_send_task, yf_cancel_task...),
+* res come back to its evt driver; tasks of all parents go to the same
+* childs, pushed into the child's tq lock free
+* ret NULL if ctx.max_parent_num parents attached already
+* zero copy task and res not supported then, not resizable either
+* no parent waits another in a send (see yf_task_push_mp)
+* destory it by yf_bridge_destory in its thread before the thread exits
+* (or its evt driver destoryed), it blocks till the parent's tasks all
+* done, res handled there, timers cant fire then, so cancel the ones never
+* answered first; res of its cancelled tasks are dropped later, the slot
+* is taken by a later attach
+*/
+yf_bridge_t* yf_attach_parent(yf_bridge_t* bridge
+                , yf_evt_driver_t* evt_driver, yf_task_res_handle handler, yf_log_t* log);
+
 //will return taskid>0 if success, else ret -1
 //if timeout_ms = 0, then will wait forever...
-yf_u64_t yf_send_task(yf_bridge_t* bridge
-                , void* task, size_t len, yf_u32_t hash
+//len > max_task_size need the blob arena, the child's handler get the blob
+//directly, it is freed after the handler ret
+yf_u64_t yf_send_task_pri(yf_bridge_t* bridge
+                , void* task, size_t len, yf_u32_t hash, yf_u32_t priority
                 , void* data, yf_u32_t timeout_ms, yf_log_t* log);
 
+#define yf_send_task(bridge, task, len, hash, data, timeout_ms, log) \
+                yf_send_task_pri(bridge, task, len, hash, YF_TASK_PRI_NORMAL, \
+                                data, timeout_ms, log)
+
+/*
+* zero copy send, reserve a buf in the task queue, fill the task there,
+* then commit with the real len (<= reserved len), no other send between
+* task sent in the normal priority lane
+* reserve ret NULL if queue full; commit ret same as yf_send_task
+*/
+void* yf_send_task_reserve(yf_bridge_t* bridge
+                , size_t len, yf_u32_t hash, yf_log_t* log);
+
+yf_u64_t yf_send_task_commit(yf_bridge_t* bridge
+                , size_t len, void* data, yf_u32_t timeout_ms, yf_log_t* log);
+
+/*
+* cancel a sent task, no res handler called for it later, the child skip it
+* if still queued (best effort, else its res just dropped)
+* ret YF_ERROR if task not found (res handled or timeout already), or the id
+* not sent by this bridge (see yf_attach_parent)
+* timeout tasks are cancelled like this too
+*/
+yf_int_t yf_cancel_task(yf_bridge_t* bridge, yf_u64_t task_id, yf_log_t* log);
+
 //if in block type, call this will block, else will ret quickly with no effects
 void yf_poll_task_res(yf_bridge_t* bridge, yf_log_t* log);
 
+/*
+* elastic, only evt drived parent, bt (shared tq) not supported, nor
+* multi parents
+* shrink: removed childs get no new task, child proc killed after its
+* tasks all done, child thread just parked (cant be collected now) and
+* reused if grow later
+*/
+yf_int_t yf_bridge_resize(yf_bridge_t* bridge, yf_uint_t child_num, yf_log_t* log);
+
+//must be called after yf_attach_res_bridge
+yf_int_t yf_bridge_set_elastic(yf_bridge_t* bridge
+                , yf_bridge_elastic_t* elastic, yf_log_t* log);
+
 
 /*
 * ------child's api------
@@ -119,10 +314,16 @@ void yf_poll_task(yf_bridge_t* bridge, yf_log_t* log);
 
 yf_int_t  yf_bridge_child_no(yf_bridge_t* bridge, yf_log_t* log);
 
-//if len==0, then no res body
+//if len==0, then no res body, len > max_task_size need the blob arena
 yf_int_t yf_send_task_res(yf_bridge_t* bridge
                 , void* task_res, size_t len, yf_u64_t id
                 , yf_int_t status, yf_log_t* log);
 
+//zero copy, same as yf_send_task_reserve/commit
+void* yf_send_task_res_reserve(yf_bridge_t* bridge, size_t len, yf_log_t* log);
+
+yf_int_t yf_send_task_res_commit(yf_bridge_t* bridge
+                , size_t len, yf_u64_t id, yf_int_t status, yf_log_t* log);
+
 
 #endif
@@ -17,6 +17,8 @@ typedef  struct  yf_sig_driver_in_s yf_sig_driver_in_t;
 typedef  struct  yf_processor_event_in_s yf_processor_event_in_t;
 typedef  struct  yf_proc_evt_driver_in_s  yf_proc_evt_driver_in_t;
 
+typedef  struct  yf_watch_driver_in_s  yf_watch_driver_in_t;
+
 #include <ppc/yf_header.h>
 #include <base_struct/yf_core.h>
 #include <mio_driver/yf_event.h>
@@ -25,6 +27,7 @@ typedef  struct  yf_proc_evt_driver_in_s  yf_proc_evt_driver_in_t;
 #include "yf_fd_event_in.h"
 #include "yf_processor_event_in.h"
 #include "yf_sig_event_in.h"
+#include "yf_watch_event_in.h"
 #include "yf_poll_in.h"
 
 typedef  struct
@@ -41,6 +44,9 @@ typedef  struct
 
         yf_proc_evt_driver_in_t  proc_driver;
 
+        //init when first watch evt alloced
+        yf_watch_driver_in_t*  watch_driver;
+
         yf_int_t  tm_driver_inited:1;
         yf_int_t  fd_driver_inited:1;
         yf_int_t  sig_driver_inited:1;
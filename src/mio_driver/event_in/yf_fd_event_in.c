@@ -11,7 +11,7 @@ yf_int_t   yf_init_fd_driver(yf_fd_evt_driver_in_t* fd_evt_driver
         yf_init_list_head(&fd_evt_driver->ready_list);
 
         fd_evt_driver->evts_capcity = nfds;
-        fd_evt_driver->pevents = yf_alloc(sizeof(yf_fd_evt_in_t) * nfds);
+        fd_evt_driver->pevents = yf_page_alloc(sizeof(yf_fd_evt_in_t) * nfds, log);
         if (unlikely(fd_evt_driver->pevents == NULL)) 
         {
                 yf_log_error(YF_LOG_ERR, log, yf_errno, "alloc pevents failed");
@@ -58,7 +58,8 @@ init_failed:
                 try_poll_type--;
                 goto try_other_poll;
         }
-        yf_free((fd_evt_driver)->pevents);
+        yf_page_free((fd_evt_driver)->pevents);
+        fd_evt_driver->pevents = NULL;
         return  YF_ERROR;        
 }
 
@@ -71,7 +72,8 @@ void  yf_destory_fd_driver(yf_fd_evt_driver_in_t *fd_driver)
         if (fd_driver->evt_poll->poll_cls->actions.uninit)
                 fd_driver->evt_poll->poll_cls->actions.uninit(fd_driver->evt_poll);
         
-        yf_free((fd_driver)->pevents);
+        yf_page_free((fd_driver)->pevents);
+        fd_driver->pevents = NULL;
 }
 
 
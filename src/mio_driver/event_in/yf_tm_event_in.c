@@ -31,7 +31,7 @@ yf_int_t   yf_init_tm_driver(yf_tm_evt_driver_in_t* tm_evt_driver
 {
         yf_s32_t i;
         
-        tm_evt_driver->pevents = yf_alloc(sizeof(yf_tm_evt_link_t) * nstimers);
+        tm_evt_driver->pevents = yf_page_alloc(sizeof(yf_tm_evt_link_t) * nstimers, log);
         if (unlikely(tm_evt_driver->pevents == NULL)) 
         {
                 yf_log_error(YF_LOG_ERR, log, yf_errno, "alloc tm pevents failed");
@@ -55,7 +55,13 @@ yf_int_t   yf_init_tm_driver(yf_tm_evt_driver_in_t* tm_evt_driver
         for (i = 0; (yf_u32_t)i < YF_ARRAY_SIZE(tm_evt_driver->near_tm_lists); ++i)
                 yf_init_list_head(&tm_evt_driver->near_tm_lists[i]);
 
-        tm_evt_driver->tm_period_cnt = 0;
+        //periods are counted from process start, driver may be created late
+        tm_evt_driver->tm_period_cnt = (yf_time_diff_ms(&yf_now_times.clock_time, 
+                        &yf_start_times.clock_time) >> YF_TIMER_PRCS_MS_BIT);
+        tm_evt_driver->far_tm_period_cnt = tm_evt_driver->tm_period_cnt 
+                        >> (_YF_FAR_TIMER_PRCS_MS_BIT - YF_TIMER_PRCS_MS_BIT);
+        tm_evt_driver->too_far_tm_period_cnt = tm_evt_driver->far_tm_period_cnt 
+                        >> (YF_FAR_TIMER_ROLL_SIZE_BIT - 1);
         tm_evt_driver->poll = yf_poll_timer;
         tm_evt_driver->log = log;
 
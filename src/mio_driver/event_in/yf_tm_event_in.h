@@ -115,7 +115,7 @@ struct  yf_tm_evt_driver_in_s
 yf_int_t   yf_init_tm_driver(yf_tm_evt_driver_in_t* tm_driver
                 , yf_u32_t nstimers, yf_log_t* log);
 
-#define  yf_destory_tm_driver(tm_driver) yf_free((tm_driver)->pevents)
+#define  yf_destory_tm_driver(tm_driver) yf_page_free((tm_driver)->pevents)
 
 yf_int_t   yf_add_timer(yf_tm_evt_driver_in_t* tm_evt_driver
                 , yf_timer_t* timer, yf_log_t *log, yf_u32_t tm_ms);
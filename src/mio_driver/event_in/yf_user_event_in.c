@@ -0,0 +1,158 @@
+#include <ppc/yf_header.h>
+#include <base_struct/yf_core.h>
+#include "yf_event_base_in.h"
+
+#ifdef  HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+
+/*
+* pending avoid syscall if already triggered but handler not called yet,
+* trigger_cnt is the coalesced trigger times
+*/
+typedef struct
+{
+        yf_user_event_t  evt;
+
+        yf_fd_t  fds[2];
+        yf_fd_event_t*  rev;
+        yf_fd_event_t*  wev;
+
+        yf_atomic_t  pending;
+        yf_atomic_t  trigger_cnt;
+}
+yf_user_evt_in_t;
+
+static void yf_on_user_evt_readable(yf_fd_event_t* evt);
+
+
+yf_int_t  yf_alloc_user_evt(yf_evt_driver_t* driver, yf_user_event_t** user_evt
+                , yf_log_t* log)
+{
+        yf_user_evt_in_t* evt_in = yf_alloc(sizeof(yf_user_evt_in_t));
+        CHECK_RV(evt_in == NULL, YF_ERROR);
+
+        evt_in->fds[0] = evt_in->fds[1] = YF_INVALID_FD;
+
+#ifdef  HAVE_SYS_EVENTFD_H
+        evt_in->fds[0] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (evt_in->fds[0] < 0)
+        {
+                yf_log_error(YF_LOG_ERR, log, yf_errno, "eventfd failed");
+                goto failed;
+        }
+        evt_in->fds[1] = evt_in->fds[0];
+#else
+        if (pipe(evt_in->fds) != 0)
+        {
+                yf_log_error(YF_LOG_ERR, log, yf_errno, "user evt pipe failed");
+                goto failed;
+        }
+        yf_nonblocking(evt_in->fds[0]);
+        yf_nonblocking(evt_in->fds[1]);
+#endif
+
+        if (yf_alloc_fd_evt(driver, evt_in->fds[0], &evt_in->rev, &evt_in->wev
+                        , log) != YF_OK)
+                goto failed;
+
+        evt_in->rev->data = evt_in;
+        evt_in->rev->fd_evt_handler = yf_on_user_evt_readable;
+
+        if (yf_register_fd_evt(evt_in->rev, NULL) != YF_OK)
+        {
+                yf_free_fd_evt(evt_in->rev, evt_in->wev);
+                goto failed;
+        }
+
+        evt_in->evt.driver = driver;
+        evt_in->evt.log = log;
+
+        yf_log_debug1(YF_LOG_DEBUG, log, 0, "alloc user evt, fd=%d", evt_in->fds[0]);
+
+        *user_evt = &evt_in->evt;
+        return YF_OK;
+
+failed:
+        if (evt_in->fds[0] != YF_INVALID_FD)
+                yf_close(evt_in->fds[0]);
+        if (evt_in->fds[1] != YF_INVALID_FD && evt_in->fds[1] != evt_in->fds[0])
+                yf_close(evt_in->fds[1]);
+        yf_free(evt_in);
+        return YF_ERROR;
+}
+
+
+yf_int_t  yf_free_user_evt(yf_user_event_t* user_evt)
+{
+        yf_user_evt_in_t* evt_in = container_of(user_evt, yf_user_evt_in_t, evt);
+
+        yf_unregister_fd_evt(evt_in->rev);
+        yf_free_fd_evt(evt_in->rev, evt_in->wev);
+
+        yf_close(evt_in->fds[0]);
+        if (evt_in->fds[1] != evt_in->fds[0])
+                yf_close(evt_in->fds[1]);
+
+        yf_free(evt_in);
+        return YF_OK;
+}
+
+
+yf_int_t  yf_trigger_user_evt(yf_user_event_t* user_evt)
+{
+        ssize_t  n;
+        yf_user_evt_in_t* evt_in = container_of(user_evt, yf_user_evt_in_t, evt);
+
+        yf_atomic_fetch_add(&evt_in->trigger_cnt, 1);
+
+        //already notified, coalesce
+        if (evt_in->pending || !yf_atomic_cmp_swp(&evt_in->pending, 0, 1))
+                return YF_OK;
+
+#ifdef  HAVE_SYS_EVENTFD_H
+        yf_u64_t  one = 1;
+        n = yf_write(evt_in->fds[1], &one, sizeof(one));
+#else
+        n = yf_write(evt_in->fds[1], "", 1);
+#endif
+
+        if (unlikely(n < 0 && !YF_EAGAIN(yf_errno)))
+        {
+                yf_log_error(YF_LOG_ERR, user_evt->log, yf_errno,
+                                "trigger user evt fd=%d failed", evt_in->fds[1]);
+                return YF_ERROR;
+        }
+        return YF_OK;
+}
+
+
+static void yf_on_user_evt_readable(yf_fd_event_t* evt)
+{
+        char  buf[64];
+        yf_atomic_t  cnt;
+        yf_user_evt_in_t* evt_in = (yf_user_evt_in_t*)evt->data;
+
+        while (yf_read(evt->fd, buf, sizeof(buf)) > 0)
+                ;
+        evt->ready = 0;
+
+        //clear pending before take cnt, so later trigger will notify again
+        evt_in->pending = 0;
+        yf_memory_barrier();
+
+        do {
+                cnt = evt_in->trigger_cnt;
+        } while (cnt && !yf_atomic_cmp_swp(&evt_in->trigger_cnt, cnt, 0));
+
+        yf_register_fd_evt(evt, NULL);
+
+        //maybe already token by last call
+        if (cnt == 0)
+                return;
+
+        yf_log_debug2(YF_LOG_DEBUG, evt_in->evt.log, 0, "user evt fd=%d, trigger cnt=%d",
+                        evt->fd, cnt);
+
+        evt_in->evt.user_evt_handler(&evt_in->evt, cnt);
+}
@@ -0,0 +1,305 @@
+#include <ppc/yf_header.h>
+#include <base_struct/yf_core.h>
+#include "yf_event_base_in.h"
+
+#ifdef  HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+
+/*
+* modify is reported when file closed after write, so handler (config reload)
+* always see the whole content
+*/
+static yf_u32_t  yf_watch_to_inotify(yf_u32_t mask)
+{
+        yf_u32_t  in_mask = 0;
+
+        if (mask & YF_WATCH_MODIFY)
+                in_mask |= IN_CLOSE_WRITE;
+        if (mask & YF_WATCH_CREATE)
+                in_mask |= IN_CREATE;
+        if (mask & YF_WATCH_DELETE)
+                in_mask |= IN_DELETE | IN_DELETE_SELF;
+        if (mask & YF_WATCH_MOVE)
+                in_mask |= IN_MOVED_FROM | IN_MOVED_TO | IN_MOVE_SELF;
+        if (mask & YF_WATCH_ATTRIB)
+                in_mask |= IN_ATTRIB;
+        return in_mask;
+}
+
+static yf_u32_t  yf_inotify_to_watch(yf_u32_t in_mask)
+{
+        yf_u32_t  mask = 0;
+
+        if (in_mask & IN_CLOSE_WRITE)
+                mask |= YF_WATCH_MODIFY;
+        if (in_mask & IN_CREATE)
+                mask |= YF_WATCH_CREATE;
+        if (in_mask & (IN_DELETE | IN_DELETE_SELF))
+                mask |= YF_WATCH_DELETE;
+        if (in_mask & (IN_MOVED_FROM | IN_MOVED_TO | IN_MOVE_SELF))
+                mask |= YF_WATCH_MOVE;
+        if (in_mask & IN_ATTRIB)
+                mask |= YF_WATCH_ATTRIB;
+        if (in_mask & IN_IGNORED)
+                mask |= YF_WATCH_GONE;
+        return mask;
+}
+
+
+static void yf_on_inotify_readable(yf_fd_event_t* evt);
+
+static yf_watch_driver_in_t* yf_init_watch_driver(yf_evt_driver_t* driver
+                , yf_log_t* log)
+{
+        yf_evt_driver_in_t* evt_driver = (yf_evt_driver_in_t*)driver;
+        yf_watch_driver_in_t* watch_driver = evt_driver->watch_driver;
+
+        if (watch_driver)
+                return watch_driver;
+
+        watch_driver = yf_alloc(sizeof(yf_watch_driver_in_t));
+        CHECK_RV(watch_driver == NULL, NULL);
+
+        yf_init_list_head(&watch_driver->watch_list);
+        watch_driver->log = log;
+
+        watch_driver->fd = inotify_init();
+        if (watch_driver->fd < 0)
+        {
+                yf_log_error(YF_LOG_ERR, log, yf_errno, "inotify_init failed");
+                yf_free(watch_driver);
+                return NULL;
+        }
+        yf_nonblocking(watch_driver->fd);
+
+        if (yf_alloc_fd_evt(driver, watch_driver->fd, &watch_driver->rev
+                        , &watch_driver->wev, log) != YF_OK)
+        {
+                yf_close(watch_driver->fd);
+                yf_free(watch_driver);
+                return NULL;
+        }
+
+        watch_driver->rev->data = watch_driver;
+        watch_driver->rev->fd_evt_handler = yf_on_inotify_readable;
+        yf_register_fd_evt(watch_driver->rev, NULL);
+
+        yf_log_debug1(YF_LOG_DEBUG, log, 0, "init watch driver, inotify fd=%d",
+                        watch_driver->fd);
+
+        evt_driver->watch_driver = watch_driver;
+        return watch_driver;
+}
+
+
+void   yf_destory_watch_driver(yf_watch_driver_in_t* watch_driver)
+{
+        yf_watch_event_in_t* watch_in, *next;
+
+        yf_list_for_each_entry_safe(watch_in, next, &watch_driver->watch_list, linker)
+        {
+                yf_list_del(&watch_in->linker);
+                watch_in->wd = -1;
+        }
+
+        yf_unregister_fd_evt(watch_driver->rev);
+        yf_free_fd_evt(watch_driver->rev, watch_driver->wev);
+        yf_close(watch_driver->fd);
+
+        yf_free(watch_driver);
+}
+
+
+yf_int_t  yf_alloc_watch_evt(yf_evt_driver_t* driver, yf_watch_event_t** watch_evt
+                , yf_log_t* log)
+{
+        yf_watch_driver_in_t* watch_driver = yf_init_watch_driver(driver, log);
+        CHECK_RV(watch_driver == NULL, YF_ERROR);
+
+        yf_watch_event_in_t* watch_in = yf_alloc(sizeof(yf_watch_event_in_t));
+        CHECK_RV(watch_in == NULL, YF_ERROR);
+
+        watch_in->wd = -1;
+        watch_in->evt.driver = driver;
+        watch_in->evt.log = log;
+        watch_in->evt.mask = YF_WATCH_ALL;
+
+        *watch_evt = &watch_in->evt;
+        return YF_OK;
+}
+
+
+yf_int_t  yf_free_watch_evt(yf_watch_event_t* watch_evt)
+{
+        yf_watch_event_in_t* watch_in = container_of(watch_evt, yf_watch_event_in_t, evt);
+
+        yf_unregister_watch_evt(watch_evt);
+        yf_free(watch_in);
+        return YF_OK;
+}
+
+
+yf_int_t  yf_register_watch_evt(yf_watch_event_t* watch_evt)
+{
+        int  wd;
+        yf_watch_event_in_t* watch_in = container_of(watch_evt, yf_watch_event_in_t, evt);
+        yf_watch_driver_in_t* watch_driver
+                        = ((yf_evt_driver_in_t*)watch_evt->driver)->watch_driver;
+
+        if (watch_in->wd >= 0)
+                yf_unregister_watch_evt(watch_evt);
+
+        //other evt may watch the same path, so merge mask
+        wd = inotify_add_watch(watch_driver->fd, watch_evt->path
+                        , yf_watch_to_inotify(watch_evt->mask) | IN_MASK_ADD);
+        if (wd < 0)
+        {
+                yf_log_error(YF_LOG_ERR, watch_evt->log, yf_errno,
+                                "inotify_add_watch path=%s failed", watch_evt->path);
+                return YF_ERROR;
+        }
+
+        watch_in->wd = wd;
+        //registered in a handler, dont get the evt in dispatch now
+        watch_in->dispatch_seq = watch_driver->dispatch_seq;
+        yf_list_add_tail(&watch_in->linker, &watch_driver->watch_list);
+        ++watch_driver->watch_num;
+
+        yf_log_debug2(YF_LOG_DEBUG, watch_evt->log, 0, "register watch evt, path=%s, wd=%d",
+                        watch_evt->path, wd);
+        return YF_OK;
+}
+
+
+yf_int_t  yf_unregister_watch_evt(yf_watch_event_t* watch_evt)
+{
+        yf_watch_event_in_t* watch_in = container_of(watch_evt, yf_watch_event_in_t, evt);
+        yf_watch_event_in_t* other;
+        yf_watch_driver_in_t* watch_driver
+                        = ((yf_evt_driver_in_t*)watch_evt->driver)->watch_driver;
+
+        if (watch_in->wd < 0)
+                return YF_OK;
+
+        yf_list_del(&watch_in->linker);
+        --watch_driver->watch_num;
+
+        yf_list_for_each_entry(other, &watch_driver->watch_list, linker)
+        {
+                if (other->wd == watch_in->wd)
+                        goto end;
+        }
+
+        inotify_rm_watch(watch_driver->fd, watch_in->wd);
+end:
+        watch_in->wd = -1;
+        return YF_OK;
+}
+
+
+static void yf_watch_dispatch(yf_watch_driver_in_t* watch_driver
+                , struct inotify_event* in_evt)
+{
+        yf_u32_t  what = yf_inotify_to_watch(in_evt->mask);
+        const char* name = in_evt->len ? in_evt->name : NULL;
+        yf_watch_event_in_t* watch_in;
+        yf_u32_t  seq;
+
+        //evts lost, every watch told, so handlers rescan what they watch
+        if (unlikely(in_evt->wd < 0))
+        {
+                yf_log_error(YF_LOG_WARN, watch_driver->log, 0,
+                                "inotify queue overflow, mask=%d, watchs=%d",
+                                in_evt->mask, watch_driver->watch_num);
+                what = YF_WATCH_OVERFLOW;
+                name = NULL;
+        }
+
+        seq = ++watch_driver->dispatch_seq;
+
+        /*
+        * handler may unregister/free any watch or register again, so scan
+        * from head after each call, the seen ones are skipped by seq
+        */
+rescan:
+        yf_list_for_each_entry(watch_in, &watch_driver->watch_list, linker)
+        {
+                if (watch_in->dispatch_seq == seq)
+                        continue;
+                watch_in->dispatch_seq = seq;
+
+                if (what != YF_WATCH_OVERFLOW && watch_in->wd != in_evt->wd)
+                        continue;
+
+                //removed by kernel (deleted or umounted)
+                if (what & YF_WATCH_GONE)
+                {
+                        yf_list_del(&watch_in->linker);
+                        --watch_driver->watch_num;
+                        watch_in->wd = -1;
+                }
+                else if (!(what & (watch_in->evt.mask | YF_WATCH_OVERFLOW)))
+                        continue;
+
+                yf_log_debug3(YF_LOG_DEBUG, watch_in->evt.log, 0,
+                                "watch evt path=%s, what=%d, name=%s",
+                                watch_in->evt.path, what, name ? name : "");
+
+                watch_in->evt.watch_evt_handler(&watch_in->evt, what, name);
+                goto rescan;
+        }
+}
+
+
+static void yf_on_inotify_readable(yf_fd_event_t* evt)
+{
+        ssize_t  n;
+        char*  pos;
+        struct inotify_event*  in_evt;
+        char  buf[16 * (sizeof(struct inotify_event) + NAME_MAX + 1)]
+                        __attribute__ ((aligned(__alignof__(struct inotify_event))));
+        yf_watch_driver_in_t* watch_driver = (yf_watch_driver_in_t*)evt->data;
+
+        while ((n = yf_read(evt->fd, buf, sizeof(buf))) > 0)
+        {
+                for (pos = buf; pos < buf + n;
+                                pos += sizeof(struct inotify_event) + in_evt->len)
+                {
+                        in_evt = (struct inotify_event*)pos;
+                        yf_watch_dispatch(watch_driver, in_evt);
+                }
+        }
+
+        evt->ready = 0;
+        yf_register_fd_evt(evt, NULL);
+}
+
+#else
+
+void   yf_destory_watch_driver(yf_watch_driver_in_t* watch_driver)
+{
+}
+
+yf_int_t  yf_alloc_watch_evt(yf_evt_driver_t* driver, yf_watch_event_t** watch_evt
+                , yf_log_t* log)
+{
+        yf_log_error(YF_LOG_ERR, log, 0, "watch evt not supported, no inotify");
+        return YF_ERROR;
+}
+
+yf_int_t  yf_free_watch_evt(yf_watch_event_t* watch_evt)
+{
+        return YF_ERROR;
+}
+
+yf_int_t  yf_register_watch_evt(yf_watch_event_t* watch_evt)
+{
+        return YF_ERROR;
+}
+
+yf_int_t  yf_unregister_watch_evt(yf_watch_event_t* watch_evt)
+{
+        return YF_ERROR;
+}
+
+#endif
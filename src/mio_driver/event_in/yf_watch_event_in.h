@@ -0,0 +1,30 @@
+#ifndef _YF_WATCH_EVENT_IN_H_20261019_H
+#define _YF_WATCH_EVENT_IN_H_20261019_H
+
+typedef struct yf_watch_event_in_s
+{
+        yf_list_part_t  linker;
+        int  wd;//-1 if not registered
+        //== driver dispatch_seq if seen the inotify evt in dispatch
+        yf_u32_t  dispatch_seq;
+        yf_watch_event_t  evt;
+}
+yf_watch_event_in_t;
+
+//one inotify fd per driver
+struct yf_watch_driver_in_s
+{
+        yf_fd_t  fd;
+        yf_fd_event_t*  rev;
+        yf_fd_event_t*  wev;
+
+        yf_list_part_t  watch_list;
+        yf_u32_t  watch_num;
+        yf_u32_t  dispatch_seq;
+
+        yf_log_t *log;
+};
+
+void   yf_destory_watch_driver(yf_watch_driver_in_t* watch_driver);
+
+#endif
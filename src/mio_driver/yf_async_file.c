@@ -0,0 +1,262 @@
+#include <ppc/yf_header.h>
+#include <base_struct/yf_core.h>
+#include <mio_driver/yf_event.h>
+#include "yf_async_file.h"
+
+#define YF_AFILE_DEFAULT_THREADS 2
+#define YF_AFILE_MAX_THREADS 16
+
+typedef struct
+{
+        yf_evt_driver_t*  driver;
+        yf_log_t*  log;
+
+        //posted reqs, io threads wait on cond
+        yf_mutex_t*  req_mutex;
+        yf_cond_t*  req_cond;
+        yf_list_part_t  req_list;
+        yf_u32_t  exit:1;
+
+        //files in io now, their other reqs wait in req_list
+        yf_file_t*  busy_files[YF_AFILE_MAX_THREADS];
+
+        //done reqs, io threads notify driver by user evt
+        yf_lock_t  done_lock;
+        yf_list_part_t  done_list;
+
+        yf_user_event_t*  notify_evt;
+
+        yf_u32_t  thread_num;
+        yf_tid_t  tids[YF_AFILE_MAX_THREADS];
+}
+yf_afile_pool_in_t;
+
+static yf_thread_value_t yf_afile_thread_exe(void* arg);
+static void yf_afile_on_notify(yf_user_event_t* evt, yf_u64_t cnt);
+
+
+yf_afile_pool_t* yf_afile_pool_create(yf_evt_driver_t* driver
+                , yf_u32_t thread_num, yf_log_t* log)
+{
+        yf_u32_t  i1;
+        yf_afile_pool_in_t* pool = yf_alloc(sizeof(yf_afile_pool_in_t));
+        CHECK_RV(pool == NULL, NULL);
+
+        if (thread_num == 0)
+                thread_num = YF_AFILE_DEFAULT_THREADS;
+        thread_num = yf_min(thread_num, YF_AFILE_MAX_THREADS);
+
+        pool->driver = driver;
+        pool->log = log;
+
+        yf_init_list_head(&pool->req_list);
+        yf_init_list_head(&pool->done_list);
+        yf_lock_init(&pool->done_lock);
+
+        pool->req_mutex = yf_mutex_init(log);
+        pool->req_cond = yf_cond_init(log);
+        if (pool->req_mutex == NULL || pool->req_cond == NULL)
+                goto failed;
+
+        if (yf_alloc_user_evt(driver, &pool->notify_evt, log) != YF_OK)
+                goto failed;
+
+        pool->notify_evt->data = pool;
+        pool->notify_evt->user_evt_handler = yf_afile_on_notify;
+
+        for (i1 = 0; i1 < thread_num; ++i1)
+        {
+                if (yf_create_thread(pool->tids + i1, yf_afile_thread_exe, pool, log) != 0)
+                        break;
+        }
+        pool->thread_num = i1;
+
+        if (pool->thread_num == 0)
+                goto failed;
+
+        yf_log_debug1(YF_LOG_DEBUG, log, 0, "afile pool created, threads=%d",
+                        pool->thread_num);
+        return (yf_afile_pool_t*)pool;
+
+failed:
+        yf_afile_pool_destory((yf_afile_pool_t*)pool);
+        return NULL;
+}
+
+
+void yf_afile_pool_destory(yf_afile_pool_t* pool)
+{
+        yf_u32_t  i1;
+        void* ptr = NULL;
+        yf_afile_pool_in_t* pool_in = (yf_afile_pool_in_t*)pool;
+
+        if (pool_in->thread_num)
+        {
+                yf_mutex_lock(pool_in->req_mutex, pool_in->log);
+                pool_in->exit = 1;
+                for (i1 = 0; i1 < pool_in->thread_num; ++i1)
+                        yf_cond_signal(pool_in->req_cond, pool_in->log);
+                yf_mutex_unlock(pool_in->req_mutex, pool_in->log);
+
+                for (i1 = 0; i1 < pool_in->thread_num; ++i1)
+                        yf_thread_join(pool_in->tids[i1], &ptr);
+        }
+
+        if (pool_in->notify_evt)
+                yf_free_user_evt(pool_in->notify_evt);
+
+        if (pool_in->req_cond)
+                yf_cond_destroy(pool_in->req_cond, pool_in->log);
+        if (pool_in->req_mutex)
+                yf_mutex_destroy(pool_in->req_mutex, pool_in->log);
+
+        yf_free(pool_in);
+}
+
+
+yf_int_t  yf_afile_post(yf_afile_pool_t* pool, yf_afile_req_t* req)
+{
+        yf_afile_pool_in_t* pool_in = (yf_afile_pool_in_t*)pool;
+
+        if (unlikely(req->op < YF_AFILE_READ || req->op > YF_AFILE_WRITE_CHAIN))
+        {
+                yf_log_error(YF_LOG_ERR, pool_in->log, 0, "unknown afile op=%d", req->op);
+                return YF_ERROR;
+        }
+
+        req->ret = 0;
+        req->err = 0;
+
+        yf_mutex_lock(pool_in->req_mutex, pool_in->log);
+        yf_list_add_tail(&req->linker, &pool_in->req_list);
+        yf_cond_signal(pool_in->req_cond, pool_in->log);
+        yf_mutex_unlock(pool_in->req_mutex, pool_in->log);
+
+        return YF_OK;
+}
+
+
+static void yf_afile_exe_req(yf_afile_req_t* req)
+{
+        switch (req->op)
+        {
+                case YF_AFILE_READ:
+                        req->ret = yf_read_file(req->file, req->buf, req->size, req->offset);
+                        break;
+                case YF_AFILE_WRITE:
+                        req->ret = yf_write_file(req->file, req->buf, req->size, req->offset);
+                        break;
+                case YF_AFILE_WRITE_CHAIN:
+                        req->ret = yf_write_chain_to_file(req->file, req->chain
+                                        , req->offset, req->pool);
+                        break;
+        }
+
+        if (req->ret == YF_ERROR)
+                req->err = yf_errno;
+}
+
+
+/*
+* first req whose file not in io, the file is marked busy, called locked
+*/
+static yf_afile_req_t* yf_afile_pick_req(yf_afile_pool_in_t* pool, yf_u32_t* slot)
+{
+        yf_u32_t  i1, free_slot;
+        yf_list_part_t* part;
+        yf_afile_req_t* req;
+
+        yf_list_for_each(part, &pool->req_list)
+        {
+                req = yf_list_entry(part, yf_afile_req_t, linker);
+                free_slot = YF_AFILE_MAX_THREADS;
+
+                for (i1 = 0; i1 < YF_AFILE_MAX_THREADS; ++i1)
+                {
+                        if (pool->busy_files[i1] == req->file)
+                                break;
+                        if (pool->busy_files[i1] == NULL)
+                                free_slot = i1;
+                }
+                if (i1 < YF_AFILE_MAX_THREADS)
+                        continue;
+
+                assert(free_slot < YF_AFILE_MAX_THREADS);
+                pool->busy_files[free_slot] = req->file;
+                *slot = free_slot;
+
+                yf_list_del(&req->linker);
+                return req;
+        }
+        return NULL;
+}
+
+
+static yf_thread_value_t yf_afile_thread_exe(void* arg)
+{
+        yf_u32_t  slot = 0;
+        yf_afile_req_t* req;
+        yf_afile_pool_in_t* pool = (yf_afile_pool_in_t*)arg;
+
+        for ( ;; )
+        {
+                yf_mutex_lock(pool->req_mutex, pool->log);
+
+                while ((req = yf_afile_pick_req(pool, &slot)) == NULL)
+                {
+                        if (pool->exit && yf_list_empty(&pool->req_list))
+                                break;
+                        yf_cond_wait(pool->req_cond, pool->req_mutex, pool->log);
+                }
+
+                if (req == NULL)
+                {
+                        yf_mutex_unlock(pool->req_mutex, pool->log);
+                        break;
+                }
+                yf_mutex_unlock(pool->req_mutex, pool->log);
+
+                yf_afile_exe_req(req);
+
+                //done before the file freed, the next req of it done after
+                yf_lock(&pool->done_lock);
+                yf_list_add_tail(&req->linker, &pool->done_list);
+                yf_unlock(&pool->done_lock);
+
+                //the reqs of the same file may be waiting
+                yf_mutex_lock(pool->req_mutex, pool->log);
+                pool->busy_files[slot] = NULL;
+                if (!yf_list_empty(&pool->req_list))
+                        yf_cond_signal(pool->req_cond, pool->log);
+                yf_mutex_unlock(pool->req_mutex, pool->log);
+
+                yf_trigger_user_evt(pool->notify_evt);
+        }
+
+        return NULL;
+}
+
+
+static void yf_afile_on_notify(yf_user_event_t* evt, yf_u64_t cnt)
+{
+        yf_list_part_t  done_list;
+        yf_list_part_t* part;
+        yf_afile_req_t* req;
+        yf_afile_pool_in_t* pool = (yf_afile_pool_in_t*)evt->data;
+
+        yf_init_list_head(&done_list);
+
+        yf_lock(&pool->done_lock);
+        yf_list_splice(&pool->done_list, &done_list);
+        yf_unlock(&pool->done_lock);
+
+        while (!yf_list_empty(&done_list))
+        {
+                part = yf_list_pop_head(&done_list);
+                req = yf_list_entry(part, yf_afile_req_t, linker);
+
+                yf_log_debug2(YF_LOG_DEBUG, pool->log, 0, "afile req op=%d done, ret=%d",
+                                req->op, req->ret);
+                req->done_handler(req);
+        }
+}
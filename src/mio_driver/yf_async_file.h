@@ -0,0 +1,84 @@
+#ifndef _YF_ASYNC_FILE_H_20261019_H
+#define _YF_ASYNC_FILE_H_20261019_H
+
+#include <base_struct/yf_core.h>
+#include <ppc/yf_header.h>
+#include <mio_driver/yf_event.h>
+
+/*
+* file io offload, yf_read_file/yf_write_file/yf_write_chain_to_file run in
+* a small io thread pool, done_handler called back in the driver's thread
+* which create the pool (notified by user evt), so disk block never stall
+* the driver loop
+* reqs on the same yf_file_t run one by one in post order (never at the same
+* time in two io threads) and their done_handlers called in that order too,
+* reqs on different files run in parallel; the io
+* thread changes file->offset/sys_offset, so dont use the file in other
+* threads while reqs on it are pending
+*/
+typedef  yf_u64_t  yf_afile_pool_t;
+
+#define YF_AFILE_READ  1
+#define YF_AFILE_WRITE  2
+#define YF_AFILE_WRITE_CHAIN  3
+
+typedef struct yf_afile_req_s
+{
+        yf_file_t*  file;
+        yf_u32_t  op;
+
+        //read/write
+        char*  buf;
+        size_t  size;
+
+        //write chain, pool just used by io thread while req posted
+        yf_chain_t*  chain;
+        yf_pool_t*  pool;
+
+        off_t  offset;
+
+        //result, ret same as the sync func, err is errno if ret=YF_ERROR
+        ssize_t  ret;
+        yf_err_t  err;
+
+        void*        data;
+        YF_EVT_DATA;
+        yf_log_t*   log;
+
+        void (*done_handler)(struct yf_afile_req_s* req);
+
+        //inner use
+        yf_list_part_t  linker;
+}
+yf_afile_req_t;
+
+//thread_num=0, use 2 io threads
+yf_afile_pool_t* yf_afile_pool_create(yf_evt_driver_t* driver
+                , yf_u32_t thread_num, yf_log_t* log);
+
+/*
+* wait all io threads exit, done reqs not delivered will be dropped
+*/
+void yf_afile_pool_destory(yf_afile_pool_t* pool);
+
+/*
+* req and its buf/file must be valid untill done_handler called
+*/
+yf_int_t  yf_afile_post(yf_afile_pool_t* pool, yf_afile_req_t* req);
+
+#define yf_afile_read(pool, req, _file, _buf, _size, _offset) ( \
+                (req)->op = YF_AFILE_READ, (req)->file = _file, \
+                (req)->buf = _buf, (req)->size = _size, (req)->offset = _offset, \
+                yf_afile_post(pool, req))
+
+#define yf_afile_write(pool, req, _file, _buf, _size, _offset) ( \
+                (req)->op = YF_AFILE_WRITE, (req)->file = _file, \
+                (req)->buf = _buf, (req)->size = _size, (req)->offset = _offset, \
+                yf_afile_post(pool, req))
+
+#define yf_afile_write_chain(pool, req, _file, _chain, _offset, _pool) ( \
+                (req)->op = YF_AFILE_WRITE_CHAIN, (req)->file = _file, \
+                (req)->chain = _chain, (req)->offset = _offset, (req)->pool = _pool, \
+                yf_afile_post(pool, req))
+
+#endif
@@ -0,0 +1,567 @@
+#include <ppc/yf_header.h>
+#include <base_struct/yf_core.h>
+#include <mio_driver/yf_event.h>
+#include "yf_coroutine.h"
+
+/*
+* context switch, just save callee-saved regs, the caller saved by compiler
+* other arch use ucontext, slower (sigprocmask syscall on each switch)
+*/
+#if defined (__x86_64__) || defined (__i386__)
+
+typedef struct
+{
+        void* sp;
+}
+yf_co_ctx_t;
+
+void yf_co_ctx_swap(void** from_sp, void* to_sp);
+
+#if defined (__x86_64__)
+__asm__ (
+        ".text\n"
+        ".globl yf_co_ctx_swap\n"
+        ".hidden yf_co_ctx_swap\n"
+        ".type yf_co_ctx_swap, @function\n"
+        "yf_co_ctx_swap:\n"
+        "        pushq %rbp\n"
+        "        pushq %rbx\n"
+        "        pushq %r12\n"
+        "        pushq %r13\n"
+        "        pushq %r14\n"
+        "        pushq %r15\n"
+        "        movq %rsp, (%rdi)\n"
+        "        movq %rsi, %rsp\n"
+        "        popq %r15\n"
+        "        popq %r14\n"
+        "        popq %r13\n"
+        "        popq %r12\n"
+        "        popq %rbx\n"
+        "        popq %rbp\n"
+        "        ret\n"
+        ".size yf_co_ctx_swap, .-yf_co_ctx_swap\n"
+);
+#define YF_CO_SAVED_REGS 6
+#else
+__asm__ (
+        ".text\n"
+        ".globl yf_co_ctx_swap\n"
+        ".hidden yf_co_ctx_swap\n"
+        ".type yf_co_ctx_swap, @function\n"
+        "yf_co_ctx_swap:\n"
+        "        movl 4(%esp), %eax\n"
+        "        movl 8(%esp), %edx\n"
+        "        pushl %ebp\n"
+        "        pushl %ebx\n"
+        "        pushl %esi\n"
+        "        pushl %edi\n"
+        "        movl %esp, (%eax)\n"
+        "        movl %edx, %esp\n"
+        "        popl %edi\n"
+        "        popl %esi\n"
+        "        popl %ebx\n"
+        "        popl %ebp\n"
+        "        ret\n"
+        ".size yf_co_ctx_swap, .-yf_co_ctx_swap\n"
+);
+#define YF_CO_SAVED_REGS 4
+#endif
+
+#define yf_co_switch(from, to) yf_co_ctx_swap(&(from)->sp, (to)->sp)
+
+/*
+* top(16 aligned) | 0(fake ret addr of entry) | entry | saved regs...
+* so when entry called, the sp is just like after a call instruction
+*/
+#define yf_co_ctx_make(ctx, stack_lo, stack_hi, entry) do { \
+        void** _sp = (void**)(stack_hi); \
+        *--_sp = NULL; \
+        *--_sp = (void*)(entry); \
+        _sp -= YF_CO_SAVED_REGS; \
+        yf_memzero(_sp, sizeof(void*) * YF_CO_SAVED_REGS); \
+        (ctx)->sp = _sp; \
+} while (0)
+
+#else
+
+#include <ucontext.h>
+
+typedef struct
+{
+        ucontext_t  uc;
+}
+yf_co_ctx_t;
+
+#define yf_co_switch(from, to) swapcontext(&(from)->uc, &(to)->uc)
+
+#define yf_co_ctx_make(ctx, stack_lo, stack_hi, entry) do { \
+        getcontext(&(ctx)->uc); \
+        (ctx)->uc.uc_stack.ss_sp = (stack_lo); \
+        (ctx)->uc.uc_stack.ss_size = (char*)(stack_hi) - (char*)(stack_lo); \
+        (ctx)->uc.uc_link = NULL; \
+        makecontext(&(ctx)->uc, entry, 0); \
+} while (0)
+
+#endif
+
+
+#define YF_CO_READY  0
+#define YF_CO_RUNNING  1
+#define YF_CO_WAIT  2
+#define YF_CO_DEAD  3
+
+struct yf_co_sched_in_s;
+
+/*
+* co struct lay on the top of its own stack, so one mmap per coroutine,
+* and the lowest page is guard page
+*/
+typedef struct yf_co_in_s
+{
+        yf_list_part_t  linker;
+
+        yf_co_ctx_t  ctx;
+        yf_u64_t  id;
+
+        yf_co_func_pt  func;
+        void*  arg;
+
+        yf_u32_t  status:2;
+
+        yf_tm_evt_t*  tm_evt;
+        char*  map_addr;
+
+        //the fd evt waiting on, with its org handler/data
+        yf_fd_event_t*  wait_evt;
+        void*  wait_org_data;
+        void (*wait_org_handler)(yf_fd_event_t* evt);
+
+        struct yf_co_sched_in_s* sched;
+}
+yf_co_in_t;
+
+typedef struct yf_co_sched_in_s
+{
+        yf_evt_driver_t*  driver;
+        yf_log_t*  log;
+
+        yf_co_ctx_t  main_ctx;
+
+        yf_u32_t  stack_size;
+        yf_u32_t  map_size;
+        yf_u32_t  max_num;
+        yf_u32_t  co_num;
+
+        yf_list_part_t  co_list;
+
+        //cached stacks
+        yf_list_part_t  free_list;
+        yf_u32_t  free_num;
+
+        yf_id_seed_group_t  id_seed;
+}
+yf_co_sched_in_t;
+
+//just cache such num stacks, others munmap when coroutine end
+#define YF_CO_MAX_FREE_STACK  64
+
+//only touched by the thread own the sched
+static ___YF_THREAD yf_co_in_t* yf_co_current = NULL;
+
+static void yf_co_entry(void);
+static void yf_co_resume(yf_co_in_t* co);
+static void yf_co_tm_handler(yf_tm_evt_t* evt, yf_time_t* start);
+
+
+yf_co_sched_t* yf_co_sched_create(yf_evt_driver_t* driver
+                , yf_u32_t stack_size, yf_u32_t max_num, yf_log_t* log)
+{
+        yf_co_sched_in_t* sched = yf_alloc(sizeof(yf_co_sched_in_t));
+        CHECK_RV(sched == NULL, NULL);
+
+        if (stack_size == 0)
+                stack_size = YF_CO_DEFAULT_STACK_SIZE;
+
+        sched->driver = driver;
+        sched->log = log;
+        sched->stack_size = yf_align(stack_size, yf_pagesize);
+        sched->map_size = sched->stack_size + yf_pagesize;
+        sched->max_num = max_num;
+
+        yf_init_list_head(&sched->co_list);
+        yf_init_list_head(&sched->free_list);
+
+        if (yf_id_seed_group_init(&sched->id_seed, 0) != YF_OK)
+        {
+                yf_free(sched);
+                return NULL;
+        }
+
+        yf_log_debug2(YF_LOG_DEBUG, log, 0, "co sched created, stack_size=%d, max_num=%d",
+                        sched->stack_size, max_num);
+        return (yf_co_sched_t*)sched;
+}
+
+
+static void yf_co_unmap(yf_co_sched_in_t* sched, yf_co_in_t* co)
+{
+        char* map_addr = co->map_addr;
+
+        yf_free_tm_evt(co->tm_evt);
+
+        if (munmap(map_addr, sched->map_size) != 0)
+        {
+                yf_log_error(YF_LOG_WARN, sched->log, yf_errno,
+                                "munmap co stack %p failed", map_addr);
+        }
+}
+
+
+void yf_co_sched_destory(yf_co_sched_t* sched)
+{
+        yf_co_sched_in_t* sched_in = (yf_co_sched_in_t*)sched;
+        yf_co_in_t* co, *next;
+
+        assert(yf_co_current == NULL);
+
+        yf_list_for_each_entry_safe(co, next, &sched_in->co_list, linker)
+        {
+                yf_list_del(&co->linker);
+                yf_unregister_tm_evt(co->tm_evt);
+
+                if (co->wait_evt)
+                {
+                        yf_unregister_fd_evt(co->wait_evt);
+                        co->wait_evt->data = co->wait_org_data;
+                        co->wait_evt->fd_evt_handler = co->wait_org_handler;
+                        co->wait_evt = NULL;
+                }
+                yf_co_unmap(sched_in, co);
+        }
+
+        yf_list_for_each_entry_safe(co, next, &sched_in->free_list, linker)
+        {
+                yf_list_del(&co->linker);
+                yf_co_unmap(sched_in, co);
+        }
+
+        yf_free(sched_in);
+}
+
+
+static yf_co_in_t* yf_co_alloc(yf_co_sched_in_t* sched)
+{
+        char* map_addr;
+        yf_co_in_t* co;
+        yf_list_part_t* part;
+
+        if (sched->max_num && sched->co_num >= sched->max_num)
+        {
+                yf_log_error(YF_LOG_WARN, sched->log, 0, "too many coroutines, max=%d",
+                                sched->max_num);
+                return NULL;
+        }
+
+        if (!yf_list_empty(&sched->free_list))
+        {
+                part = yf_list_pop_head(&sched->free_list);
+                --sched->free_num;
+                return yf_list_entry(part, yf_co_in_t, linker);
+        }
+
+#if defined (HAVE_MAP_ANON)
+        map_addr = mmap(NULL, sched->map_size, PROT_READ | PROT_WRITE,
+                        MAP_ANON | MAP_PRIVATE, -1, 0);
+#else
+        map_addr = mmap(NULL, sched->map_size, PROT_READ | PROT_WRITE,
+                        MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+#endif
+        if (map_addr == MAP_FAILED)
+        {
+                yf_log_error(YF_LOG_ERR, sched->log, yf_errno,
+                                "mmap co stack size=%d failed", sched->map_size);
+                return NULL;
+        }
+
+        //guard page, stack overflow will core at once
+        if (mprotect(map_addr, yf_pagesize, PROT_NONE) != 0)
+        {
+                yf_log_error(YF_LOG_WARN, sched->log, yf_errno,
+                                "mprotect co guard page failed");
+        }
+
+        co = (yf_co_in_t*)(map_addr + sched->map_size
+                        - yf_align(sizeof(yf_co_in_t), 64));
+        co->map_addr = map_addr;
+        co->sched = sched;
+
+        if (yf_alloc_tm_evt(sched->driver, &co->tm_evt, sched->log) != YF_OK)
+        {
+                munmap(map_addr, sched->map_size);
+                return NULL;
+        }
+
+        co->tm_evt->data = co;
+        co->tm_evt->timeout_handler = yf_co_tm_handler;
+        return co;
+}
+
+
+static void yf_co_recycle(yf_co_sched_in_t* sched, yf_co_in_t* co)
+{
+        yf_log_debug1(YF_LOG_DEBUG, sched->log, 0, "co id=%L end", co->id);
+
+        yf_list_del(&co->linker);
+        --sched->co_num;
+
+        if (sched->free_num >= YF_CO_MAX_FREE_STACK)
+        {
+                yf_co_unmap(sched, co);
+                return;
+        }
+
+        yf_list_add_head(&co->linker, &sched->free_list);
+        ++sched->free_num;
+}
+
+
+yf_int_t  yf_co_spawn(yf_co_sched_t* sched, yf_co_func_pt func
+                , void* arg, yf_u64_t* id)
+{
+        yf_co_sched_in_t* sched_in = (yf_co_sched_in_t*)sched;
+        yf_time_t  time_out = {0, 0};
+
+        yf_co_in_t* co = yf_co_alloc(sched_in);
+        CHECK_RV(co == NULL, YF_ERROR);
+
+        co->id = yf_id_seed_alloc(&sched_in->id_seed);
+        co->func = func;
+        co->arg = arg;
+        co->status = YF_CO_READY;
+
+        yf_co_ctx_make(&co->ctx, co->map_addr + yf_pagesize, co, yf_co_entry);
+
+        yf_list_add_tail(&co->linker, &sched_in->co_list);
+        ++sched_in->co_num;
+
+        yf_log_debug1(YF_LOG_DEBUG, sched_in->log, 0, "co id=%L spawned", co->id);
+
+        if (id)
+                *id = co->id;
+
+        if (yf_co_current == NULL)
+        {
+                yf_co_resume(co);
+                return YF_OK;
+        }
+
+        //cant nest resume, start it in next loop
+        return yf_register_tm_evt(co->tm_evt, &time_out);
+}
+
+
+yf_u64_t  yf_co_self_id()
+{
+        return yf_co_current ? yf_co_current->id : 0;
+}
+
+
+yf_u32_t  yf_co_num(yf_co_sched_t* sched)
+{
+        return ((yf_co_sched_in_t*)sched)->co_num;
+}
+
+
+static void yf_co_entry(void)
+{
+        yf_co_in_t* co = yf_co_current;
+
+        co->func(co->arg);
+
+        co->status = YF_CO_DEAD;
+        yf_co_switch(&co->ctx, &co->sched->main_ctx);
+
+        //never reach here
+        assert(0);
+}
+
+
+static void yf_co_resume(yf_co_in_t* co)
+{
+        yf_co_sched_in_t* sched = co->sched;
+
+        assert(yf_co_current == NULL);
+        assert(co->status != YF_CO_DEAD);
+
+        co->status = YF_CO_RUNNING;
+        yf_co_current = co;
+
+        yf_co_switch(&sched->main_ctx, &co->ctx);
+
+        yf_co_current = NULL;
+
+        if (co->status == YF_CO_DEAD)
+                yf_co_recycle(sched, co);
+}
+
+
+static void yf_co_park(yf_co_in_t* co)
+{
+        co->status = YF_CO_WAIT;
+        yf_co_switch(&co->ctx, &co->sched->main_ctx);
+}
+
+
+static void yf_co_tm_handler(yf_tm_evt_t* evt, yf_time_t* start)
+{
+        yf_co_resume((yf_co_in_t*)evt->data);
+}
+
+
+static void yf_co_fd_handler(yf_fd_event_t* evt)
+{
+        yf_co_resume((yf_co_in_t*)evt->data);
+}
+
+
+yf_int_t  yf_co_sleep(yf_u32_t ms)
+{
+        yf_time_t  time_out;
+        yf_co_in_t* co = yf_co_current;
+
+        CHECK_RV(co == NULL, YF_ERROR);
+
+        yf_ms_2_time(ms, &time_out);
+
+        if (yf_register_tm_evt(co->tm_evt, &time_out) != YF_OK)
+                return YF_ERROR;
+
+        yf_co_park(co);
+        return YF_OK;
+}
+
+
+static yf_int_t  yf_co_wait_fd(yf_co_in_t* co, yf_fd_event_t* evt
+                , yf_u32_t timeout_ms)
+{
+        yf_int_t  rc;
+        yf_time_t  time_out;
+        void* org_data = evt->data;
+        void (*org_handler)(yf_fd_event_t* evt) = evt->fd_evt_handler;
+
+        co->wait_evt = evt;
+        co->wait_org_data = org_data;
+        co->wait_org_handler = org_handler;
+
+        evt->data = co;
+        evt->fd_evt_handler = yf_co_fd_handler;
+
+        if (timeout_ms)
+        {
+                yf_ms_2_time(timeout_ms, &time_out);
+                rc = yf_register_fd_evt(evt, &time_out);
+        }
+        else
+                rc = yf_register_fd_evt(evt, NULL);
+
+        if (rc == YF_OK)
+                yf_co_park(co);
+
+        evt->data = org_data;
+        evt->fd_evt_handler = org_handler;
+        co->wait_evt = NULL;
+
+        CHECK_RV(rc != YF_OK, YF_ERROR);
+
+        if (evt->timeout)
+        {
+                yf_log_debug2(YF_LOG_DEBUG, evt->log, 0, "co id=%L, fd=%d wait timeout",
+                                co->id, evt->fd);
+                yf_set_errno(YF_ETIMEDOUT);
+                return YF_ERROR;
+        }
+        return YF_OK;
+}
+
+
+ssize_t  yf_co_read(yf_fd_event_t* rev, char* buf, size_t size
+                , yf_u32_t timeout_ms)
+{
+        ssize_t  n;
+        yf_err_t  err;
+        yf_co_in_t* co = yf_co_current;
+
+        CHECK_RV(co == NULL, YF_ERROR);
+
+        for ( ;; )
+        {
+                n = yf_read(rev->fd, buf, size);
+                if (n > 0)
+                        return n;
+
+                if (n == 0)
+                {
+                        rev->ready = 0;
+                        rev->eof = 1;
+                        return 0;
+                }
+
+                err = yf_errno;
+                if (err == YF_EINTR)
+                        continue;
+
+                if (!YF_EAGAIN(err))
+                {
+                        rev->ready = 0;
+                        rev->error = 1;
+                        yf_log_error(YF_LOG_ERR, rev->log, err, "co read fd=%d failed",
+                                        rev->fd);
+                        return YF_ERROR;
+                }
+
+                rev->ready = 0;
+                if (yf_co_wait_fd(co, rev, timeout_ms) != YF_OK)
+                        return YF_ERROR;
+        }
+}
+
+
+ssize_t  yf_co_write(yf_fd_event_t* wev, char* buf, size_t size
+                , yf_u32_t timeout_ms)
+{
+        ssize_t  n;
+        size_t  sended = 0;
+        yf_err_t  err;
+        yf_co_in_t* co = yf_co_current;
+
+        CHECK_RV(co == NULL, YF_ERROR);
+
+        while (sended < size)
+        {
+                n = yf_write(wev->fd, buf + sended, size - sended);
+                if (n >= 0)
+                {
+                        sended += n;
+                        continue;
+                }
+
+                err = yf_errno;
+                if (err == YF_EINTR)
+                        continue;
+
+                if (!YF_EAGAIN(err))
+                {
+                        wev->ready = 0;
+                        wev->error = 1;
+                        yf_log_error(YF_LOG_ERR, wev->log, err, "co write fd=%d failed",
+                                        wev->fd);
+                        return YF_ERROR;
+                }
+
+                wev->ready = 0;
+                if (yf_co_wait_fd(co, wev, timeout_ms) != YF_OK)
+                        return YF_ERROR;
+        }
+
+        return sended;
+}
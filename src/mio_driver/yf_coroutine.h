@@ -0,0 +1,56 @@
+#ifndef _YF_COROUTINE_H_20261019_H
+#define _YF_COROUTINE_H_20261019_H
+
+#include <base_struct/yf_core.h>
+#include <ppc/yf_header.h>
+#include <mio_driver/yf_event.h>
+
+/*
+* stackful coroutine on evt driver, one sched per driver(thread)
+* coroutine park on fd/tm evt, and resumed by the evt handler,
+* so the driver loop is still the only scheduler.
+*/
+typedef  yf_u64_t  yf_co_sched_t;
+
+typedef  void (*yf_co_func_pt)(void* arg);
+
+#define YF_CO_DEFAULT_STACK_SIZE  (64 * 1024)
+
+//stack_size=0, use default; max_num=0, no limit
+yf_co_sched_t* yf_co_sched_create(yf_evt_driver_t* driver
+                , yf_u32_t stack_size, yf_u32_t max_num, yf_log_t* log);
+
+/*
+* all coroutine not ended will be dropped (their stack freed, no unwind),
+* the fd evts they wait are unregistered and get their handler/data back
+*/
+void yf_co_sched_destory(yf_co_sched_t* sched);
+
+/*
+* if called outside coroutine, the new coroutine run at once untill it parked,
+* else it will be started in next driver loop
+*/
+yf_int_t  yf_co_spawn(yf_co_sched_t* sched, yf_co_func_pt func
+                , void* arg, yf_u64_t* id);
+
+//return 0 if not in coroutine
+yf_u64_t  yf_co_self_id();
+
+yf_u32_t  yf_co_num(yf_co_sched_t* sched);
+
+/*
+* must called in coroutine, fd must be nonblock
+* while waiting, the evt handler/data is taken by coroutine, restored after
+* timeout_ms=0 means no timeout, if timeout, return YF_ERROR with errno=ETIMEDOUT
+* read return once some bytes got (0 if eof), write return after all sended
+*/
+ssize_t  yf_co_read(yf_fd_event_t* rev, char* buf, size_t size
+                , yf_u32_t timeout_ms);
+ssize_t  yf_co_write(yf_fd_event_t* wev, char* buf, size_t size
+                , yf_u32_t timeout_ms);
+
+yf_int_t  yf_co_sleep(yf_u32_t ms);
+
+#define yf_co_yield() yf_co_sleep(0)
+
+#endif
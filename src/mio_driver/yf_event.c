@@ -103,6 +103,9 @@ void yf_evt_driver_destory(yf_evt_driver_t* driver)
                 yf_reset_sig_driver(evt_driver->driver_ctx.log);
         }
 
+        if (evt_driver->watch_driver)
+                yf_destory_watch_driver(evt_driver->watch_driver);
+
         if (evt_driver->proc_driver_inited)
         {
                 yf_destory_proc_driver(&evt_driver->proc_driver);
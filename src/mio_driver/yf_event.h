@@ -188,5 +188,70 @@ yf_int_t   yf_unregister_proc_evt(yf_processor_event_t* proc_evt);
 
 yf_process_t* yf_get_proc_by_evt(yf_processor_event_t* proc_evt);
 
+/*
+* user evt, backed by eventfd (pipe if no eventfd), can be triggered in any thread,
+* handler called in the driver thread, triggers before handler called are
+* coalesced to one call, cnt is the trigger times.
+* auto rearmed after handler called, no need to register.
+*/
+typedef struct yf_user_event_s
+{
+        void*        data;
+        YF_EVT_DATA;
+        yf_log_t*   log;
+
+        yf_evt_driver_t*  driver;
+
+        void (*user_evt_handler)(struct yf_user_event_s* evt, yf_u64_t cnt);
+}
+yf_user_event_t;
+
+yf_int_t  yf_alloc_user_evt(yf_evt_driver_t* driver, yf_user_event_t** user_evt
+                , yf_log_t* log);
+yf_int_t  yf_free_user_evt(yf_user_event_t* user_evt);
+
+//thread safe
+yf_int_t  yf_trigger_user_evt(yf_user_event_t* user_evt);
+
+/*
+* watch evt, notify changes of file or files under dir (inotify, linux only)
+* path must be valid untill unregister, handler called each change,
+* name is the changed file name under dir, NULL if the path self changed.
+* if YF_WATCH_GONE reported, the watch is removed by kernel, need register again
+* YF_WATCH_OVERFLOW (name NULL) is reported to every registered watch whatever
+* its mask, if the kernel queue overflowed and evts lost, handler should rescan
+*/
+#define YF_WATCH_MODIFY  0x01
+#define YF_WATCH_CREATE  0x02
+#define YF_WATCH_DELETE  0x04
+#define YF_WATCH_MOVE    0x08
+#define YF_WATCH_ATTRIB  0x10
+#define YF_WATCH_GONE    0x20
+#define YF_WATCH_OVERFLOW  0x40
+#define YF_WATCH_ALL     0x1f
+
+typedef struct yf_watch_event_s
+{
+        char*        path;
+        yf_u32_t   mask;
+        
+        void*        data;
+        YF_EVT_DATA;
+        yf_log_t*   log;
+
+        yf_evt_driver_t*  driver;
+
+        void (*watch_evt_handler)(struct yf_watch_event_s* evt
+                        , yf_u32_t what, const char* name);
+}
+yf_watch_event_t;
+
+yf_int_t  yf_alloc_watch_evt(yf_evt_driver_t* driver, yf_watch_event_t** watch_evt
+                , yf_log_t* log);
+yf_int_t  yf_free_watch_evt(yf_watch_event_t* watch_evt);
+
+yf_int_t  yf_register_watch_evt(yf_watch_event_t* watch_evt);
+yf_int_t  yf_unregister_watch_evt(yf_watch_event_t* watch_evt);
+
 #endif
 
@@ -45,3 +45,210 @@ yf_memalign(size_t alignment, size_t size, yf_log_t *log)
 }
 
 #endif
+
+
+yf_uint_t  yf_hpage_mode = YF_HPAGE_OFF;
+
+//heap pages only, keep the mem after it cache line aligned
+typedef struct
+{
+        size_t  map_size;
+        yf_u32_t  type;
+        yf_u32_t  magic;
+}
+yf_page_hdr_t;
+
+#define YF_PAGE_HDR_SIZE  64
+
+/*
+* mapped pages keep no header in band, so a 2m request maps one huge page,
+* not two; map size and type kept aside, hashed by the (huge page aligned)
+* addr, only looked up in free
+*/
+typedef struct yf_page_map_s
+{
+        struct yf_page_map_s *next;
+        char  *addr;
+        size_t  map_size;
+        yf_u32_t  type;
+}
+yf_page_map_t;
+
+#define YF_PAGE_MAP_BUCKETS  64
+#define yf_page_map_bucket(addr) \
+                (((yf_uint_ptr_t)(addr) / YF_HPAGE_SIZE) % YF_PAGE_MAP_BUCKETS)
+
+static yf_page_map_t *yf_page_maps[YF_PAGE_MAP_BUCKETS];
+static yf_lock_t  yf_page_map_lock = YF_LOCK_INITIALIZER;
+
+
+//unlink it if del
+static yf_page_map_t *
+yf_page_map_find(void *p, yf_int_t del)
+{
+        yf_page_map_t **pos, *map;
+
+        yf_lock(&yf_page_map_lock);
+
+        for (pos = yf_page_maps + yf_page_map_bucket(p); *pos; pos = &(*pos)->next)
+        {
+                if ((*pos)->addr == p)
+                        break;
+        }
+
+        map = *pos;
+        if (map && del)
+                *pos = map->next;
+
+        yf_unlock(&yf_page_map_lock);
+        return map;
+}
+
+#if defined (HAVE_MAP_ANON)
+#define YF_PAGE_MAP_FLAGS  (MAP_ANON | MAP_PRIVATE)
+#else
+#define YF_PAGE_MAP_FLAGS  (MAP_ANONYMOUS | MAP_PRIVATE)
+#endif
+
+
+//map one more huge page, then cut the head and tail to be huge page aligned
+static char *
+yf_page_map_aligned(size_t map_size, yf_u32_t *type, yf_log_t *log)
+{
+        char *addr, *aligned;
+        size_t head;
+
+        addr = mmap(NULL, map_size + YF_HPAGE_SIZE, PROT_READ | PROT_WRITE,
+                    YF_PAGE_MAP_FLAGS, -1, 0);
+        if (addr == MAP_FAILED)
+        {
+                yf_log_error(YF_LOG_ERR, log, yf_errno, "mmap pages size=%d failed", map_size);
+                return NULL;
+        }
+
+        aligned = yf_align_ptr(addr, YF_HPAGE_SIZE);
+        head = aligned - addr;
+
+        if (head)
+                munmap(addr, head);
+        munmap(aligned + map_size, YF_HPAGE_SIZE - head);
+
+        *type = YF_PAGE_MAP;
+
+#ifdef MADV_HUGEPAGE
+        if (madvise(aligned, map_size, MADV_HUGEPAGE) == 0)
+                *type = YF_PAGE_THP;
+        else
+                yf_log_debug1(YF_LOG_DEBUG, log, yf_errno, "madvise hugepage failed");
+#endif
+        return aligned;
+}
+
+
+void *
+yf_page_alloc(size_t size, yf_log_t *log)
+{
+        char *addr = NULL;
+        size_t map_size;
+        yf_u32_t type = YF_PAGE_HEAP;
+        yf_page_hdr_t *hdr;
+        yf_page_map_t *map;
+
+        CHECK_RV(size > ((size_t)-1) - 2 * YF_HPAGE_SIZE, NULL);
+
+        if (yf_hpage_mode == YF_HPAGE_OFF || size < YF_HPAGE_MIN_SIZE)
+        {
+                size += YF_PAGE_HDR_SIZE;
+                hdr = yf_alloc(size);
+                if (unlikely(hdr == NULL))
+                {
+                        yf_log_error(YF_LOG_ERR, log, yf_errno, "alloc pages size=%d failed", size);
+                        return NULL;
+                }
+
+                hdr->map_size = 0;
+                hdr->type = type;
+                yf_set_magic(hdr->magic);
+                return yf_mem_off(hdr, YF_PAGE_HDR_SIZE);
+        }
+
+        map = yf_alloc(sizeof(yf_page_map_t));
+        CHECK_RV(map == NULL, NULL);
+
+        map_size = yf_align(size, YF_HPAGE_SIZE);
+
+#ifdef MAP_HUGETLB
+        if (yf_hpage_mode == YF_HPAGE_ON)
+        {
+                addr = mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+                            YF_PAGE_MAP_FLAGS | MAP_HUGETLB, -1, 0);
+                if (addr != MAP_FAILED)
+                        type = YF_PAGE_HUGETLB;
+                else {
+                        addr = NULL;
+                        yf_log_debug1(YF_LOG_DEBUG, log, yf_errno,
+                                      "mmap hugetlb size=%d failed, no reserved huge pages?", 
+                                      map_size);
+                }
+        }
+#endif
+
+        if (addr == NULL)
+        {
+                addr = yf_page_map_aligned(map_size, &type, log);
+                if (addr == NULL)
+                {
+                        yf_free(map);
+                        return NULL;
+                }
+        }
+
+        map->addr = addr;
+        map->map_size = map_size;
+        map->type = type;
+
+        yf_lock(&yf_page_map_lock);
+        map->next = yf_page_maps[yf_page_map_bucket(addr)];
+        yf_page_maps[yf_page_map_bucket(addr)] = map;
+        yf_unlock(&yf_page_map_lock);
+
+        return addr;
+}
+
+
+void
+yf_page_free(void *p)
+{
+        yf_page_hdr_t *hdr;
+        yf_page_map_t *map;
+
+        if (p == NULL)
+                return;
+
+        map = yf_page_map_find(p, 1);
+        if (map)
+        {
+                munmap(map->addr, map->map_size);
+                yf_free(map);
+                return;
+        }
+
+        hdr = yf_mem_off(p, -YF_PAGE_HDR_SIZE);
+        assert(yf_check_magic(hdr->magic));
+        free(hdr);
+}
+
+
+yf_int_t
+yf_page_type(void *p)
+{
+        yf_page_hdr_t *hdr;
+        yf_page_map_t *map = yf_page_map_find(p, 0);
+
+        if (map)
+                return map->type;
+
+        hdr = yf_mem_off(p, -YF_PAGE_HDR_SIZE);
+        assert(yf_check_magic(hdr->magic));
+        return hdr->type;
+}
@@ -30,4 +30,33 @@ void *yf_memalign(size_t alignment, size_t size, yf_log_t *log);
 #define yf_memalign(alignment, size, yf_log_t *log)  yf_alloc(size)
 #endif
 
+/*
+* pages for big tables and pools (fd/timer pevents, hnpool chunks, pools
+* >= YF_HPAGE_MIN_SIZE), mem is zeroed, may be huge pages if enabled:
+* YF_HPAGE_ON: MAP_HUGETLB first (needs reserved huge pages), then 2m
+* aligned map + madvise(MADV_HUGEPAGE), then normal pages
+* YF_HPAGE_THP: no MAP_HUGETLB try
+* mapped ones are huge page aligned, with no header in them, so a request
+* of n huge pages maps just n
+* set yf_hpage_mode before the drivers and pools created
+*/
+#define YF_HPAGE_SIZE  (2 * 1024 * 1024)
+#define YF_HPAGE_MIN_SIZE  (YF_HPAGE_SIZE >> 1)
+
+#define YF_HPAGE_OFF  0
+#define YF_HPAGE_ON  1
+#define YF_HPAGE_THP  2
+
+extern yf_uint_t yf_hpage_mode;
+
+//where the pages come from
+#define YF_PAGE_HEAP  0
+#define YF_PAGE_MAP  1
+#define YF_PAGE_THP  2
+#define YF_PAGE_HUGETLB  3
+
+void *yf_page_alloc(size_t size, yf_log_t *log);
+void  yf_page_free(void *p);
+yf_int_t  yf_page_type(void *p);
+
 #endif
@@ -139,6 +139,20 @@ typedef yf_u32_t                     yf_atomic_uint_t;
 typedef volatile yf_atomic_uint_t  yf_atomic_t;
 #endif
 
+/*
+* acquire load/release store, enough for single producer single consumer
+* publish (data write must be visible before the index store)
+*/
+#if defined __ATOMIC_ACQUIRE
+#define yf_atomic_load_acquire(ptr)  __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define yf_atomic_store_release(ptr, val)  __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
+#else
+#define yf_atomic_load_acquire(ptr) ({ \
+                __typeof__(*(ptr)) __v = *(ptr); yf_memory_barrier(); __v; })
+#define yf_atomic_store_release(ptr, val) do { \
+                yf_memory_barrier(); *(ptr) = (val); } while (0)
+#endif
+
 #endif
 
 
@@ -104,6 +104,9 @@ ssize_t yf_read_file(struct yf_file_s *file, char *buf, size_t size, off_t offse
 
 ssize_t yf_write_file(struct yf_file_s *file, char *buf, size_t size, off_t offset);
 
+ssize_t yf_write_chain_to_file(struct yf_file_s *file, yf_chain_t *cl
+                , off_t offset, yf_pool_t *pool);
+
 
 
 #define yf_linefeed(p)          *p++ = '\n';
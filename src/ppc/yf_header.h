@@ -115,6 +115,7 @@ typedef struct yf_channel_s  yf_channel_t;
 #include "yf_signal.h"
 #include "yf_proc_ctx.h"
 #include "yf_atexit.h"
+#include "yf_tcache.h"
 
 extern char **environ;
 
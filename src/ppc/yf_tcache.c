@@ -0,0 +1,507 @@
+#include <ppc/yf_header.h>
+#include <base_struct/yf_core.h>
+
+/*
+* span: 64k aligned, header at the head, then blocks of one size class,
+* so the span of a block is found by masking the block addr
+* large block: the same header in front of it, cls=YF_TC_LARGE
+*/
+#define YF_TC_SPAN_SHIFT  16
+#define YF_TC_SPAN_SIZE  (1 << YF_TC_SPAN_SHIFT)
+#define YF_TC_SPAN_HDR  64
+
+//16~128 step 16, then 4 classes between each power of 2, untill 8k
+#define YF_TC_CLASS_NUM  32
+#define YF_TC_LARGE  YF_TC_CLASS_NUM
+
+#define YF_TC_MAG_MAX  256
+
+typedef struct yf_tc_cache_s  yf_tc_cache_t;
+
+typedef struct
+{
+        yf_u32_t  magic;
+        yf_u32_t  cls;
+        //blocks out of the span, in magazine or in use
+        yf_u32_t  used;
+        yf_u32_t  pad;
+        yf_tc_cache_t*  owner;
+        yf_slist_part_t  free;
+        char*  bump;
+        size_t  size;
+        //in class spans list if has free blocks
+        yf_list_part_t  linker;
+}
+yf_tc_span_t;
+
+typedef struct
+{
+        yf_slist_part_t  mag;
+        yf_u32_t  mag_cnt;
+        //min mag_cnt since last trim, so many blocks unused all the while
+        yf_u32_t  mag_low;
+        yf_u32_t  span_num;
+        yf_list_part_t  spans;
+}
+yf_tc_class_t;
+
+struct yf_tc_cache_s
+{
+        //blocks freed by other threads, a slist pushed by cas
+        yf_atomic_t  remote ____cacheline_aligned;
+
+        yf_tc_class_t  cls[YF_TC_CLASS_NUM] ____cacheline_aligned;
+        yf_u32_t  ticks;
+        yf_u32_t  span_num;
+
+        //in orphan list after the thread exit
+        yf_list_part_t  linker;
+};
+
+#define yf_tc_span_of(p) \
+        ((yf_tc_span_t*)((yf_uint_ptr_t)(p) & ~((yf_uint_ptr_t)YF_TC_SPAN_SIZE - 1)))
+
+#define yf_tc_span_end(span) ((char*)(span) + YF_TC_SPAN_SIZE)
+
+static yf_u16_t  yf_tc_cls_size[YF_TC_CLASS_NUM];
+static yf_u16_t  yf_tc_mag_max[YF_TC_CLASS_NUM];
+static yf_u8_t  yf_tc_size_cls[(YF_TC_MAX_SIZE >> 4) + 1];
+
+static yf_tls_key_t  yf_tc_key;
+static yf_tls_once_t  yf_tc_once = PTHREAD_ONCE_INIT;
+
+static yf_lock_t  yf_tc_orphan_lock = YF_LOCK_INITIALIZER;
+static yf_list_part_t  yf_tc_orphans = YF_EMPTY_LIST_INIT(yf_tc_orphans);
+
+static void yf_tc_init(void);
+
+#if defined ___YF_THREAD_UNSUPPORT
+#define yf_tc_self() (pthread_once(&yf_tc_once, yf_tc_init), \
+                (yf_tc_cache_t*)yf_thread_get_tls(yf_tc_key))
+#define yf_tc_set_self(cache)
+#else
+static ___YF_THREAD yf_tc_cache_t*  yf_tc_self_ins;
+#define yf_tc_self() yf_tc_self_ins
+#define yf_tc_set_self(cache) (yf_tc_self_ins = (cache))
+#endif
+
+static void yf_tc_thread_exit(void* arg);
+static void* yf_tc_refill(yf_tc_cache_t* cache, yf_u32_t idx);
+static void yf_tc_flush(yf_tc_cache_t* cache, yf_u32_t idx
+                , yf_u32_t num, yf_int_t trim);
+static void yf_tc_trim_cache(yf_tc_cache_t* cache);
+
+
+static void yf_tc_init(void)
+{
+        yf_u32_t  i1, size, idx = 0;
+
+        for (i1 = 0; i1 < YF_TC_CLASS_NUM; ++i1)
+        {
+                if (i1 < 8)
+                        size = (i1 + 1) << 4;
+                else
+                        size = ((i1 & 3) + 5) << ((i1 >> 2) + 3);
+
+                yf_tc_cls_size[i1] = size;
+                yf_tc_mag_max[i1] = yf_max(8, yf_min(YF_TC_MAG_MAX
+                                , (YF_TC_SPAN_SIZE >> 1) / size));
+        }
+
+        for (i1 = 0; i1 <= (YF_TC_MAX_SIZE >> 4); ++i1)
+        {
+                while (yf_tc_cls_size[idx] < (i1 << 4))
+                        ++idx;
+                yf_tc_size_cls[i1] = idx;
+        }
+
+        pthread_key_create(&yf_tc_key, yf_tc_thread_exit);
+}
+
+
+//adopt an orphan cache if any
+static yf_tc_cache_t* yf_tc_cache_get(void)
+{
+        yf_u32_t  i1;
+        yf_tc_cache_t* cache = NULL;
+
+        pthread_once(&yf_tc_once, yf_tc_init);
+
+        yf_lock(&yf_tc_orphan_lock);
+        if (!yf_list_empty(&yf_tc_orphans))
+        {
+                cache = yf_list_entry(yf_tc_orphans.next, yf_tc_cache_t, linker);
+                yf_list_del(&cache->linker);
+        }
+        yf_unlock(&yf_tc_orphan_lock);
+
+        if (cache == NULL)
+        {
+                cache = yf_memalign(YF_TC_SPAN_HDR, sizeof(yf_tc_cache_t), NULL);
+                CHECK_RV(cache == NULL, NULL);
+
+                yf_memzero(cache, sizeof(yf_tc_cache_t));
+                for (i1 = 0; i1 < YF_TC_CLASS_NUM; ++i1)
+                        yf_init_list_head(&cache->cls[i1].spans);
+        }
+
+        yf_thread_set_tls(yf_tc_key, cache);
+        yf_tc_set_self(cache);
+        return cache;
+}
+
+
+static void yf_tc_thread_exit(void* arg)
+{
+        yf_tc_cache_t* cache = arg;
+
+        yf_tc_trim_cache(cache);
+        yf_tc_set_self(NULL);
+
+        //no block out, no one can push to remote any more
+        if (cache->span_num == 0)
+        {
+                free(cache);
+                return;
+        }
+
+        yf_lock(&yf_tc_orphan_lock);
+        yf_list_add_tail(&cache->linker, &yf_tc_orphans);
+        yf_unlock(&yf_tc_orphan_lock);
+}
+
+
+static void* yf_tc_alloc_large(size_t size)
+{
+        yf_tc_span_t* span;
+
+        CHECK_RV(size > ((size_t)-1) - YF_TC_SPAN_HDR, NULL);
+
+        span = yf_memalign(YF_TC_SPAN_SIZE, YF_TC_SPAN_HDR + size, NULL);
+        CHECK_RV(span == NULL, NULL);
+
+        yf_set_magic(span->magic);
+        span->cls = YF_TC_LARGE;
+        span->size = size;
+        span->owner = NULL;
+        return yf_mem_off(span, YF_TC_SPAN_HDR);
+}
+
+
+void* yf_tc_alloc(size_t size)
+{
+        yf_u32_t  idx;
+        yf_tc_class_t* cls;
+        yf_slist_part_t* blk;
+        yf_tc_cache_t* cache;
+
+        if (unlikely(size > YF_TC_MAX_SIZE))
+                return yf_tc_alloc_large(size);
+
+        cache = yf_tc_self();
+        if (unlikely(cache == NULL))
+        {
+                cache = yf_tc_cache_get();
+                CHECK_RV(cache == NULL, NULL);
+        }
+
+        idx = yf_tc_size_cls[(size + 15) >> 4];
+        cls = cache->cls + idx;
+
+        blk = cls->mag.next;
+        if (unlikely(blk == NULL))
+                return yf_tc_refill(cache, idx);
+
+        cls->mag.next = blk->next;
+        if (--cls->mag_cnt < cls->mag_low)
+                cls->mag_low = cls->mag_cnt;
+        return blk;
+}
+
+
+void* yf_tc_calloc(size_t size)
+{
+        void* p = yf_tc_alloc(size);
+        if (p)
+                yf_memzero(p, size);
+        return p;
+}
+
+
+static void yf_tc_remote_push(yf_tc_cache_t* owner, yf_slist_part_t* blk)
+{
+        yf_atomic_uint_t  head;
+
+        do {
+                head = owner->remote;
+                blk->next = (yf_slist_part_t*)head;
+        }
+        while (!yf_atomic_cmp_swp(&owner->remote, head, (yf_atomic_uint_t)blk));
+}
+
+
+void yf_tc_free(void* p)
+{
+        yf_u32_t  idx;
+        yf_tc_span_t* span;
+        yf_tc_class_t* cls;
+        yf_tc_cache_t* cache;
+        yf_slist_part_t* blk = p;
+
+        if (p == NULL)
+                return;
+
+        span = yf_tc_span_of(p);
+        assert(yf_check_magic(span->magic));
+
+        if (unlikely(span->cls == YF_TC_LARGE))
+        {
+                free(span);
+                return;
+        }
+
+        cache = yf_tc_self();
+        if (unlikely(span->owner != cache))
+        {
+                yf_tc_remote_push(span->owner, blk);
+                return;
+        }
+
+        idx = span->cls;
+        cls = cache->cls + idx;
+
+        blk->next = cls->mag.next;
+        cls->mag.next = blk;
+
+        if (unlikely(++cls->mag_cnt > yf_tc_mag_max[idx]))
+        {
+                ++cache->ticks;
+                yf_tc_flush(cache, idx, yf_tc_mag_max[idx] >> 1, 0);
+        }
+}
+
+
+size_t yf_tc_size(void* p)
+{
+        yf_tc_span_t* span = yf_tc_span_of(p);
+
+        assert(yf_check_magic(span->magic));
+        if (span->cls == YF_TC_LARGE)
+                return span->size;
+        return yf_tc_cls_size[span->cls];
+}
+
+
+static yf_tc_span_t* yf_tc_span_alloc(yf_tc_cache_t* cache, yf_u32_t idx)
+{
+        yf_tc_span_t* span = yf_memalign(YF_TC_SPAN_SIZE, YF_TC_SPAN_SIZE, NULL);
+        CHECK_RV(span == NULL, NULL);
+
+        yf_memzero(span, sizeof(yf_tc_span_t));
+        yf_set_magic(span->magic);
+        span->cls = idx;
+        span->owner = cache;
+        span->bump = yf_mem_off(span, YF_TC_SPAN_HDR);
+
+        yf_list_add_head(&span->linker, &cache->cls[idx].spans);
+        ++cache->cls[idx].span_num;
+        ++cache->span_num;
+        return span;
+}
+
+
+static void yf_tc_span_release(yf_tc_cache_t* cache, yf_tc_span_t* span)
+{
+        if (yf_list_linked(&span->linker))
+                yf_list_del(&span->linker);
+
+        --cache->cls[span->cls].span_num;
+        --cache->span_num;
+        free(span);
+}
+
+
+static yf_slist_part_t* yf_tc_span_get(yf_tc_cache_t* cache, yf_u32_t idx)
+{
+        yf_tc_span_t* span;
+        yf_slist_part_t* blk;
+        yf_tc_class_t* cls = cache->cls + idx;
+        size_t  size = yf_tc_cls_size[idx];
+
+        if (yf_list_empty(&cls->spans))
+        {
+                span = yf_tc_span_alloc(cache, idx);
+                CHECK_RV(span == NULL, NULL);
+        }
+        else
+                span = yf_list_entry(cls->spans.next, yf_tc_span_t, linker);
+
+        blk = yf_slist_pop(&span->free);
+        if (blk == NULL)
+        {
+                blk = (yf_slist_part_t*)span->bump;
+                span->bump += size;
+        }
+        ++span->used;
+
+        if (yf_slist_empty(&span->free)
+                        && span->bump + size > yf_tc_span_end(span))
+                yf_list_del(&span->linker);
+        return blk;
+}
+
+
+//an empty span is kept if it is the last of the class, except on trim
+static void yf_tc_span_put(yf_tc_cache_t* cache, yf_slist_part_t* blk, yf_int_t trim)
+{
+        yf_tc_span_t* span = yf_tc_span_of(blk);
+        yf_tc_class_t* cls = cache->cls + span->cls;
+
+        yf_slist_push(blk, &span->free);
+
+        if (--span->used == 0 && (trim || cls->span_num > 1))
+        {
+                yf_tc_span_release(cache, span);
+                return;
+        }
+
+        if (!yf_list_linked(&span->linker))
+                yf_list_add_tail(&span->linker, &cls->spans);
+}
+
+
+static void yf_tc_drain_remote(yf_tc_cache_t* cache, yf_int_t trim)
+{
+        yf_atomic_uint_t  head;
+        yf_slist_part_t* blk, *next;
+
+        do {
+                head = cache->remote;
+        }
+        while (head && !yf_atomic_cmp_swp(&cache->remote, head, 0));
+
+        for (blk = (yf_slist_part_t*)head; blk; blk = next)
+        {
+                next = blk->next;
+                yf_tc_span_put(cache, blk, trim);
+        }
+}
+
+
+static void yf_tc_flush(yf_tc_cache_t* cache, yf_u32_t idx
+                , yf_u32_t num, yf_int_t trim)
+{
+        yf_slist_part_t* blk;
+        yf_tc_class_t* cls = cache->cls + idx;
+
+        for (; num && cls->mag_cnt; --num)
+        {
+                blk = yf_slist_pop(&cls->mag);
+                --cls->mag_cnt;
+                yf_tc_span_put(cache, blk, trim);
+        }
+
+        if (cls->mag_low > cls->mag_cnt)
+                cls->mag_low = cls->mag_cnt;
+}
+
+
+//give back the blocks not used since last scavenge
+static void yf_tc_scavenge(yf_tc_cache_t* cache)
+{
+        yf_u32_t  i1;
+        yf_tc_class_t* cls;
+
+        cache->ticks = 0;
+        yf_tc_drain_remote(cache, 1);
+
+        for (i1 = 0; i1 < YF_TC_CLASS_NUM; ++i1)
+        {
+                cls = cache->cls + i1;
+                if (cls->mag_low)
+                        yf_tc_flush(cache, i1, cls->mag_low, 1);
+                cls->mag_low = cls->mag_cnt;
+        }
+}
+
+
+static void* yf_tc_refill(yf_tc_cache_t* cache, yf_u32_t idx)
+{
+        yf_u32_t  num, batch = yf_tc_mag_max[idx] >> 1;
+        yf_tc_class_t* cls = cache->cls + idx;
+        yf_slist_part_t* blk;
+
+        if (++cache->ticks >= YF_TC_TRIM_TICKS)
+                yf_tc_scavenge(cache);
+        else
+                yf_tc_drain_remote(cache, 0);
+
+        for (num = 0; num < batch; ++num)
+        {
+                blk = yf_tc_span_get(cache, idx);
+                if (blk == NULL)
+                        break;
+                yf_slist_push(blk, &cls->mag);
+        }
+
+        CHECK_RV(num == 0, NULL);
+
+        cls->mag_cnt = num - 1;
+        cls->mag_low = 0;
+        return yf_slist_pop(&cls->mag);
+}
+
+
+static void yf_tc_trim_cache(yf_tc_cache_t* cache)
+{
+        yf_u32_t  i1;
+        yf_tc_class_t* cls;
+        yf_tc_span_t* span;
+        yf_list_part_t* pos, *n;
+
+        yf_tc_drain_remote(cache, 1);
+
+        for (i1 = 0; i1 < YF_TC_CLASS_NUM; ++i1)
+        {
+                cls = cache->cls + i1;
+                yf_tc_flush(cache, i1, cls->mag_cnt, 1);
+
+                //the kept last ones
+                if (yf_list_empty(&cls->spans))
+                        continue;
+
+                yf_list_for_each_safe(pos, n, &cls->spans)
+                {
+                        span = yf_list_entry(pos, yf_tc_span_t, linker);
+                        if (span->used == 0)
+                                yf_tc_span_release(cache, span);
+                }
+        }
+        cache->ticks = 0;
+}
+
+
+void yf_tc_trim(void)
+{
+        yf_tc_cache_t* cache = yf_tc_self();
+        if (cache)
+                yf_tc_trim_cache(cache);
+}
+
+
+void yf_tc_get_stat(yf_tc_stat_t* stat)
+{
+        yf_u32_t  i1;
+        yf_tc_cache_t* cache = yf_tc_self();
+
+        yf_memzero(stat, sizeof(yf_tc_stat_t));
+        if (cache == NULL)
+                return;
+
+        stat->span_num = cache->span_num;
+        for (i1 = 0; i1 < YF_TC_CLASS_NUM; ++i1)
+        {
+                stat->cached_num += cache->cls[i1].mag_cnt;
+                stat->cached_bytes += (size_t)cache->cls[i1].mag_cnt * yf_tc_cls_size[i1];
+        }
+}
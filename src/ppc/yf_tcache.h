@@ -0,0 +1,46 @@
+#ifndef _YF_TCACHE_H_20261019_H
+#define _YF_TCACHE_H_20261019_H
+
+#include <base_struct/yf_core.h>
+#include <ppc/yf_header.h>
+
+/*
+* per thread caching allocator, a thread allocs and frees its own blocks
+* without any lock; each size class keeps a magazine of free blocks,
+* refilled from (and flushed back to) 64k spans owned by the thread
+* blocks freed by other threads go to the owner's remote free stack (cas),
+* drained by the owner when its magazine runs empty or on trim
+* magazine blocks left unused between two trims are given back to their
+* spans, empty spans are given back to the system, a trim runs every
+* YF_TC_TRIM_TICKS slow path calls, or call yf_tc_trim
+* caches of exited threads are adopted by new threads
+*/
+
+#define YF_TC_MAX_SIZE  8192
+#define YF_TC_TRIM_TICKS  256
+
+//size > YF_TC_MAX_SIZE go to the system directly
+void* yf_tc_alloc(size_t size);
+void* yf_tc_calloc(size_t size);
+
+//may be called by any thread
+void  yf_tc_free(void* p);
+
+//usable size of a yf_tc_alloc block
+size_t  yf_tc_size(void* p);
+
+//give back all cached blocks and empty spans of the calling thread
+void  yf_tc_trim(void);
+
+typedef struct
+{
+        yf_u32_t  span_num;
+        yf_u32_t  cached_num;
+        size_t  cached_bytes;
+}
+yf_tc_stat_t;
+
+//of the calling thread, all 0 if it never alloc
+void  yf_tc_get_stat(yf_tc_stat_t* stat);
+
+#endif
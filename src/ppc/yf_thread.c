@@ -1,6 +1,14 @@
 #include <ppc/yf_header.h>
 #include <base_struct/yf_core.h>
 
+#ifdef  __linux__
+#include <sys/syscall.h>
+#endif
+
+#ifdef  HAVE_LINUX_MEMPOLICY_H
+#include <linux/mempolicy.h>
+#endif
+
 /*
 * nthreads not include main thread, 
 * and if YF_THREADS disabled, then max_threads=1(for log thread)
@@ -316,3 +324,112 @@ yf_cond_signal(yf_cond_t *cv, yf_log_t *log)
 
         return YF_OK;
 }
+
+
+/*
+* raw syscalls, cpu_set_t macros need _GNU_SOURCE
+*/
+#define YF_BITS_PER_LONG (8 * sizeof(unsigned long))
+
+yf_int_t
+yf_bind_cpus(const char* cpus, yf_log_t *log)
+{
+#ifdef  SYS_sched_setaffinity
+        unsigned long  mask[YF_MAX_BIND_CPUS / YF_BITS_PER_LONG];
+        unsigned long  first, last;
+        const char* pos = cpus;
+        char* end;
+
+        yf_memzero(mask, sizeof(mask));
+
+        while (*pos)
+        {
+                first = strtoul(pos, &end, 10);
+                if (end == pos)
+                        goto invalid;
+
+                last = first;
+                if (*end == '-')
+                {
+                        pos = end + 1;
+                        last = strtoul(pos, &end, 10);
+                        if (end == pos)
+                                goto invalid;
+                }
+                if (first > last || last >= YF_MAX_BIND_CPUS)
+                        goto invalid;
+
+                for ( ; first <= last; ++first)
+                        mask[first / YF_BITS_PER_LONG] |= 1UL << (first % YF_BITS_PER_LONG);
+
+                if (*end == ',' && *(end + 1))
+                        ++end;
+                else if (*end)
+                        goto invalid;
+                pos = end;
+        }
+
+        //pid 0, the calling thread
+        if (syscall(SYS_sched_setaffinity, 0, sizeof(mask), mask) != 0)
+        {
+                yf_log_error(YF_LOG_WARN, log, yf_errno, "bind cpus=%s failed", cpus);
+                return YF_ERROR;
+        }
+
+        yf_log_debug1(YF_LOG_DEBUG, log, 0, "bind cpus=%s", cpus);
+        return YF_OK;
+
+invalid:
+        yf_log_error(YF_LOG_ERR, log, 0, "invalid cpu list=%s", cpus);
+        return YF_ERROR;
+#else
+        yf_log_error(YF_LOG_WARN, log, 0, "bind cpus not supported");
+        return YF_ERROR;
+#endif
+}
+
+
+yf_int_t
+yf_cur_numa_node(void)
+{
+#ifdef  SYS_getcpu
+        unsigned  cpu, node;
+
+        if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+                return node;
+#endif
+        return -1;
+}
+
+
+yf_int_t
+yf_prefer_numa_node(void* addr, size_t size
+                , yf_int_t node, yf_log_t *log)
+{
+#if defined(SYS_mbind) && defined(HAVE_LINUX_MEMPOLICY_H)
+        unsigned long  nodemask;
+        char* start = yf_align_ptr(addr, yf_pagesize);
+        char* end = (char*)(((yf_uint_ptr_t)addr + size) & ~((yf_uint_ptr_t)yf_pagesize - 1));
+
+        if (node < 0 || node >= (yf_int_t)YF_BITS_PER_LONG || end <= start)
+                return YF_AGAIN;
+
+        nodemask = 1UL << node;
+
+        //preferred, not bind, so still ok if the node run out of mem
+        //maxnode is bits + 1, the kernel drop the last one
+        if (syscall(SYS_mbind, start, end - start, MPOL_PREFERRED, 
+                        &nodemask, YF_BITS_PER_LONG + 1, MPOL_MF_MOVE) != 0)
+        {
+                yf_log_error(YF_LOG_WARN, log, yf_errno, 
+                                "mbind %p size=%d to node=%d failed", start, end - start, node);
+                return YF_ERROR;
+        }
+
+        yf_log_debug3(YF_LOG_DEBUG, log, 0, "mbind %p size=%d to node=%d", 
+                        start, end - start, node);
+        return YF_OK;
+#else
+        return YF_AGAIN;
+#endif
+}
@@ -119,5 +119,21 @@ yf_int_t yf_cond_signal(yf_cond_t *cv, yf_log_t *log);
 
 extern yf_tid_t  yf_main_thread_id;
 
+/*
+* affinity of the calling thread (the whole proc if single thread)
+* cpus is a list like "0-3,8", cpu num < YF_MAX_BIND_CPUS
+*/
+#define YF_MAX_BIND_CPUS 1024
+
+yf_int_t yf_bind_cpus(const char* cpus, yf_log_t *log);
+
+//numa node of the cpu running on now, -1 if unknown
+yf_int_t yf_cur_numa_node(void);
+
+//prefer node for the whole pages in [addr, addr+size), mapped pages moved
+//if just mapped by this proc; ret YF_AGAIN if not supported
+yf_int_t yf_prefer_numa_node(void* addr, size_t size
+                , yf_int_t node, yf_log_t *log);
+
 
 #endif /* _YF_THREAD_H_INCLUDED_ */
@@ -31,6 +31,49 @@ ___YF_THREAD yf_time_data_t  yf_time_data_ins;
 #endif
 
 static void yf_update_log_time(yf_log_t* log);
+static yf_int_t yf_update_local_time(yf_time_reset_handler handle
+                , void* data, yf_log_t* log);
+
+/*
+* seqlock protected shared time, seq odd means writer in progress
+*/
+typedef struct
+{
+        yf_atomic_t  seq;
+        yf_times_t  now_times;
+        //coarse monotonic ms of the last publish
+        yf_atomic_t  coarse_ms;
+        char           log_buf[YF_TIME_BUF_LEN + 1];
+}
+yf_time_share_data_t;
+
+typedef struct
+{
+        yf_time_share_data_t  data ____cacheline_aligned;
+        
+        yf_lock_t  lock ____cacheline_aligned;
+        volatile yf_int_t  enabled;
+        volatile yf_int_t  publisher_run;
+        yf_tid_t  publisher_tid;
+        yf_u32_t  interval_ms;
+}
+yf_time_share_t;
+
+static yf_time_share_t  yf_time_share = {.lock = YF_LOCK_INITIALIZER};
+
+#define YF_TIME_SHARE_FRESH_MS  1
+
+//vdso clock, no syscall, 0 if not supported (never fresh)
+static yf_atomic_uint_t yf_time_share_coarse_ms(void)
+{
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC_COARSE)
+        struct timespec ts;
+        
+        if (clock_gettime(CLOCK_MONOTONIC_COARSE, &ts) == 0)
+                return (yf_atomic_uint_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000 + 1;
+#endif
+        return  0;
+}
 
 #define yf_utime_to_time(times, utime) do { \
         (times).tv_sec = (utime).tv_sec; \
@@ -80,7 +123,8 @@ yf_int_t  yf_init_time(yf_log_t* log)
 }
 
 
-yf_int_t  yf_update_time(yf_time_reset_handler handle, void* data, yf_log_t* log)
+static yf_int_t  yf_update_local_time(yf_time_reset_handler handle
+                , void* data, yf_log_t* log)
 {
         struct timespec ts;
         yf_time_data_t* time_data = yf_time_data;
@@ -163,7 +207,8 @@ yf_int_t  yf_init_time(yf_log_t* log)
         return  YF_OK;
 }
 
-yf_int_t  yf_update_time(yf_time_reset_handler handle, void* data, yf_log_t* log)
+static yf_int_t  yf_update_local_time(yf_time_reset_handler handle
+                , void* data, yf_log_t* log)
 {
         yf_utime_t  now_time;
         yf_utime_t*  wall_utime = &yf_now_times.wall_utime;
@@ -206,6 +251,161 @@ yf_int_t  yf_update_time(yf_time_reset_handler handle, void* data, yf_log_t* log
 #endif
 
 
+static void yf_time_share_publish(yf_time_data_t* time_data)
+{
+        yf_time_share_data_t* share = &yf_time_share.data;
+
+        ++share->seq;
+        yf_memory_barrier();
+
+        share->now_times = time_data->now_times;
+        yf_memcpy(share->log_buf, time_data->log_time.data, YF_TIME_BUF_LEN);
+        share->coarse_ms = yf_time_share_coarse_ms();
+
+        yf_memory_barrier();
+        ++share->seq;
+}
+
+
+//the snapshot is fresh if published in the same coarse tick (or 1ms)
+static yf_int_t yf_time_share_fresh(void)
+{
+        yf_atomic_uint_t  now_ms = yf_time_share_coarse_ms();
+
+        return  now_ms && now_ms - yf_time_share.data.coarse_ms 
+                        < YF_TIME_SHARE_FRESH_MS;
+}
+
+
+static yf_int_t yf_time_share_snapshot(yf_time_data_t* time_data)
+{
+        yf_time_share_data_t* share = &yf_time_share.data;
+        yf_atomic_t  seq;
+
+        yf_init_timedata(time_data);
+
+        for ( ;; )
+        {
+                seq = share->seq;
+                if (unlikely(seq == 0))
+                        return YF_AGAIN;
+                
+                if (unlikely(seq & 1))
+                {
+                        yf_cpu_pause();
+                        continue;
+                }
+                yf_memory_barrier();
+
+                time_data->now_times = share->now_times;
+                yf_memcpy(time_data->log_time.data, share->log_buf, YF_TIME_BUF_LEN);
+
+                yf_memory_barrier();
+                if (likely(seq == share->seq))
+                        return YF_OK;
+        }
+}
+
+
+yf_int_t  yf_update_time(yf_time_reset_handler handle, void* data, yf_log_t* log)
+{
+        yf_int_t  rc;
+        yf_time_data_t* time_data;
+        
+        if (likely(!yf_time_share.enabled))
+                return yf_update_local_time(handle, data, log);
+
+        time_data = yf_time_data;
+
+        if (yf_time_share.publisher_run || yf_time_share_fresh()
+                        || !yf_trylock(&yf_time_share.lock))
+        {
+                if (yf_time_share_snapshot(time_data) == YF_OK)
+                        return YF_OK;
+                
+                //not published yet, update self
+                return yf_update_local_time(handle, data, log);
+        }
+
+        rc = yf_update_local_time(handle, data, log);
+        if (rc == YF_OK)
+                yf_time_share_publish(time_data);
+        
+        yf_unlock(&yf_time_share.lock);
+        return rc;
+}
+
+
+#if (YF_THREADS)
+
+static yf_thread_value_t yf_time_publisher_exe(void* arg)
+{
+        yf_time_data_t* time_data = yf_time_data;
+        yf_log_t* log = (yf_log_t*)arg;
+
+        while (yf_time_share.publisher_run)
+        {
+                yf_lock(&yf_time_share.lock);
+                if (yf_update_local_time(NULL, NULL, log) == YF_OK)
+                        yf_time_share_publish(time_data);
+                yf_unlock(&yf_time_share.lock);
+
+                yf_usleep(yf_time_share.interval_ms * 1000);
+        }
+        return  NULL;
+}
+
+#endif
+
+
+yf_int_t yf_time_share_enable(yf_u32_t interval_ms, yf_log_t* log)
+{
+        if (yf_time_share.enabled)
+                return  YF_OK;
+        
+        yf_time_share.interval_ms = interval_ms;
+
+        //publish the first snapshot before any reader come
+        yf_lock(&yf_time_share.lock);
+        if (yf_update_local_time(NULL, NULL, log) == YF_OK)
+                yf_time_share_publish(yf_time_data);
+        yf_unlock(&yf_time_share.lock);
+
+#if (YF_THREADS)
+        if (interval_ms)
+        {
+                yf_time_share.publisher_run = 1;
+                if (yf_create_thread(&yf_time_share.publisher_tid
+                                , yf_time_publisher_exe, log, log) != 0)
+                {
+                        yf_log_error(YF_LOG_WARN, log, 0, 
+                                        "create time publisher failed, use trylock mode");
+                        yf_time_share.publisher_run = 0;
+                }
+        }
+#endif
+
+        yf_time_share.enabled = 1;
+        return  YF_OK;
+}
+
+
+void yf_time_share_disable()
+{
+#if (YF_THREADS)
+        void* ptr = NULL;
+        
+        //wait the publisher exit, or a quick enable again will run two
+        if (yf_time_share.publisher_run)
+        {
+                yf_time_share.publisher_run = 0;
+                yf_thread_join(yf_time_share.publisher_tid, &ptr);
+        }
+#endif
+        yf_time_share.enabled = 0;
+}
+
+
 void yf_localtime(time_t s, yf_stm_t *tm)
 {
 #if (HAVE_LOCALTIME_R)
@@ -98,5 +98,16 @@ void yf_localtime(time_t s, yf_stm_t *tm);
 
 yf_int_t yf_real_walltime(yf_time_t* time);
 
+/*
+* shared time mode
+* one thread publish now_times and log time to a seqlock protected global,
+* other threads just copy a snapshot in yf_update_time, no time syscall.
+* if publisher not started, a snapshot published in the same coarse clock
+* tick is taken as is, else the thread who win the trylock do the update.
+* interval_ms == 0 means dont start publisher thread, only trylock mode
+*/
+yf_int_t yf_time_share_enable(yf_u32_t interval_ms, yf_log_t* log);
+void yf_time_share_disable();
+
 #endif
 
@@ -0,0 +1,33 @@
+#!/bin/bash
+#bridge benchmark matrix, one json line per case on stdout
+#env: TASKS (default 100000), WINDOW (default 64), SIZES, CHILDS, DISPATCHS
+TASKS=${TASKS:-100000}
+WINDOW=${WINDOW:-64}
+SIZES=${SIZES:-"64 1024 16384"}
+CHILDS=${CHILDS:-"1 2 4"}
+DISPATCHS=${DISPATCHS:-"idle hash least_load two_choice jump_hash"}
+
+mkdir -p dir
+
+for creator in et bt pp pb
+do
+        #bt childs share one tq, dispatch not used
+        dispatchs=$DISPATCHS
+        if [ $creator = bt ]; then
+                dispatchs=idle
+        elif [ $creator = et ]; then
+                dispatchs="$DISPATCHS steal"
+        fi
+
+        for size in $SIZES
+        do
+                for childs in $CHILDS
+                do
+                        for dispatch in $dispatchs
+                        do
+                                ./yf_bridge_bench -c $creator -s $size -n $childs \
+                                        -d $dispatch -t $TASKS -w $WINDOW
+                        done
+                done
+        done
+done
@@ -438,6 +438,36 @@ TEST_F(BaseTest, Hash)
         test_hash();
 }
 
+TEST_F(BaseTest, JumpHash)
+{
+        yf_int_t  moved = 0, cnt[11] = {0};
+        yf_int_t  b10, b11;
+
+        for (yf_u32_t key = 0; key < 110000; ++key)
+        {
+                b10 = yf_jump_hash(key, 10);
+                b11 = yf_jump_hash(key, 11);
+                ASSERT_TRUE(b10 >= 0 && b10 < 10);
+                ASSERT_TRUE(b11 >= 0 && b11 < 11);
+                ++cnt[b11];
+
+                //key move only to the new bucket
+                if (b10 != b11)
+                {
+                        ASSERT_EQ(b11, 10);
+                        ++moved;
+                }
+        }
+
+        ASSERT_EQ(moved, cnt[10]);
+        for (int i = 0; i < 11; ++i)
+        {
+                ASSERT_GT(cnt[i], 9000);
+                ASSERT_LT(cnt[i], 11000);
+        }
+        ASSERT_EQ(yf_jump_hash(12345, 1), 0);
+}
+
 
 /*
 * node pool
@@ -595,6 +625,80 @@ TEST_F(BaseTest, HNodePool)
 }
 
 
+/*
+* huge pages
+*/
+TEST_F(BaseTest, HugePage)
+{
+        yf_uint_t  mode = yf_hpage_mode;
+        size_t  size = YF_HPAGE_SIZE * 2 + 100;
+        char* p;
+
+        //off or small, from heap
+        yf_hpage_mode = YF_HPAGE_OFF;
+        p = (char*)yf_page_alloc(size, _log);
+        ASSERT_TRUE(p != NULL);
+        ASSERT_EQ(yf_page_type(p), YF_PAGE_HEAP);
+        ASSERT_TRUE(p[0] == 0 && p[size - 1] == 0);
+        yf_page_free(p);
+
+        yf_hpage_mode = YF_HPAGE_ON;
+        p = (char*)yf_page_alloc(1024, _log);
+        ASSERT_EQ(yf_page_type(p), YF_PAGE_HEAP);
+        yf_page_free(p);
+
+        //hugetlb if reserved, else thp (or normal pages if no thp)
+        for (int i = 0; i < 2; ++i)
+        {
+                yf_hpage_mode = i ? YF_HPAGE_THP : YF_HPAGE_ON;
+                p = (char*)yf_page_alloc(size, _log);
+                ASSERT_TRUE(p != NULL);
+
+                yf_int_t  type = yf_page_type(p);
+                printf("hpage mode=%d, page type=%ld\n", (int)yf_hpage_mode, (long)type);
+                ASSERT_TRUE(type != YF_PAGE_HEAP);
+                if (i)
+                        ASSERT_TRUE(type != YF_PAGE_HUGETLB);
+
+                ASSERT_EQ(((yf_uint_ptr_t)p) & (YF_HPAGE_SIZE - 1), 0);
+                ASSERT_TRUE(p[0] == 0 && p[size - 1] == 0);
+                memset(p, 1, size);
+                yf_page_free(p);
+        }
+
+        //a whole huge page asked, the mem starts on its boundary, all usable
+        yf_hpage_mode = YF_HPAGE_THP;
+        p = (char*)yf_page_alloc(YF_HPAGE_SIZE, _log);
+        ASSERT_TRUE(p != NULL);
+        ASSERT_NE(yf_page_type(p), YF_PAGE_HEAP);
+        ASSERT_EQ(((yf_uint_ptr_t)p) & (YF_HPAGE_SIZE - 1), 0);
+        memset(p, 1, YF_HPAGE_SIZE);
+        yf_page_free(p);
+
+        //big pools and node pools on the pages
+        yf_pool_t* pool = yf_create_pool(YF_HPAGE_MIN_SIZE, _log);
+        ASSERT_TRUE(pool != NULL);
+        ASSERT_NE(yf_page_type(pool), YF_PAGE_HEAP);
+        for (int i = 0; i < 4096; ++i)
+        {
+                p = (char*)yf_palloc(pool, 1024);
+                ASSERT_TRUE(p != NULL);
+                p[1023] = 1;
+        }
+        yf_destroy_pool(pool);
+
+        yf_hnpool_t* hnp = yf_hnpool_create(128, 20000, 4, _log);
+        ASSERT_TRUE(hnp != NULL);
+        ASSERT_NE(yf_page_type(hnp), YF_PAGE_HEAP);
+
+        yf_u64_t  id;
+        for (int i = 0; i < 60000; ++i)
+                ASSERT_TRUE(yf_hnpool_alloc(hnp, &id, _log) != NULL);
+
+        yf_hpage_mode = mode;
+}
+
+
 /*
 * slab pool
 */
@@ -870,8 +974,10 @@ TEST_F_INIT(BaseTest, List);
 TEST_F_INIT(BaseTest, Rbtree);
 TEST_F_INIT(BaseTest, StringLog);
 TEST_F_INIT(BaseTest, Hash);
+TEST_F_INIT(BaseTest, JumpHash);
 TEST_F_INIT(BaseTest, NodePool);
 TEST_F_INIT(BaseTest, HNodePool);
+TEST_F_INIT(BaseTest, HugePage);
 TEST_F_INIT(BaseTest, SlabPool);
 TEST_F_INIT(BaseTest, IdSeed);
 TEST_F_INIT(BaseTest, CircularBuf);
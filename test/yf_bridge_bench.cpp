@@ -0,0 +1,379 @@
+/*
+* bridge benchmark, one case a run, result printed as a json line
+* usage: yf_bridge_bench [-c et|bt|pp|pb] [-s task_size] [-n child_num]
+*               [-d idle|hash|steal|least_load|two_choice|jump_hash]
+*               [-t tasks] [-w window] [-b res_batch_num] [-p child_spin_us]
+*               [-l max_secs]
+* et: evt drived child threads, bt: blocked child threads (shared tq),
+* pp: evt drived child procs, pb: blocked child procs (futex wake);
+* window is the in flight tasks of the parent
+* see bridge_bench.sh for the whole matrix
+*/
+#include <vector>
+#include <algorithm>
+
+extern "C" {
+#include <ppc/yf_header.h>
+#include <base_struct/yf_core.h>
+#include <mio_driver/yf_event.h>
+#include <bridge/yf_bridge.h>
+#include <log_ext/yf_log_file.h>
+}
+
+//res carry back the send time
+#define BENCH_RES_SIZE 16
+
+struct BenchCase
+{
+        const char*  creator;
+        const char*  dispatch;
+        size_t  task_size;
+        yf_uint_t  child_num;
+        yf_u64_t  tasks;
+        yf_uint_t  window;
+        yf_uint_t  res_batch_num;
+        yf_uint_t  child_spin_us;
+        yf_uint_t  max_secs;
+};
+
+struct BenchRun
+{
+        yf_bridge_t*  bridge;
+        yf_evt_driver_t*  driver;
+        char*  task;
+
+        yf_u64_t  sent;
+        yf_u64_t  received;
+        yf_u64_t  errors;
+        yf_u64_t  push_fail;
+        yf_u64_t  start_ns;
+        yf_u64_t  end_ns;
+        std::vector<yf_u64_t>  lat_ns;
+};
+
+static BenchCase  g_case = {"et", "idle", 64, 2, 200000, 64, 0, 0, 60};
+static BenchRun  g_run;
+static yf_log_t*  g_log;
+
+
+static yf_u64_t  bench_now_ns()
+{
+        struct timespec  ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (yf_u64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+
+/*
+* child side
+*/
+static void on_bench_task(yf_bridge_t* bridge
+                , void* task, size_t len, yf_u64_t id, yf_log_t* log)
+{
+        yf_send_task_res(bridge, task, yf_min(len, BENCH_RES_SIZE), id,
+                        YF_TASK_SUCESS, log);
+}
+
+
+static void  bench_evt_child(yf_bridge_t* bridge, yf_log_t* log)
+{
+        yf_evt_driver_init_t driver_init = {0, 128, 64, log, YF_DEFAULT_DRIVER_CB};
+        yf_evt_driver_t* driver = yf_evt_driver_create(&driver_init);
+        assert(driver);
+
+        yf_int_t ret = yf_attach_bridge(bridge, driver, on_bench_task, log);
+        assert(ret == YF_OK);
+
+        yf_evt_driver_start(driver);
+}
+
+
+static void  bench_child_proc(void* data, yf_log_t* log)
+{
+        bench_evt_child((yf_bridge_t*)data, log);
+}
+
+
+static yf_thread_value_t  bench_evt_thread(void* arg)
+{
+        bench_evt_child((yf_bridge_t*)arg, g_log);
+        return NULL;
+}
+
+
+static void  bench_blocked_child(yf_bridge_t* bridge, yf_log_t* log)
+{
+        yf_int_t ret = yf_attach_bridge(bridge, NULL, on_bench_task, log);
+        assert(ret == YF_OK);
+
+        while (1)
+                yf_poll_task(bridge, log);
+}
+
+
+static void  bench_blocked_child_proc(void* data, yf_log_t* log)
+{
+        bench_blocked_child((yf_bridge_t*)data, log);
+}
+
+
+static yf_thread_value_t  bench_blocked_thread(void* arg)
+{
+        bench_blocked_child((yf_bridge_t*)arg, g_log);
+        return NULL;
+}
+
+
+/*
+* parent side
+*/
+static void  bench_send(BenchRun* run)
+{
+        yf_u64_t  id;
+
+        while (run->sent < g_case.tasks
+                        && run->sent - run->received < g_case.window)
+        {
+                *(yf_u64_t*)run->task = bench_now_ns();
+
+                id = yf_send_task(run->bridge, run->task, g_case.task_size,
+                                (yf_u32_t)run->sent, NULL, 0, g_log);
+                //queue full, go on after some res back
+                if (id == (yf_u64_t)-1)
+                {
+                        ++run->push_fail;
+                        return;
+                }
+                ++run->sent;
+        }
+}
+
+
+static void on_bench_res(yf_bridge_t* bridge
+                , void* task_res, size_t len, yf_u64_t id
+                , yf_int_t status, void* data, yf_log_t* log)
+{
+        yf_u64_t  now = bench_now_ns();
+
+        ++g_run.received;
+        if (status != YF_TASK_SUCESS || len < sizeof(yf_u64_t))
+                ++g_run.errors;
+        else
+                g_run.lat_ns.push_back(now - *(yf_u64_t*)task_res);
+
+        if (g_run.received == g_case.tasks)
+        {
+                g_run.end_ns = now;
+                yf_evt_driver_stop(g_run.driver);
+                return;
+        }
+
+        bench_send(&g_run);
+}
+
+
+//guard, and resend if all pushes failed with nothing in flight
+static void on_bench_timer(yf_tm_evt_t* evt, yf_time_t* start)
+{
+        yf_time_t  tm = {0, 100};
+
+        if (bench_now_ns() - g_run.start_ns > g_case.max_secs * 1000000000ULL)
+        {
+                g_run.end_ns = bench_now_ns();
+                yf_evt_driver_stop(g_run.driver);
+                return;
+        }
+
+        if (g_run.sent == g_run.received)
+                bench_send(&g_run);
+        yf_register_tm_evt(evt, &tm);
+}
+
+
+static void on_bench_child_exit(yf_sig_event_t* sig_evt)
+{
+        yf_process_get_status(sig_evt->log);
+}
+
+
+static yf_u64_t  bench_percentile(std::vector<yf_u64_t>& lat, double pct)
+{
+        if (lat.empty())
+                return 0;
+        size_t  index = (size_t)(lat.size() * pct);
+        return lat[yf_min(index, lat.size() - 1)];
+}
+
+
+static yf_int_t  bench_dispatch_type(const char* dispatch)
+{
+        static const char* names[] = {NULL, "hash", "idle", "steal",
+                        "least_load", "two_choice", "jump_hash"};
+
+        for (size_t i = 1; i < YF_ARRAY_SIZE(names); ++i)
+        {
+                if (strcmp(names[i], dispatch) == 0)
+                        return i;
+        }
+        return -1;
+}
+
+
+static int  bench_run()
+{
+        yf_bridge_cxt_t  ctx;
+        yf_int_t  dispatch = bench_dispatch_type(g_case.dispatch);
+        yf_int_t  is_proc = strcmp(g_case.creator, "pp") == 0
+                        || strcmp(g_case.creator, "pb") == 0;
+        yf_int_t  blocked = strcmp(g_case.creator, "bt") == 0
+                        || strcmp(g_case.creator, "pb") == 0;
+
+        if (dispatch < 0 || (!is_proc && !blocked && strcmp(g_case.creator, "et"))
+                        || g_case.task_size < sizeof(yf_u64_t))
+        {
+                fprintf(stderr, "bad creator=%s or dispatch=%s or task_size=%d\n",
+                                g_case.creator, g_case.dispatch, (int)g_case.task_size);
+                return 1;
+        }
+
+        yf_memzero_st(ctx);
+        ctx.parent_ins_type = YF_BRIDGE_INS_PROC;
+        ctx.child_ins_type = is_proc ? YF_BRIDGE_INS_PROC : YF_BRIDGE_INS_THREAD;
+        ctx.parent_poll_type = YF_BRIDGE_EVT_DRIVED;
+        ctx.child_poll_type = blocked ? YF_BRIDGE_BLOCKED : YF_BRIDGE_EVT_DRIVED;
+        ctx.task_dispatch_type = dispatch;
+        if (is_proc)
+                ctx.exec_func = blocked ? (void*)bench_blocked_child_proc
+                                : (void*)bench_child_proc;
+        else
+                ctx.exec_func = blocked ? (void*)bench_blocked_thread
+                                : (void*)bench_evt_thread;
+        ctx.child_num = g_case.child_num;
+        ctx.max_task_size = g_case.task_size + 64;
+        ctx.max_task_num = g_case.window * 2 + 1024;
+        ctx.queue_capacity = yf_max(1024 * 1024,
+                        8 * g_case.window * yf_align_mem(ctx.max_task_size));
+        ctx.res_batch_num = g_case.res_batch_num;
+        ctx.child_spin_us = g_case.child_spin_us;
+
+        //proc tasks take a protect timer each
+        yf_evt_driver_init_t driver_init = {0, 128, 
+                        (yf_u32_t)ctx.max_task_num + 64, g_log, YF_DEFAULT_DRIVER_CB};
+        g_run.driver = yf_evt_driver_create(&driver_init);
+        assert(g_run.driver);
+
+        yf_sig_event_t  sig_child_evt;
+        yf_memzero_st(sig_child_evt);
+        sig_child_evt.signo = SIGCHLD;
+        sig_child_evt.sig_evt_handler = on_bench_child_exit;
+        yf_register_singal_evt(g_run.driver, &sig_child_evt, g_log);
+
+        g_run.bridge = yf_bridge_create(&ctx, g_log);
+        if (g_run.bridge == NULL)
+        {
+                fprintf(stderr, "create bridge failed\n");
+                return 1;
+        }
+        if (yf_attach_res_bridge(g_run.bridge, g_run.driver, on_bench_res, g_log) != YF_OK)
+        {
+                fprintf(stderr, "attach res bridge failed\n");
+                return 1;
+        }
+
+        g_run.task = (char*)yf_alloc(g_case.task_size);
+        yf_memset(g_run.task, 'b', g_case.task_size);
+        g_run.lat_ns.reserve(g_case.tasks);
+
+        yf_tm_evt_t* tm_evt;
+        yf_alloc_tm_evt(g_run.driver, &tm_evt, g_log);
+        tm_evt->timeout_handler = on_bench_timer;
+        yf_time_t  tm = {0, 100};
+        yf_register_tm_evt(tm_evt, &tm);
+
+        g_run.start_ns = bench_now_ns();
+        bench_send(&g_run);
+        yf_evt_driver_start(g_run.driver);
+
+        std::sort(g_run.lat_ns.begin(), g_run.lat_ns.end());
+        double  secs = (g_run.end_ns - g_run.start_ns) / 1e9;
+
+        printf("{\"creator\":\"%s\",\"dispatch\":\"%s\",\"task_size\":%d,"
+                        "\"child_num\":%d,\"window\":%d,\"res_batch_num\":%d,\"child_spin_us\":%d,"
+                        "\"tasks\":%llu,\"received\":%llu,\"errors\":%llu,"
+                        "\"push_fail\":%llu,\"done\":%s,\"secs\":%.3f,\"tps\":%.0f,"
+                        "\"p50_us\":%.1f,\"p99_us\":%.1f,\"p999_us\":%.1f,\"max_us\":%.1f}\n",
+                        g_case.creator, g_case.dispatch, (int)g_case.task_size,
+                        g_case.child_num, g_case.window, g_case.res_batch_num,
+                        g_case.child_spin_us,
+                        (unsigned long long)g_case.tasks,
+                        (unsigned long long)g_run.received,
+                        (unsigned long long)g_run.errors,
+                        (unsigned long long)g_run.push_fail,
+                        g_run.received == g_case.tasks ? "true" : "false",
+                        secs, secs > 0 ? g_run.received / secs : 0,
+                        bench_percentile(g_run.lat_ns, 0.5) / 1e3,
+                        bench_percentile(g_run.lat_ns, 0.99) / 1e3,
+                        bench_percentile(g_run.lat_ns, 0.999) / 1e3,
+                        bench_percentile(g_run.lat_ns, 1) / 1e3);
+        fflush(stdout);
+
+        //child procs got SIGTERM, child threads just go with the proc
+        if (is_proc)
+                yf_bridge_destory(g_run.bridge, g_log);
+        return g_run.received == g_case.tasks ? 0 : 2;
+}
+
+
+int main(int argc, char **argv)
+{
+        int  opt;
+
+        while ((opt = getopt(argc, argv, "c:s:n:d:t:w:b:p:l:")) != -1)
+        {
+                switch (opt)
+                {
+                case 'c': g_case.creator = optarg; break;
+                case 's': g_case.task_size = strtoul(optarg, NULL, 10); break;
+                case 'n': g_case.child_num = atoi(optarg); break;
+                case 'd': g_case.dispatch = optarg; break;
+                case 't': g_case.tasks = strtoull(optarg, NULL, 10); break;
+                case 'w': g_case.window = atoi(optarg); break;
+                case 'b': g_case.res_batch_num = atoi(optarg); break;
+                case 'p': g_case.child_spin_us = atoi(optarg); break;
+                case 'l': g_case.max_secs = atoi(optarg); break;
+                default:
+                        fprintf(stderr, "usage: %s [-c et|bt|pp|pb] [-s task_size] [-n child_num] "
+                                        "[-d dispatch] [-t tasks] [-w window] "
+                                        "[-b res_batch_num] [-p child_spin_us] [-l max_secs]\n", argv[0]);
+                        return 1;
+                }
+        }
+
+        yf_pagesize = getpagesize();
+        yf_cpuinfo();
+
+        yf_int_t ret = yf_init_threads(g_case.child_num + 4, 1024 * 1024, 1, NULL);
+        assert(ret == YF_OK);
+
+        yf_log_file_init(NULL);
+        yf_log_file_init_ctx_t log_file_init = {1024*128, 1024*1024*64, 8,
+                        "dir/bridge_bench.log", "%t [%f:%l]-[%v]<%p#%d>"};
+
+        g_log = yf_log_open(YF_LOG_WARN, 8192, (void*)&log_file_init);
+        assert(g_log);
+
+        yf_init_bit_indexs();
+        yf_init_time(g_log);
+        yf_update_time(NULL, NULL, g_log);
+
+        ret = yf_strerror_init();
+        assert(ret == YF_OK);
+        ret = yf_save_argv(g_log, argc, argv);
+        assert(ret == YF_OK);
+        ret = yf_init_setproctitle(g_log);
+        assert(ret == YF_OK);
+        ret = yf_init_processs(g_log);
+        assert(ret == YF_OK);
+
+        return bench_run();
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <list>
+#include <vector>
 
 extern "C" {
 #include <ppc/yf_header.h>
@@ -115,6 +116,1259 @@ TEST_F(BridgeTestor, TaskQueue)
 }
 
 
+#define TQ_BATCH_TASKS 20000
+#define TQ_BATCH_NUM 16
+
+yf_thread_value_t tq_batch_producer(void* arg)
+{
+        yf_task_queue_t* tq = (yf_task_queue_t*)arg;
+        yf_task_item_t  items[TQ_BATCH_NUM];
+        yf_u32_t  seqs[TQ_BATCH_NUM];
+        yf_u32_t  seq = 0;
+        yf_int_t  i1, num, pushed;
+
+        while (seq < TQ_BATCH_TASKS)
+        {
+                num = yf_min(TQ_BATCH_NUM, TQ_BATCH_TASKS - seq);
+                for (i1 = 0; i1 < num; ++i1)
+                {
+                        seqs[i1] = seq + i1;
+                        items[i1].task_info.id = seqs[i1];
+                        items[i1].task = (char*)(seqs + i1);
+                        //empty task sometimes
+                        items[i1].task_len = (seqs[i1] % 7) ? sizeof(yf_u32_t) : 0;
+                }
+
+                //the rest will be rebuilt next round
+                pushed = yf_task_push_batch(tq, items, num, _log);
+                seq += pushed;
+                if (pushed < num)
+                        yf_cpu_pause();
+        }
+        return NULL;
+}
+
+TEST_F(BridgeTestor, TaskQueueBatch)
+{
+        static char  tq_buf[8192];
+        yf_memzero(tq_buf, sizeof(tq_buf));
+        yf_task_queue_t* tq = yf_init_task_queue(tq_buf, sizeof(tq_buf), _log);
+
+        yf_tid_t  tid;
+        ASSERT_EQ(yf_create_thread(&tid, tq_batch_producer, tq, _log), 0);
+
+        yf_task_item_t  items[TQ_BATCH_NUM];
+        yf_u32_t  vals[TQ_BATCH_NUM];
+        yf_u32_t  expect = 0;
+
+        while (expect < TQ_BATCH_TASKS)
+        {
+                for (int i = 0; i < TQ_BATCH_NUM; ++i)
+                {
+                        items[i].task = (char*)(vals + i);
+                        items[i].task_len = sizeof(yf_u32_t);
+                }
+
+                yf_int_t  num = yf_task_pop_batch(tq, items, TQ_BATCH_NUM, _log);
+                for (int i = 0; i < num; ++i, ++expect)
+                {
+                        ASSERT_EQ(items[i].task_info.id, expect);
+                        if (expect % 7)
+                        {
+                                ASSERT_EQ(items[i].task_len, sizeof(yf_u32_t));
+                                ASSERT_EQ(vals[i], expect);
+                        }
+                        else
+                                ASSERT_EQ(items[i].task_len, 0);
+                }
+        }
+
+        void* ptr = NULL;
+        yf_thread_join(tid, &ptr);
+        ASSERT_EQ(yf_tq_buf_size(tq), 0);
+}
+
+
+TEST_F(BridgeTestor, TaskQueueZeroCopy)
+{
+        static char  tq_buf[4096];
+        yf_memzero(tq_buf, sizeof(tq_buf));
+        yf_task_queue_t* tq = yf_init_task_queue(tq_buf, sizeof(tq_buf), _log);
+
+        task_info_t  task_info;
+        char* task;
+        size_t  task_len;
+        yf_u32_t  pushed = 0, poped = 0;
+
+        //random len, so task will be put at the ring head many times
+        for (int i = 0; i < 4096; ++i)
+        {
+                while (1)
+                {
+                        size_t  len = random() % 512;
+                        task = yf_task_reserve(tq, len, _log);
+                        if (task == NULL)
+                                break;
+
+                        yf_memset(task, pushed & 0xff, len);
+                        yf_memzero_st(task_info);
+                        task_info.id = pushed++;
+                        //commit less than reserved
+                        if (pushed % 3 == 0)
+                                yf_task_commit(tq, &task_info, len / 2, _log);
+                        else
+                                yf_task_commit(tq, &task_info, len, _log);
+                }
+
+                for (int j = random() % 16; j >= 0; --j)
+                {
+                        if (yf_task_peek(tq, &task_info, &task, &task_len, _log) != YF_OK)
+                        {
+                                ASSERT_EQ(pushed, poped);
+                                break;
+                        }
+                        ASSERT_EQ(task_info.id, poped);
+                        for (size_t k = 0; k < task_len; ++k)
+                                ASSERT_EQ((yf_u8_t)task[k], poped & 0xff);
+                        yf_task_release(tq, _log);
+                        ++poped;
+                }
+
+                //copy api share the same ring
+                yf_memzero_st(task_info);
+                task_info.id = pushed;
+                char  cbuf[64];
+                yf_memset(cbuf, pushed & 0xff, sizeof(cbuf));
+                if (yf_task_push(tq, &task_info, cbuf, sizeof(cbuf), _log) == YF_OK)
+                        ++pushed;
+        }
+
+        while (yf_task_peek(tq, &task_info, &task, &task_len, _log) == YF_OK)
+        {
+                ASSERT_EQ(task_info.id, poped);
+                yf_task_release(tq, _log);
+                ++poped;
+        }
+        ASSERT_EQ(pushed, poped);
+        ASSERT_EQ(yf_tq_buf_size(tq), 0);
+}
+
+
+TEST_F(BridgeTestor, TaskQueuePark)
+{
+        static char  tq_buf[4096];
+        yf_memzero(tq_buf, sizeof(tq_buf));
+        yf_task_queue_t* tq = yf_init_task_queue(tq_buf, sizeof(tq_buf), _log);
+
+        task_info_t  task_info;
+        char  task[64];
+        size_t  task_len;
+        yf_memzero_st(task_info);
+        ASSERT_TRUE(yf_task_queue_empty(tq));
+
+        //no consumer yet, first push ring, later not
+        ASSERT_EQ(yf_task_push(tq, &task_info, task, sizeof(task), _log), YF_OK);
+        ASSERT_FALSE(yf_task_queue_empty(tq));
+        ASSERT_TRUE(yf_task_need_signal(tq));
+        ASSERT_EQ(yf_task_push(tq, &task_info, task, sizeof(task), _log), YF_OK);
+        ASSERT_FALSE(yf_task_need_signal(tq));
+
+        //consumer wake, busy, no ring
+        yf_task_unpark(tq);
+        ASSERT_EQ(yf_task_park(tq), YF_AGAIN);
+        task_len = sizeof(task);
+        ASSERT_EQ(yf_task_pop(tq, &task_info, task, &task_len, _log), YF_OK);
+        ASSERT_EQ(yf_task_push(tq, &task_info, task, sizeof(task), _log), YF_OK);
+        ASSERT_FALSE(yf_task_need_signal(tq));
+
+        while (yf_task_pop(tq, &task_info, task, &task_len, _log) == YF_OK)
+                task_len = sizeof(task);
+        ASSERT_TRUE(yf_task_queue_empty(tq));
+
+        //parked, ring once
+        ASSERT_EQ(yf_task_park(tq), YF_OK);
+        ASSERT_EQ(yf_task_push(tq, &task_info, task, sizeof(task), _log), YF_OK);
+        ASSERT_TRUE(yf_task_need_signal(tq));
+        ASSERT_FALSE(yf_task_need_signal(tq));
+}
+
+
+//owner and thief pop the same tq with consumer lock
+yf_task_queue_t* g_steal_tq;
+volatile yf_u32_t  g_steal_poped = 0;
+yf_u8_t  g_steal_seen[TQ_BATCH_TASKS];
+
+yf_u32_t  tq_steal_pop(yf_task_queue_t* tq)
+{
+        task_info_t  task_info;
+        yf_u32_t  val;
+        size_t  task_len;
+        yf_u32_t  cnt = 0;
+
+        while (g_steal_poped < TQ_BATCH_TASKS)
+        {
+                task_len = sizeof(val);
+
+                yf_task_consumer_lock(tq);
+                if (yf_task_pop(tq, &task_info, (char*)&val, &task_len, _log) == YF_OK)
+                {
+                        ++g_steal_poped;
+                        ++g_steal_seen[task_info.id];
+                        ++cnt;
+                }
+                yf_task_consumer_unlock(tq);
+        }
+        return cnt;
+}
+
+yf_thread_value_t tq_steal_thief(void* arg)
+{
+        *(yf_u32_t*)arg = tq_steal_pop(g_steal_tq);
+        return NULL;
+}
+
+TEST_F(BridgeTestor, TaskQueueSteal)
+{
+        static char  tq_buf[8192];
+        yf_memzero(tq_buf, sizeof(tq_buf));
+        yf_task_queue_t* tq = yf_init_task_queue(tq_buf, sizeof(tq_buf), _log);
+        g_steal_tq = tq;
+
+        yf_u32_t  thief_cnt = 0;
+        yf_tid_t  tid, thief_tid;
+        ASSERT_EQ(yf_create_thread(&thief_tid, tq_steal_thief, &thief_cnt, _log), 0);
+        ASSERT_EQ(yf_create_thread(&tid, tq_batch_producer, tq, _log), 0);
+
+        yf_u32_t  cnt = tq_steal_pop(tq);
+
+        void* ptr = NULL;
+        yf_thread_join(tid, &ptr);
+        yf_thread_join(thief_tid, &ptr);
+
+        ASSERT_EQ(cnt + thief_cnt, TQ_BATCH_TASKS);
+        for (int i = 0; i < TQ_BATCH_TASKS; ++i)
+                ASSERT_EQ(g_steal_seen[i], 1);
+        ASSERT_EQ(yf_tq_buf_size(tq), 0);
+}
+
+
+//producer p push ids [p * TQ_MP_TASKS, (p+1) * TQ_MP_TASKS), len varies
+#define TQ_MP_PRODUCERS 3
+#define TQ_MP_TASKS 5000
+
+yf_task_queue_t* g_mp_tq;
+
+yf_thread_value_t tq_mp_producer(void* arg)
+{
+        task_info_t  task_info;
+        yf_u64_t  vals[3];
+        yf_u32_t  no = (yf_u32_t)(yf_uint_ptr_t)arg;
+        yf_memzero_st(task_info);
+
+        for (yf_u32_t i = 0; i < TQ_MP_TASKS; )
+        {
+                task_info.id = no * TQ_MP_TASKS + i;
+                vals[0] = vals[1] = vals[2] = task_info.id;
+
+                if (yf_task_push_mp(g_mp_tq, &task_info, (char*)vals, 
+                                sizeof(yf_u64_t) * (1 + i % 3), _log) == YF_OK)
+                        ++i;
+                else
+                        yf_sched_yield();
+        }
+        return NULL;
+}
+
+TEST_F(BridgeTestor, TaskQueueMp)
+{
+        static char  tq_buf[8192];
+        yf_memzero(tq_buf, sizeof(tq_buf));
+        g_mp_tq = yf_init_task_queue(tq_buf, sizeof(tq_buf), _log);
+        yf_task_queue_set_mp(g_mp_tq);
+        //the claim position wraps too in the run
+        g_mp_tq->pos_wrap = 4 * g_mp_tq->capacity;
+
+        task_info_t  task_info;
+        yf_u64_t  vals[3];
+        size_t  task_len;
+        yf_u32_t  next[TQ_MP_PRODUCERS] = {0};
+        yf_tid_t  tids[TQ_MP_PRODUCERS];
+        yf_u32_t  cnt = 0, no;
+
+        for (no = 0; no < TQ_MP_PRODUCERS; ++no)
+                ASSERT_EQ(yf_create_thread(tids + no, tq_mp_producer, 
+                                (void*)(yf_uint_ptr_t)no, _log), 0);
+
+        //each producer's tasks in its push order, whole
+        while (cnt < TQ_MP_PRODUCERS * TQ_MP_TASKS)
+        {
+                task_len = sizeof(vals);
+                if (yf_task_pop(g_mp_tq, &task_info, (char*)vals, &task_len, _log) != YF_OK)
+                {
+                        yf_sched_yield();
+                        continue;
+                }
+
+                no = task_info.id / TQ_MP_TASKS;
+                ASSERT_LT(no, TQ_MP_PRODUCERS);
+                ASSERT_EQ(task_info.id % TQ_MP_TASKS, next[no]);
+                ASSERT_EQ(task_len, sizeof(yf_u64_t) * (1 + next[no] % 3));
+                ASSERT_EQ(vals[task_len / sizeof(yf_u64_t) - 1], task_info.id);
+                ++next[no];
+                ++cnt;
+        }
+
+        void* ptr = NULL;
+        for (no = 0; no < TQ_MP_PRODUCERS; ++no)
+                yf_thread_join(tids[no], &ptr);
+        ASSERT_TRUE(yf_task_queue_empty(g_mp_tq));
+        ASSERT_EQ(yf_tq_buf_size(g_mp_tq), 0);
+
+        //a producer stalled between claim and publish, the first head
+        //unpublished, the later producer never wait, the consumer stop there
+        yf_memzero(tq_buf, sizeof(tq_buf));
+        g_mp_tq = yf_init_task_queue(tq_buf, sizeof(tq_buf), _log);
+        yf_task_queue_set_mp(g_mp_tq);
+        yf_u32_t* first_magic = (yf_u32_t*)(tq_buf 
+                        + yf_align(sizeof(yf_task_queue_t), YF_ALIGNMENT));
+
+        yf_memzero_st(task_info);
+        for (task_info.id = 1; task_info.id <= 2; ++task_info.id)
+                ASSERT_EQ(yf_task_push_mp(g_mp_tq, &task_info, (char*)vals, 
+                                sizeof(vals), _log), YF_OK);
+        *first_magic = 0;
+        task_info.id = 3;
+        ASSERT_EQ(yf_task_push_mp(g_mp_tq, &task_info, (char*)vals, 
+                        sizeof(vals), _log), YF_OK);
+
+        task_len = sizeof(vals);
+        ASSERT_EQ(yf_task_pop(g_mp_tq, &task_info, (char*)vals, &task_len, _log), YF_AGAIN);
+        ASSERT_EQ(yf_task_park(g_mp_tq), YF_OK);
+
+        *first_magic = YF_MAGIC_VAL;
+        ASSERT_TRUE(yf_task_need_signal(g_mp_tq));
+        for (yf_u64_t id = 1; id <= 3; ++id)
+        {
+                task_len = sizeof(vals);
+                ASSERT_EQ(yf_task_pop(g_mp_tq, &task_info, (char*)vals, &task_len, _log), YF_OK);
+                ASSERT_EQ(task_info.id, id);
+        }
+        ASSERT_EQ(yf_task_pop(g_mp_tq, &task_info, (char*)vals, &task_len, _log), YF_AGAIN);
+        //the room given back zeroed
+        ASSERT_EQ(*first_magic, 0);
+}
+
+
+//id = lane * 100 + seq in lane
+void  tq_lanes_push(yf_task_queue_t* tq, yf_u32_t lanes, yf_u32_t per_lane)
+{
+        task_info_t  task_info;
+        char  task[32];
+        yf_memzero_st(task_info);
+
+        //low lane first, so pop order is not push order
+        for (yf_u32_t i = 0; i < per_lane; ++i)
+        {
+                for (yf_s32_t lane = lanes - 1; lane >= 0; --lane)
+                {
+                        task_info.id = lane * 100 + i;
+                        ASSERT_EQ(yf_task_push(yf_tq_lane(tq, lane), &task_info, 
+                                        task, sizeof(task), _log), YF_OK);
+                }
+        }
+}
+
+yf_int_t  tq_lanes_pop(yf_task_queue_t* tq, yf_u64_t* id)
+{
+        task_info_t  task_info;
+        char  task[32];
+        size_t  task_len = sizeof(task);
+
+        if (yf_task_pop(yf_task_lane_next(tq), &task_info, task, &task_len, _log) != YF_OK)
+                return YF_AGAIN;
+        *id = task_info.id;
+        return YF_OK;
+}
+
+TEST_F(BridgeTestor, TaskQueueLanes)
+{
+        static char  tq_buf[3 * 4096];
+        yf_u64_t  id;
+        yf_u32_t  seq[3] = {0};
+
+        //strict, all high then normal then low
+        yf_memzero(tq_buf, sizeof(tq_buf));
+        yf_task_queue_t* tq = yf_init_task_lanes(tq_buf, sizeof(tq_buf), 3, 0, _log);
+        ASSERT_EQ(tq->lane_num, 3);
+        //out of range priority go to the lowest lane
+        ASSERT_EQ(yf_tq_lane(tq, 9), yf_tq_lane(tq, 2));
+
+        tq_lanes_push(tq, 3, 8);
+        for (int i = 0; i < 24; ++i)
+        {
+                ASSERT_EQ(tq_lanes_pop(tq, &id), YF_OK);
+                ASSERT_EQ(id, (yf_u64_t)(i / 8 * 100 + i % 8));
+        }
+        ASSERT_EQ(tq_lanes_pop(tq, &id), YF_AGAIN);
+        ASSERT_EQ(yf_task_lanes_size(tq), 0);
+
+        //task only in the low lane still stop park
+        yf_task_unpark(tq);
+        tq_lanes_push(tq, 3, 1);
+        ASSERT_EQ(tq_lanes_pop(tq, &id), YF_OK);
+        ASSERT_EQ(tq_lanes_pop(tq, &id), YF_OK);
+        ASSERT_EQ(yf_task_park(tq), YF_AGAIN);
+        ASSERT_EQ(tq_lanes_pop(tq, &id), YF_OK);
+        ASSERT_EQ(id, 200);
+        ASSERT_EQ(yf_task_park(tq), YF_OK);
+
+        //weighted 4:2:1, low lane not starved, fifo in each lane
+        yf_memzero(tq_buf, sizeof(tq_buf));
+        tq = yf_init_task_lanes(tq_buf, sizeof(tq_buf), 3, 1, _log);
+
+        tq_lanes_push(tq, 3, 8);
+        const yf_u32_t  round[7] = {0, 0, 0, 0, 1, 1, 2};
+        for (int i = 0; i < 7; ++i)
+        {
+                ASSERT_EQ(tq_lanes_pop(tq, &id), YF_OK);
+                ASSERT_EQ(id / 100, round[i]);
+                ASSERT_EQ(id % 100, seq[id / 100]++);
+        }
+        while (tq_lanes_pop(tq, &id) == YF_OK)
+                ASSERT_EQ(id % 100, seq[id / 100]++);
+
+        for (int i = 0; i < 3; ++i)
+                ASSERT_EQ(seq[i], 8);
+        ASSERT_EQ(yf_task_lanes_size(tq), 0);
+}
+
+
+void  tq_deadline_push(yf_task_queue_t* tq, yf_u64_t id, yf_u32_t timeout_ms)
+{
+        task_info_t  task_info;
+        char  task[32];
+
+        yf_memzero_st(task_info);
+        task_info.id = id;
+        task_info.inqueue_time.tv_sec = 1000;
+        task_info.timeout_ms = timeout_ms;
+        ASSERT_EQ(yf_task_push(tq, &task_info, task, sizeof(task), _log), YF_OK);
+}
+
+yf_u64_t  tq_deadline_peek(yf_task_queue_t* tq, yf_u32_t window)
+{
+        task_info_t  task_info;
+        char* task;
+        size_t  task_len;
+
+        if (yf_task_peek_edf(tq, window, &task_info, &task, &task_len, _log) != YF_OK)
+                return (yf_u64_t)-1;
+        yf_task_release(tq, _log);
+        return task_info.id;
+}
+
+TEST_F(BridgeTestor, TaskQueueDeadline)
+{
+        static char  tq_buf[8192];
+        yf_memzero(tq_buf, sizeof(tq_buf));
+        yf_task_queue_t* tq = yf_init_task_queue(tq_buf, sizeof(tq_buf), _log);
+
+        //never timeout last, same deadline in fifo, cancelled skipped
+        tq_deadline_push(tq, 0, 0);
+        tq_deadline_push(tq, 1, 500);
+        tq_deadline_push(tq, 2, 100);
+        tq_deadline_push(tq, 3, 300);
+        tq_deadline_push(tq, 4, 100);
+        tq_deadline_push(tq, 5, 50);
+        yf_task_cancel(tq, 3);
+
+        const yf_u64_t  edf[] = {5, 2, 4, 1, 0};
+        for (size_t i = 0; i < YF_ARRAY_SIZE(edf); ++i)
+                ASSERT_EQ(tq_deadline_peek(tq, 8), edf[i]);
+        ASSERT_EQ(tq_deadline_peek(tq, 8), (yf_u64_t)-1);
+        ASSERT_EQ(yf_tq_buf_size(tq), 0);
+        ASSERT_EQ(yf_task_park(tq), YF_OK);
+        yf_task_unpark(tq);
+
+        //just the first window tasks compared
+        tq_deadline_push(tq, 10, 300);
+        tq_deadline_push(tq, 11, 200);
+        tq_deadline_push(tq, 12, 100);
+        ASSERT_EQ(tq_deadline_peek(tq, 2), 11);
+        ASSERT_EQ(tq_deadline_peek(tq, 2), 12);
+        ASSERT_EQ(tq_deadline_peek(tq, 2), 10);
+        ASSERT_EQ(yf_tq_buf_size(tq), 0);
+
+        //cancelled at the head, pop give the room back
+        tq_deadline_push(tq, 20, 0);
+        tq_deadline_push(tq, 21, 0);
+        yf_task_cancel(tq, 20);
+        yf_task_cancel(tq, 21);
+
+        task_info_t  task_info;
+        char  task[32];
+        size_t  task_len = sizeof(task);
+        ASSERT_EQ(yf_task_pop(tq, &task_info, task, &task_len, _log), YF_AGAIN);
+        ASSERT_EQ(yf_tq_buf_size(tq), 0);
+}
+
+
+#define DISPATCH_CHILD_NUM 4
+
+//which child the task dispatched to, by the executing count
+yf_int_t  dispatched_child(yf_bridge_t* bridge, void* task, size_t len, yf_u32_t hash)
+{
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        yf_uint_t  execut[DISPATCH_CHILD_NUM];
+
+        yf_memcpy(execut, bridge_in->task_execut, sizeof(execut));
+        if (yf_send_task(bridge, task, len, hash, NULL, 0, _log) == (yf_u64_t)-1)
+                return -1;
+
+        for (int i = 0; i < DISPATCH_CHILD_NUM; ++i)
+        {
+                if (bridge_in->task_execut[i] != execut[i])
+                        return i;
+        }
+        return -1;
+}
+
+TEST_F(BridgeTestor, DispatchLoad)
+{
+        static char  task[4096];
+        yf_bridge_cxt_t bridge_ctx = {YF_BRIDGE_INS_THREAD, 
+                        YF_BRIDGE_INS_THREAD,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_TASK_DISTPATCH_LEAST_LOAD,
+                        NULL, DISPATCH_CHILD_NUM, 10240, 128, 1024 * 1024
+                };
+
+        //no child attached, tasks just stay in tqs
+        yf_bridge_t* bridge = yf_bridge_create(&bridge_ctx, _log);
+        ASSERT_TRUE(bridge != NULL);
+        ASSERT_EQ(YF_OK, yf_attach_res_bridge(bridge, NULL, NULL, _log));
+
+        ASSERT_EQ(dispatched_child(bridge, task, 4000, 0), 0);
+        ASSERT_EQ(dispatched_child(bridge, task, 100, 0), 1);
+        ASSERT_EQ(dispatched_child(bridge, task, 2000, 0), 2);
+        ASSERT_EQ(dispatched_child(bridge, task, 50, 0), 3);
+
+        //same executing num, less pending bytes win
+        ASSERT_EQ(dispatched_child(bridge, task, 50, 0), 3);
+        ASSERT_EQ(dispatched_child(bridge, task, 50, 0), 1);
+        ASSERT_EQ(dispatched_child(bridge, task, 50, 0), 2);
+
+        //two choice keep the childs balanced
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        bridge_in->ctx.task_dispatch_type = YF_TASK_DISTPATCH_TWO_CHOICE;
+        //random picks, a fixed seed so the gap is stable
+        bridge_in->dispatch_seed = 1;
+
+        for (int i = 0; i < 100; ++i)
+                ASSERT_TRUE(dispatched_child(bridge, task, 16, 0) >= 0);
+
+        yf_uint_t  min_execut = bridge_in->task_execut[0], max_execut = min_execut;
+        for (int i = 1; i < DISPATCH_CHILD_NUM; ++i)
+        {
+                min_execut = yf_min(min_execut, bridge_in->task_execut[i]);
+                max_execut = yf_max(max_execut, bridge_in->task_execut[i]);
+        }
+        ASSERT_LE(max_execut - min_execut, 3);
+}
+
+TEST_F(BridgeTestor, DispatchJumpHash)
+{
+        static char  task[64];
+        yf_bridge_cxt_t bridge_ctx = {YF_BRIDGE_INS_THREAD, 
+                        YF_BRIDGE_INS_THREAD,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_TASK_DISTPATCH_JUMP_HASH,
+                        NULL, DISPATCH_CHILD_NUM, 10240, 128, 1024 * 1024
+                };
+
+        yf_bridge_t* bridge = yf_bridge_create(&bridge_ctx, _log);
+        ASSERT_TRUE(bridge != NULL);
+        ASSERT_EQ(YF_OK, yf_attach_res_bridge(bridge, NULL, NULL, _log));
+
+        for (yf_u32_t hash = 0; hash < 100; ++hash)
+        {
+                ASSERT_EQ(dispatched_child(bridge, task, sizeof(task), hash * 7919), 
+                                yf_jump_hash(hash * 7919, DISPATCH_CHILD_NUM));
+        }
+}
+
+
+TEST_F(BridgeTestor, CancelTask)
+{
+        static char  task[64];
+        yf_bridge_cxt_t bridge_ctx = {YF_BRIDGE_INS_THREAD, 
+                        YF_BRIDGE_INS_THREAD,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_TASK_DISTPATCH_HASH_MOD,
+                        NULL, 1, 10240, 128, 1024 * 1024
+                };
+
+        yf_bridge_t* bridge = yf_bridge_create(&bridge_ctx, _log);
+        ASSERT_TRUE(bridge != NULL);
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        ASSERT_EQ(YF_OK, yf_attach_res_bridge(bridge, NULL, NULL, _log));
+
+        yf_u64_t  id1 = yf_send_task(bridge, task, sizeof(task), 0, NULL, 0, _log);
+        yf_u64_t  id2 = yf_send_task(bridge, task, sizeof(task), 0, NULL, 0, _log);
+        ASSERT_NE(id1, (yf_u64_t)-1);
+        ASSERT_NE(id2, (yf_u64_t)-1);
+        ASSERT_EQ(bridge_in->task_execut[0], 2);
+
+        ASSERT_EQ(yf_cancel_task(bridge, id1, _log), YF_OK);
+        ASSERT_EQ(bridge_in->task_execut[0], 1);
+        ASSERT_EQ(yf_cancel_task(bridge, id1, _log), YF_ERROR);
+        ASSERT_EQ(yf_cancel_task(bridge, (yf_u64_t)-1, _log), YF_ERROR);
+
+        //out of the pool, or of another parent
+        ASSERT_EQ(yf_cancel_task(bridge, id2 | ((yf_u64_t)0xffffff << 32), _log), YF_ERROR);
+        ASSERT_EQ(yf_cancel_task(bridge, id2 | ((yf_u64_t)1 << 56), _log), YF_ERROR);
+        ASSERT_EQ(bridge_in->task_execut[0], 1);
+
+        //the child just get the live one
+        task_info_t  task_info;
+        char  buf[128];
+        size_t  len = sizeof(buf);
+        yf_task_queue_t* tq;
+        yf_int_t  child_no = 0;
+        bridge_in->lock_tq(bridge_in, &tq, &child_no, _log);
+        ASSERT_EQ(yf_task_pop(tq, &task_info, buf, &len, _log), YF_OK);
+        ASSERT_EQ(task_info.id, id2);
+        ASSERT_EQ(yf_task_pop(tq, &task_info, buf, &len, _log), YF_AGAIN);
+}
+
+
+static yf_u64_t  g_failed_id = 0;
+static yf_int_t  g_failed_status = YF_TASK_SUCESS;
+static yf_int_t  g_failed_cnt = 0;
+
+static void on_inflight_res(yf_bridge_t* bridge
+                , void* task_res, size_t len, yf_u64_t id
+                , yf_int_t status, void* data, yf_log_t* log)
+{
+        g_failed_id = id;
+        g_failed_status = status;
+        ++g_failed_cnt;
+}
+
+TEST_F(BridgeTestor, FailInflight)
+{
+        static char  task[64];
+        static yf_bridge_inflight_t  inflight;
+        yf_bridge_cxt_t bridge_ctx = {YF_BRIDGE_INS_THREAD, 
+                        YF_BRIDGE_INS_THREAD,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_TASK_DISTPATCH_HASH_MOD,
+                        NULL, 1, 10240, 128, 1024 * 1024
+                };
+
+        yf_bridge_t* bridge = yf_bridge_create(&bridge_ctx, _log);
+        ASSERT_TRUE(bridge != NULL);
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        ASSERT_EQ(YF_OK, yf_attach_res_bridge(bridge, NULL, on_inflight_res, _log));
+
+        //thread childs not tracked, act as a dead proc child's table
+        bridge_in->inflight = &inflight;
+
+        yf_u64_t  id1 = yf_send_task(bridge, task, sizeof(task), 0, NULL, 0, _log);
+        yf_u64_t  id2 = yf_send_task(bridge, task, sizeof(task), 0, NULL, 0, _log);
+        yf_u64_t  id3 = yf_send_task(bridge, task, sizeof(task), 0, NULL, 0, _log);
+        ASSERT_EQ(bridge_in->task_execut[0], 3);
+
+        //id1 taken, id2 taken and cancelled by parent, id3 still queued
+        inflight.ids[3] = id1;
+        inflight.ids[5] = id2;
+        ASSERT_EQ(yf_cancel_task(bridge, id2, _log), YF_OK);
+
+        yf_bridge_fail_inflight(bridge_in, 0, _log);
+        ASSERT_EQ(g_failed_cnt, 1);
+        ASSERT_EQ(g_failed_id, id1);
+        ASSERT_EQ(g_failed_status, YF_TASK_ERROR);
+        ASSERT_EQ(bridge_in->task_execut[0], 1);
+        ASSERT_EQ(inflight.ids[3], 0);
+        ASSERT_EQ(inflight.ids[5], 0);
+        ASSERT_EQ(yf_cancel_task(bridge, id1, _log), YF_ERROR);
+
+        //the new child skip the failed one, get the queued one
+        task_info_t  task_info;
+        char  buf[128];
+        size_t  len = sizeof(buf);
+        yf_task_queue_t* tq;
+        yf_int_t  child_no = 0;
+        bridge_in->lock_tq(bridge_in, &tq, &child_no, _log);
+        ASSERT_EQ(yf_task_pop(tq, &task_info, buf, &len, _log), YF_OK);
+        ASSERT_EQ(task_info.id, id3);
+        ASSERT_EQ(yf_task_pop(tq, &task_info, buf, &len, _log), YF_AGAIN);
+
+        bridge_in->inflight = NULL;
+}
+
+
+TEST_F(BridgeTestor, FailQueued)
+{
+        static char  task[64];
+        yf_bridge_cxt_t bridge_ctx = {YF_BRIDGE_INS_THREAD, 
+                        YF_BRIDGE_INS_THREAD,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_TASK_DISTPATCH_HASH_MOD,
+                        NULL, 2, 10240, 128, 1024 * 1024
+                };
+
+        yf_bridge_t* bridge = yf_bridge_create(&bridge_ctx, _log);
+        ASSERT_TRUE(bridge != NULL);
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        ASSERT_EQ(YF_OK, yf_attach_res_bridge(bridge, NULL, on_inflight_res, _log));
+
+        //queued to child_1, one cancelled by parent
+        yf_u64_t  id1 = yf_send_task(bridge, task, sizeof(task), 1, NULL, 0, _log);
+        yf_u64_t  id2 = yf_send_task(bridge, task, sizeof(task), 1, NULL, 0, _log);
+        yf_u64_t  id3 = yf_send_task(bridge, task, sizeof(task), 1, NULL, 0, _log);
+        ASSERT_EQ(bridge_in->task_execut[1], 3);
+        ASSERT_EQ(yf_cancel_task(bridge, id2, _log), YF_OK);
+
+        //child_1 removed and died, its queued ones failed at once
+        ASSERT_EQ(yf_bridge_resize(bridge, 1, _log), YF_OK);
+        g_failed_cnt = 0;
+        yf_bridge_fail_queued(bridge_in, 1, _log);
+        ASSERT_EQ(g_failed_cnt, 2);
+        ASSERT_EQ(g_failed_id, id3);
+        ASSERT_EQ(g_failed_status, YF_TASK_ERROR);
+        ASSERT_EQ(bridge_in->task_execut[1], 0);
+        ASSERT_EQ(yf_cancel_task(bridge, id1, _log), YF_ERROR);
+        ASSERT_EQ(yf_cancel_task(bridge, id3, _log), YF_ERROR);
+
+        yf_task_queue_t* tq;
+        yf_int_t  child_no = 1;
+        bridge_in->lock_tq(bridge_in, &tq, &child_no, _log);
+        ASSERT_TRUE(yf_task_queue_empty(tq));
+}
+
+
+static void on_batch_task(yf_bridge_t* bridge
+                , void* task, size_t len, yf_u64_t id, yf_log_t* log)
+{
+}
+
+//a slow handler, saw the res tq parked or not when each task taken
+static yf_task_queue_t* g_batch_rtq;
+static std::vector<yf_u32_t>  g_batch_parked;
+
+static void on_batch_slow_task(yf_bridge_t* bridge
+                , void* task, size_t len, yf_u64_t id, yf_log_t* log)
+{
+        g_batch_parked.push_back(g_batch_rtq->parked);
+        yf_send_task_res(bridge, task, len, id, YF_TASK_SUCESS, log);
+        yf_msleep(30);
+}
+
+TEST_F(BridgeTestor, ResBatch)
+{
+        static char  res[64];
+        yf_bridge_cxt_t bridge_ctx = {YF_BRIDGE_INS_THREAD, 
+                        YF_BRIDGE_INS_THREAD,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_BRIDGE_BLOCKED,
+                        YF_TASK_DISTPATCH_HASH_MOD,
+                        NULL, 1, 1024, 128, 1024 * 1024
+                };
+        bridge_ctx.res_batch_num = 4;
+        bridge_ctx.res_batch_ms = 20;
+
+        yf_bridge_t* bridge = yf_bridge_create(&bridge_ctx, _log);
+        ASSERT_TRUE(bridge != NULL);
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        ASSERT_EQ(YF_OK, yf_attach_res_bridge(bridge, NULL, NULL, _log));
+
+        //this thread act as child_0 too
+        ASSERT_EQ(YF_OK, yf_attach_bridge(bridge, NULL, on_batch_task, _log));
+        ASSERT_EQ(yf_bridge_child_no(bridge, _log), 0);
+
+        //parent parked on res tq, the doorbell rung once a batch
+        yf_task_queue_t* rtq;
+        yf_int_t  child_no = 0;
+        bridge_in->lock_res_tq(bridge_in, &rtq, &child_no, _log);
+        ASSERT_EQ(rtq->parked, 1);
+
+        yf_update_time(NULL, NULL, _log);
+        for (int i = 0; i < 3; ++i)
+        {
+                ASSERT_EQ(yf_send_task_res(bridge, res, sizeof(res), i + 1, 
+                                YF_TASK_SUCESS, _log), YF_OK);
+                ASSERT_EQ(rtq->parked, 1);
+        }
+        ASSERT_EQ(yf_send_task_res(bridge, res, sizeof(res), 4, YF_TASK_SUCESS, _log), YF_OK);
+        ASSERT_EQ(rtq->parked, 0);
+        ASSERT_EQ(bridge_in->res_batch[0].num, 0);
+
+        //drained, parked again
+        yf_bridge_on_task_res_valiable(bridge_in, 0, _log);
+        ASSERT_EQ(rtq->parked, 1);
+
+        //flushed if child idle
+        ASSERT_EQ(yf_send_task_res(bridge, res, sizeof(res), 5, YF_TASK_SUCESS, _log), YF_OK);
+        ASSERT_EQ(rtq->parked, 1);
+        yf_bridge_on_task_valiable(bridge_in, 0, _log);
+        ASSERT_EQ(rtq->parked, 0);
+        ASSERT_EQ(bridge_in->res_batch[0].num, 0);
+        yf_bridge_on_task_res_valiable(bridge_in, 0, _log);
+
+        //or the first one waited too long
+        ASSERT_EQ(yf_send_task_res(bridge, res, sizeof(res), 6, YF_TASK_SUCESS, _log), YF_OK);
+        ASSERT_EQ(rtq->parked, 1);
+        yf_msleep(30);
+        yf_update_time(NULL, NULL, _log);
+        ASSERT_EQ(yf_send_task_res(bridge, res, sizeof(res), 7, YF_TASK_SUCESS, _log), YF_OK);
+        ASSERT_EQ(rtq->parked, 0);
+        ASSERT_EQ(bridge_in->res_batch[0].num, 0);
+        yf_bridge_on_task_res_valiable(bridge_in, 0, _log);
+        ASSERT_EQ(rtq->parked, 1);
+
+        //busy child, the waited batch flushed before the next task taken
+        g_batch_rtq = rtq;
+        bridge_in->task_handler = on_batch_slow_task;
+        for (int i = 0; i < 2; ++i)
+                ASSERT_NE(yf_send_task(bridge, res, sizeof(res), 0, NULL, 0, _log), 
+                                (yf_u64_t)-1);
+        yf_bridge_on_task_valiable(bridge_in, 0, _log);
+        ASSERT_EQ(g_batch_parked.size(), 2);
+        ASSERT_EQ(g_batch_parked[0], 1);
+        ASSERT_EQ(g_batch_parked[1], 0);
+}
+
+
+static void on_mp_task(yf_bridge_t* bridge
+                , void* task, size_t len, yf_u64_t id, yf_log_t* log)
+{
+        yf_send_task_res(bridge, task, len, id, YF_TASK_SUCESS, log);
+}
+
+static yf_bridge_t* g_mp_res_bridge;
+static void* g_mp_res_data;
+
+static void on_mp_task_res(yf_bridge_t* bridge
+                , void* task_res, size_t len, yf_u64_t id
+                , yf_int_t status, void* data, yf_log_t* log)
+{
+        g_mp_res_bridge = bridge;
+        g_mp_res_data = data;
+}
+
+TEST_F(BridgeTestor, MultiParent)
+{
+        static char  task[64];
+        yf_bridge_cxt_t bridge_ctx = {YF_BRIDGE_INS_THREAD, 
+                        YF_BRIDGE_INS_THREAD,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_BRIDGE_BLOCKED,
+                        YF_TASK_DISTPATCH_HASH_MOD,
+                        NULL, 1, 1024, 128, 1024 * 1024
+                };
+        bridge_ctx.max_parent_num = 2;
+
+        yf_bridge_t* bridge = yf_bridge_create(&bridge_ctx, _log);
+        ASSERT_TRUE(bridge != NULL);
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        ASSERT_EQ(YF_OK, yf_attach_res_bridge(bridge, NULL, on_mp_task_res, _log));
+
+        yf_evt_driver_init_t driver_init = {0, 128, 64, _log, YF_DEFAULT_DRIVER_CB};
+        yf_evt_driver_t* evt_driver = yf_evt_driver_create(&driver_init);
+        ASSERT_TRUE(evt_driver != NULL);
+
+        yf_bridge_t* parent = yf_attach_parent(bridge, evt_driver, on_mp_task_res, _log);
+        ASSERT_TRUE(parent != NULL);
+        yf_bridge_in_t* parent_in = (yf_bridge_in_t*)parent;
+        ASSERT_TRUE(yf_attach_parent(bridge, evt_driver, on_mp_task_res, _log) == NULL);
+
+        //this thread act as child_0 too
+        ASSERT_EQ(YF_OK, yf_attach_bridge(bridge, NULL, on_mp_task, _log));
+
+        //both push to child_0's tq, parent no in the task id
+        yf_u64_t  id0 = yf_send_task(bridge, task, sizeof(task), 0, (void*)1, 0, _log);
+        yf_u64_t  id1 = yf_send_task(parent, task, sizeof(task), 0, (void*)2, 0, _log);
+        ASSERT_EQ(yf_bridge_parent_no(id0), 0);
+        ASSERT_EQ(yf_bridge_parent_no(id1), 1);
+        ASSERT_EQ(bridge_in->task_execut[0], 1);
+        ASSERT_EQ(parent_in->task_execut[0], 1);
+
+        ASSERT_TRUE(yf_send_task_reserve(parent, sizeof(task), 0, _log) == NULL);
+        ASSERT_EQ(yf_bridge_resize(bridge, 1, _log), YF_ERROR);
+
+        //res go back to the sender
+        yf_bridge_on_task_valiable(bridge_in, 0, _log);
+        ASSERT_FALSE(yf_task_queue_empty(parent_in->res_tqs[0]));
+
+        yf_bridge_on_task_res_valiable(parent_in, 0, _log);
+        ASSERT_EQ(g_mp_res_bridge, parent);
+        ASSERT_EQ(g_mp_res_data, (void*)2);
+        ASSERT_EQ(parent_in->task_execut[0], 0);
+        ASSERT_TRUE(yf_task_queue_empty(parent_in->res_tqs[0]));
+
+        yf_bridge_on_task_res_valiable(bridge_in, 0, _log);
+        ASSERT_EQ(g_mp_res_bridge, bridge);
+        ASSERT_EQ(g_mp_res_data, (void*)1);
+        ASSERT_EQ(bridge_in->task_execut[0], 0);
+
+        //destory wait the parent's task, its res handled there
+        yf_u64_t  id2 = yf_send_task(parent, task, sizeof(task), 0, (void*)3, 0, _log);
+        ASSERT_NE(id2, (yf_u64_t)-1);
+        yf_bridge_on_task_valiable(bridge_in, 0, _log);
+        ASSERT_EQ(yf_bridge_destory(parent, _log), YF_OK);
+        ASSERT_EQ(g_mp_res_data, (void*)3);
+        ASSERT_TRUE(bridge_in->parents[1] == NULL);
+        ASSERT_EQ(bridge_in->parent_refs[1], 0);
+
+        //res to the detached one dropped, the slot taken again
+        ASSERT_EQ(yf_send_task_res(bridge, task, sizeof(task), id2, 0, _log), YF_ERROR);
+        parent = yf_attach_parent(bridge, evt_driver, on_mp_task_res, _log);
+        ASSERT_TRUE(parent != NULL);
+        ASSERT_EQ(((yf_bridge_in_t*)parent)->parent_no, 1);
+        ASSERT_EQ(yf_bridge_destory(parent, _log), YF_OK);
+}
+
+
+TEST_F(BridgeTestor, Stat)
+{
+        static char  task[64];
+        yf_bridge_cxt_t bridge_ctx = {YF_BRIDGE_INS_THREAD, 
+                        YF_BRIDGE_INS_THREAD,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_TASK_DISTPATCH_HASH_MOD,
+                        NULL, 2, 128, 1024, 8192
+                };
+
+        yf_bridge_t* bridge = yf_bridge_create(&bridge_ctx, _log);
+        ASSERT_TRUE(bridge != NULL);
+        ASSERT_EQ(YF_OK, yf_attach_res_bridge(bridge, NULL, NULL, _log));
+
+        //no child consume, send to child_0 untill full
+        yf_u64_t  id, first_id = -1;
+        yf_u64_t  sent = 0;
+        while ((id = yf_send_task(bridge, task, sizeof(task), 0, NULL, 0, _log)) 
+                        != (yf_u64_t)-1)
+        {
+                if (first_id == (yf_u64_t)-1)
+                        first_id = id;
+                ++sent;
+        }
+        ASSERT_GT(sent, 0);
+        ASSERT_EQ(yf_cancel_task(bridge, first_id, _log), YF_OK);
+
+        yf_bridge_stat_t  stat;
+        ASSERT_EQ(yf_bridge_stat(bridge, 0, &stat, _log), YF_OK);
+        ASSERT_EQ(stat.sent, sent);
+        ASSERT_EQ(stat.push_fail, 1);
+        ASSERT_EQ(stat.cancelled, 1);
+        ASSERT_EQ(stat.executing, sent - 1);
+        ASSERT_GT(stat.queue_bytes, 0);
+        ASSERT_EQ(stat.received, 0);
+        ASSERT_EQ(stat.round_trip.cnt, 0);
+
+        ASSERT_EQ(yf_bridge_stat(bridge, 1, &stat, _log), YF_OK);
+        ASSERT_EQ(stat.sent, 0);
+        ASSERT_EQ(stat.queue_bytes, 0);
+
+        ASSERT_EQ(yf_bridge_stat(bridge, -1, &stat, _log), YF_ERROR);
+        ASSERT_EQ(yf_bridge_stat(bridge, 2, &stat, _log), YF_ERROR);
+}
+
+
+/*
+* blocked thread child with adaptive spin, tasks a few us apart keep it
+* spinning, an idle one goes to the cond
+*/
+#define SPIN_TASKS 2000
+
+static volatile yf_u32_t  g_spin_handled = 0;
+
+static void on_spin_task(yf_bridge_t* bridge
+                , void* task, size_t len, yf_u64_t id, yf_log_t* log)
+{
+        ++g_spin_handled;
+}
+
+static yf_thread_value_t spin_thread_exe(void* arg)
+{
+        yf_bridge_t* bridge = (yf_bridge_t*)arg;
+
+        assert(yf_attach_bridge(bridge, NULL, on_spin_task, _log) == YF_OK);
+        while (1)
+                yf_poll_task(bridge, _log);
+        return NULL;
+}
+
+static yf_u64_t  spin_now_us()
+{
+        struct timespec  ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (yf_u64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static yf_u64_t  spin_parked(yf_bridge_t* bridge)
+{
+        yf_bridge_stat_t  stat;
+        assert(yf_bridge_stat(bridge, 0, &stat, _log) == YF_OK);
+        return stat.parked;
+}
+
+TEST_F(BridgeTestor, BlockedSpin)
+{
+        static char  task[64];
+        yf_bridge_cxt_t bridge_ctx = {YF_BRIDGE_INS_THREAD, 
+                        YF_BRIDGE_INS_THREAD,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_BRIDGE_BLOCKED,
+                        YF_TASK_DISTPATCH_IDLE,
+                        (void*)spin_thread_exe, 1, 128, SPIN_TASKS * 2, 1024 * 1024
+                };
+        bridge_ctx.child_spin_us = 200;
+
+        yf_bridge_t* bridge = yf_bridge_create(&bridge_ctx, _log);
+        ASSERT_TRUE(bridge != NULL);
+        ASSERT_EQ(YF_OK, yf_attach_res_bridge(bridge, NULL, NULL, _log));
+
+        //steady load, a task each 20us, the avg wait learned keeps it spinning
+        yf_u64_t  begin;
+        for (int i = 0; i < SPIN_TASKS; ++i)
+        {
+                ASSERT_NE(yf_send_task(bridge, task, sizeof(task), 0, NULL, 0, _log), 
+                                (yf_u64_t)-1);
+                for (begin = spin_now_us(); spin_now_us() - begin < 20; )
+                        yf_cpu_pause();
+        }
+        for (int i = 0; i < 1000 && g_spin_handled < SPIN_TASKS; ++i)
+                yf_msleep(1);
+        ASSERT_EQ(g_spin_handled, SPIN_TASKS);
+
+        yf_u64_t  parked = spin_parked(bridge);
+        printf("steady load parked=%lld of tasks=%d\n", (long long)parked, SPIN_TASKS);
+        ASSERT_LT(parked, SPIN_TASKS / 4);
+
+        //idle, a task wakes it, it spins out the window then parks once again
+        yf_msleep(50);
+        parked = spin_parked(bridge);
+
+        ASSERT_NE(yf_send_task(bridge, task, sizeof(task), 0, NULL, 0, _log), (yf_u64_t)-1);
+        for (int i = 0; i < 1000 && g_spin_handled < SPIN_TASKS + 1; ++i)
+                yf_msleep(1);
+        ASSERT_EQ(g_spin_handled, SPIN_TASKS + 1);
+
+        yf_msleep(50);
+        ASSERT_EQ(spin_parked(bridge), parked + 1);
+}
+
+
+TEST_F(BridgeTestor, BlobTask)
+{
+        static char  task[20000];
+        yf_bridge_cxt_t bridge_ctx = {YF_BRIDGE_INS_THREAD, 
+                        YF_BRIDGE_INS_THREAD,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_TASK_DISTPATCH_HASH_MOD,
+                        NULL, 1, 128, 128, 8192
+                };
+        bridge_ctx.blob_arena_size = 64 * 1024;
+
+        yf_bridge_t* bridge = yf_bridge_create(&bridge_ctx, _log);
+        ASSERT_TRUE(bridge != NULL);
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+        yf_blob_arena_t* arena = bridge_in->blob_arena;
+        ASSERT_TRUE(arena != NULL);
+        ASSERT_EQ(YF_OK, yf_attach_res_bridge(bridge, NULL, NULL, _log));
+
+        yf_u32_t  all_free = arena->free_num;
+        for (size_t i = 0; i < sizeof(task); i++)
+                task[i] = i % 251;
+
+        yf_u64_t  id1 = yf_send_task(bridge, task, 10000, 0, NULL, 0, _log);
+        yf_u64_t  id2 = yf_send_task(bridge, task, 10000, 0, NULL, 0, _log);
+        ASSERT_NE(id1, (yf_u64_t)-1);
+        ASSERT_NE(id2, (yf_u64_t)-1);
+        ASSERT_LT(arena->free_num, all_free);
+
+        //arena can not hold it
+        ASSERT_EQ(yf_send_task(bridge, task, 100 * 1024, 0, NULL, 0, _log), (yf_u64_t)-1);
+
+        //cancelled before taken, blob reclaimed by the parent
+        yf_u32_t  free_num = arena->free_num;
+        ASSERT_EQ(yf_cancel_task(bridge, id2, _log), YF_OK);
+        ASSERT_GT(arena->free_num, free_num);
+
+        //the child get the handle, then the blob
+        task_info_t  task_info;
+        yf_u32_t  blob;
+        size_t  len = sizeof(blob);
+        yf_task_queue_t* tq;
+        yf_int_t  child_no = 0;
+        bridge_in->lock_tq(bridge_in, &tq, &child_no, _log);
+        ASSERT_EQ(yf_task_pop(tq, &task_info, (char*)&blob, &len, _log), YF_OK);
+        ASSERT_EQ(task_info.id, id1);
+        ASSERT_EQ(task_info.blob, 1);
+        ASSERT_EQ(len, sizeof(blob));
+
+        char* data = yf_blob_take(arena, blob, id1, &len);
+        ASSERT_TRUE(data != NULL);
+        ASSERT_EQ(len, 10000);
+        ASSERT_EQ(memcmp(data, task, len), 0);
+
+        //taken, the parent cant reclaim it now
+        ASSERT_EQ(yf_blob_reclaim(arena, blob, id1), YF_AGAIN);
+        ASSERT_TRUE(yf_blob_take(arena, blob, id1, &len) == NULL);
+        yf_blob_free(arena, blob);
+        ASSERT_EQ(arena->free_num, all_free);
+
+        len = sizeof(blob);
+        ASSERT_EQ(yf_task_pop(tq, &task_info, (char*)&blob, &len, _log), YF_AGAIN);
+
+        //next fit, 6 chunks used before, then no 8 contiguous chunks left,
+        //and wrap to the head for a smaller one
+        yf_u32_t  h1, h2;
+        ASSERT_TRUE(yf_blob_alloc(arena, 30000, 1, &h1, _log) != NULL);
+        ASSERT_TRUE(yf_blob_alloc(arena, 30000, 2, &h2, _log) == NULL);
+        ASSERT_TRUE(yf_blob_alloc(arena, 20000, 3, &h2, _log) != NULL);
+        ASSERT_LT(h2, h1);
+        yf_blob_free(arena, h1);
+        yf_blob_free(arena, h2);
+        ASSERT_EQ(arena->free_num, all_free);
+}
+
+
+yf_thread_value_t futex_waiter(void* arg)
+{
+        yf_bridge_futex_t* bf = (yf_bridge_futex_t*)arg;
+        while (bf->seq == 0)
+                yf_bridge_futex_wait(bf, 0, _log);
+        return NULL;
+}
+
+
+TEST_F(BridgeTestor, Futex)
+{
+        static yf_bridge_futex_t  bf;
+        void* ptr = NULL;
+        yf_tid_t  tid;
+
+        //seq already changed, ret at once
+        bf.seq = 1;
+        yf_bridge_futex_wait(&bf, 0, _log);
+
+        bf.seq = 0;
+        ASSERT_EQ(yf_create_thread(&tid, futex_waiter, &bf, _log), 0);
+        yf_msleep(50);
+        yf_bridge_futex_signal(&bf, _log);
+        yf_thread_join(tid, &ptr);
+        ASSERT_EQ(bf.seq, 1);
+}
+
+
+void on_elastic_task_res(yf_bridge_t* bridge
+                , void* task_res, size_t len, yf_u64_t id
+                , yf_int_t status, void* data, yf_log_t* log)
+{
+}
+
+yf_int_t  g_idle_childs = 0;
+
+void on_elastic_child_idle(yf_bridge_in_t* bridge
+                , yf_int_t child_no, yf_log_t* log)
+{
+        g_idle_childs |= 1 << child_no;
+}
+
+void on_elastic_test_end(yf_tm_evt_t* evt, yf_time_t* start)
+{
+        yf_evt_driver_stop(evt->driver);
+}
+
+TEST_F(BridgeTestor, Elastic)
+{
+        static char  task[64];
+        yf_bridge_cxt_t bridge_ctx = {YF_BRIDGE_INS_THREAD, 
+                        YF_BRIDGE_INS_THREAD,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_TASK_DISTPATCH_LEAST_LOAD,
+                        NULL, 2, 10240, 128, 64 * 1024
+                };
+        bridge_ctx.max_child_num = 6;
+        yf_bridge_cxt_t ctx_org = bridge_ctx;
+
+        yf_bridge_t* bridge = yf_bridge_create(&bridge_ctx, _log);
+        ASSERT_TRUE(bridge != NULL);
+        yf_bridge_in_t* bridge_in = (yf_bridge_in_t*)bridge;
+
+        //the bridge's own ctx normalized, the caller's untouched
+        ASSERT_EQ(memcmp(&ctx_org, &bridge_ctx, sizeof(ctx_org)), 0);
+        ASSERT_EQ(yf_bridge_ctx(bridge)->task_lane_num, 1);
+        ASSERT_EQ(YF_OK, yf_attach_res_bridge(bridge, NULL, NULL, _log));
+
+        ASSERT_EQ(yf_bridge_resize(bridge, 0, _log), YF_ERROR);
+        ASSERT_EQ(yf_bridge_resize(bridge, 7, _log), YF_ERROR);
+
+        //grow, new childs get tasks
+        yf_u64_t  ids[8];
+        ASSERT_EQ(yf_bridge_resize(bridge, 4, _log), YF_OK);
+        ASSERT_EQ(yf_bridge_ctx(bridge)->child_num, 4);
+        for (int i = 0; i < 8; ++i)
+        {
+                ids[i] = yf_send_task(bridge, task, sizeof(task), 0, NULL, 0, _log);
+                ASSERT_NE(ids[i], (yf_u64_t)-1);
+        }
+        for (int i = 0; i < 4; ++i)
+                ASSERT_EQ(bridge_in->task_execut[i], 2);
+
+        //shrink, removed childs get no new task
+        ASSERT_EQ(yf_bridge_resize(bridge, 1, _log), YF_OK);
+        for (int i = 0; i < 4; ++i)
+                ASSERT_NE(yf_send_task(bridge, task, sizeof(task), 0, NULL, 0, _log), (yf_u64_t)-1);
+        ASSERT_EQ(bridge_in->task_execut[0], 6);
+        ASSERT_EQ(bridge_in->task_execut[1], 2);
+
+        //removed childs idle once their last tasks done, the kept one never
+        bridge_in->child_idle = on_elastic_child_idle;
+        for (int i = 0; i < 8; ++i)
+                ASSERT_EQ(yf_cancel_task(bridge, ids[i], _log), YF_OK);
+        ASSERT_EQ(bridge_in->task_execut[0], 4);
+        ASSERT_EQ(g_idle_childs, 0xe);
+
+        //auto grow, no child consume the tasks, so executing keep high
+        bridge_ctx.child_num = 1;
+        bridge = yf_bridge_create(&bridge_ctx, _log);
+        ASSERT_TRUE(bridge != NULL);
+
+        yf_update_time(NULL, NULL, _log);
+        yf_evt_driver_init_t driver_init = {0, 128, 64, _log, YF_DEFAULT_DRIVER_CB};
+        yf_evt_driver_t* evt_driver = yf_evt_driver_create(&driver_init);
+        ASSERT_TRUE(evt_driver != NULL);
+        ASSERT_EQ(YF_OK, yf_attach_res_bridge(bridge, evt_driver, on_elastic_task_res, _log));
+
+        yf_bridge_elastic_t  elastic = {1, 0, 0, 0, 1, 4, 100};
+        ASSERT_EQ(YF_OK, yf_bridge_set_elastic(bridge, &elastic, _log));
+
+        for (int i = 0; i < 10; ++i)
+                ASSERT_NE(yf_send_task(bridge, task, sizeof(task), 0, NULL, 0, _log), (yf_u64_t)-1);
+
+        yf_tm_evt_t* tm_evt;
+        ASSERT_EQ(YF_OK, yf_alloc_tm_evt(evt_driver, &tm_evt, _log));
+        tm_evt->timeout_handler = on_elastic_test_end;
+        yf_time_t time_out = {1, 0};
+        yf_register_tm_evt(tm_evt, &time_out);
+
+        yf_evt_driver_start(evt_driver);
+        ASSERT_EQ(yf_bridge_ctx(bridge)->child_num, 4);
+}
+
+
 #define MAX_SEND_BATCH 128
 yf_uint_t  g_task_cnt = 0;
 yf_uint_t  g_send_batch = 0;
@@ -400,6 +1654,130 @@ TEST_F(BridgeTestor, EvtProc)
 }
 
 
+/*
+* blocked proc childs, each task round trip a futex wake when the child parked
+*/
+#define BP_TASK_TOTAL 20000
+#define BP_WINDOW 64
+
+struct BlockedProcRun
+{
+        yf_bridge_t*  bridge;
+        yf_evt_driver_t*  driver;
+        yf_u32_t  sent;
+        yf_u32_t  received;
+        yf_u32_t  errors;
+        std::vector<char>  seen;
+};
+
+static BlockedProcRun  g_bp;
+
+static void on_bp_task(yf_bridge_t* bridge
+                , void* task, size_t len, yf_u64_t id, yf_log_t* log)
+{
+        yf_send_task_res(bridge, task, len, id, YF_TASK_SUCESS, log);
+}
+
+static void  blocked_child_proc(void* data, yf_log_t* log)
+{
+        yf_bridge_t* bridge = (yf_bridge_t*)data;
+
+        //no log flush thread in the forked child, a full log buf would block it
+        log->log_level = YF_LOG_WARN;
+
+        yf_int_t ret = yf_attach_bridge(bridge, NULL, on_bp_task, log);
+        assert(ret == YF_OK);
+
+        while (1)
+                yf_poll_task(bridge, log);
+}
+
+static void  bp_send()
+{
+        while (g_bp.sent < BP_TASK_TOTAL && g_bp.sent - g_bp.received < BP_WINDOW)
+        {
+                if (yf_send_task(g_bp.bridge, &g_bp.sent, sizeof(g_bp.sent),
+                                g_bp.sent, NULL, 0, _log) == (yf_u64_t)-1)
+                        return;
+                ++g_bp.sent;
+        }
+}
+
+static void on_bp_task_res(yf_bridge_t* bridge
+                , void* task_res, size_t len, yf_u64_t id
+                , yf_int_t status, void* data, yf_log_t* log)
+{
+        yf_u32_t  seq = *(yf_u32_t*)task_res;
+
+        ++g_bp.received;
+        if (status != YF_TASK_SUCESS || len != sizeof(seq)
+                        || seq >= g_bp.sent || g_bp.seen[seq])
+                ++g_bp.errors;
+        else
+                g_bp.seen[seq] = 1;
+
+        if (g_bp.received == BP_TASK_TOTAL)
+                yf_evt_driver_stop(g_bp.driver);
+        else
+                bp_send();
+}
+
+//guard, and resend if the window went empty on a full queue
+static void on_bp_timer(yf_tm_evt_t* evt, yf_time_t* start)
+{
+        yf_time_t  tm = {0, 100};
+
+        if (++*(yf_u32_t*)evt->data > 200)
+        {
+                yf_evt_driver_stop(g_bp.driver);
+                return;
+        }
+        if (g_bp.sent == g_bp.received)
+                bp_send();
+        yf_register_tm_evt(evt, &tm);
+}
+
+TEST_F(BridgeTestor, BlockedProc)
+{
+        yf_bridge_cxt_t bridge_ctx = {YF_BRIDGE_INS_PROC, 
+                        YF_BRIDGE_INS_PROC,
+                        YF_BRIDGE_EVT_DRIVED,
+                        YF_BRIDGE_BLOCKED,
+                        YF_TASK_DISTPATCH_IDLE,
+                        (void*)blocked_child_proc, 
+                        2, 10240, BP_WINDOW * 2, 1024 * 1024
+                };
+        yf_u32_t  ticks = 0;
+
+        g_bp.seen.assign(BP_TASK_TOTAL, 0);
+
+        yf_update_time(NULL, NULL, _log);
+        yf_evt_driver_init_t driver_init = {0, 128, BP_WINDOW * 2 + 64, 
+                        _log, YF_DEFAULT_DRIVER_CB};
+        g_bp.driver = yf_evt_driver_create(&driver_init);
+        ASSERT_TRUE(g_bp.driver != NULL);
+
+        g_bp.bridge = yf_bridge_create(&bridge_ctx, _log);
+        ASSERT_TRUE(g_bp.bridge != NULL);
+        ASSERT_EQ(YF_OK, yf_attach_res_bridge(g_bp.bridge, 
+                        g_bp.driver, on_bp_task_res, _log));
+
+        yf_tm_evt_t* tm_evt;
+        ASSERT_EQ(YF_OK, yf_alloc_tm_evt(g_bp.driver, &tm_evt, _log));
+        tm_evt->data = &ticks;
+        tm_evt->timeout_handler = on_bp_timer;
+        yf_time_t  tm = {0, 100};
+        yf_register_tm_evt(tm_evt, &tm);
+
+        bp_send();
+        yf_evt_driver_start(g_bp.driver);
+
+        yf_bridge_destory(g_bp.bridge, _log);
+        ASSERT_EQ(g_bp.received, (yf_u32_t)BP_TASK_TOTAL);
+        ASSERT_EQ(g_bp.errors, (yf_u32_t)0);
+}
+
+
 /*
 * bridge blocked thread
 */
@@ -475,9 +1853,29 @@ TEST_F(BridgeTestor, EvtThread)
 
 #ifdef TEST_F_INIT
 TEST_F_INIT(BridgeTestor, EvtProc);
+TEST_F_INIT(BridgeTestor, BlockedProc);
 TEST_F_INIT(BridgeTestor, BlockedThread);
 TEST_F_INIT(BridgeTestor, EvtThread);
 TEST_F_INIT(BridgeTestor, TaskQueue);
+TEST_F_INIT(BridgeTestor, TaskQueueBatch);
+TEST_F_INIT(BridgeTestor, TaskQueueZeroCopy);
+TEST_F_INIT(BridgeTestor, TaskQueuePark);
+TEST_F_INIT(BridgeTestor, TaskQueueSteal);
+TEST_F_INIT(BridgeTestor, TaskQueueMp);
+TEST_F_INIT(BridgeTestor, TaskQueueLanes);
+TEST_F_INIT(BridgeTestor, TaskQueueDeadline);
+TEST_F_INIT(BridgeTestor, DispatchLoad);
+TEST_F_INIT(BridgeTestor, DispatchJumpHash);
+TEST_F_INIT(BridgeTestor, CancelTask);
+TEST_F_INIT(BridgeTestor, FailInflight);
+TEST_F_INIT(BridgeTestor, FailQueued);
+TEST_F_INIT(BridgeTestor, ResBatch);
+TEST_F_INIT(BridgeTestor, MultiParent);
+TEST_F_INIT(BridgeTestor, Stat);
+TEST_F_INIT(BridgeTestor, BlockedSpin);
+TEST_F_INIT(BridgeTestor, BlobTask);
+TEST_F_INIT(BridgeTestor, Futex);
+TEST_F_INIT(BridgeTestor, Elastic);
 #endif
 
 int main(int argc, char **argv)
@@ -5,6 +5,8 @@ extern "C" {
 #include <ppc/yf_header.h>
 #include <base_struct/yf_core.h>
 #include <mio_driver/yf_event.h>
+#include <mio_driver/yf_coroutine.h>
+#include <mio_driver/yf_async_file.h>
 #include <log_ext/yf_log_file.h>
 }
 
@@ -279,10 +281,489 @@ TEST_F(DriverTestor, TmFd)
 }
 
 
+/*
+* coroutine, echo client/server pairs over socketpair
+*/
+#define CO_ECHO_PAIRS 16
+#define CO_ECHO_ROUNDS 200
+#define CO_ECHO_MSG_LEN 32
+
+struct CoEchoCtx
+{
+        yf_fd_event_t* rev;
+        yf_fd_event_t* wev;
+};
+
+CoEchoCtx _co_echo_ctxs[CO_ECHO_PAIRS][2];
+yf_co_sched_t* _co_sched = NULL;
+int _co_echo_done = 0;
+
+ssize_t co_read_n(yf_fd_event_t* rev, char* buf, size_t size)
+{
+        size_t readed = 0;
+        while (readed < size)
+        {
+                ssize_t n = yf_co_read(rev, buf + readed, size - readed, 3000);
+                if (n <= 0)
+                        return n;
+                readed += n;
+        }
+        return readed;
+}
+
+void co_echo_server(void* arg)
+{
+        CoEchoCtx* ctx = (CoEchoCtx*)arg;
+        char buf[CO_ECHO_MSG_LEN];
+
+        while (true)
+        {
+                ssize_t n = co_read_n(ctx->rev, buf, sizeof(buf));
+                if (n <= 0)
+                        break;
+                assert(yf_co_write(ctx->wev, buf, n, 0) == n);
+        }
+        
+        yf_fd_t fd = ctx->rev->fd;
+        yf_free_fd_evt(ctx->rev, ctx->wev);
+        close(fd);
+
+        //server end after client closed
+        if (++_co_echo_done == CO_ECHO_PAIRS)
+                yf_evt_driver_stop(_evt_driver);
+}
+
+void co_echo_client(void* arg)
+{
+        CoEchoCtx* ctx = (CoEchoCtx*)arg;
+        char send_buf[CO_ECHO_MSG_LEN], recv_buf[CO_ECHO_MSG_LEN];
+        
+        for (int i = 0; i < CO_ECHO_ROUNDS; ++i)
+        {
+                yf_memzero_st(send_buf);
+                yf_snprintf(send_buf, sizeof(send_buf), "co_%L_%d", yf_co_self_id(), i);
+                
+                assert(yf_co_write(ctx->wev, send_buf, sizeof(send_buf), 0) 
+                                == sizeof(send_buf));
+                assert(co_read_n(ctx->rev, recv_buf, sizeof(recv_buf)) 
+                                == sizeof(recv_buf));
+                assert(memcmp(send_buf, recv_buf, sizeof(send_buf)) == 0);
+
+                if (i % 50 == 0)
+                        yf_co_sleep(::random() % 20);
+                else if (i % 10 == 0)
+                        yf_co_yield();
+        }
+
+        yf_fd_t fd = ctx->rev->fd;
+        yf_free_fd_evt(ctx->rev, ctx->wev);
+        close(fd);
+}
+
+void co_wait_forever(void* arg)
+{
+        char buf[8];
+        yf_co_read((yf_fd_event_t*)arg, buf, sizeof(buf), 0);
+        assert(0);
+}
+
+void co_org_handler(yf_fd_event_t* evt)
+{
+        assert(0);
+}
+
+void co_echo_start(void* arg)
+{
+        //spawn in coroutine, will be started in next loop
+        for (int i = 0; i < CO_ECHO_PAIRS; ++i)
+        {
+                ASSERT_EQ(yf_co_spawn(_co_sched, co_echo_server, 
+                                &_co_echo_ctxs[i][0], NULL), YF_OK);
+                ASSERT_EQ(yf_co_spawn(_co_sched, co_echo_client, 
+                                &_co_echo_ctxs[i][1], NULL), YF_OK);
+        }
+}
+
+TEST_F(DriverTestor, Coroutine)
+{
+        _co_sched = yf_co_sched_create(_evt_driver, 0, 0, _log);
+        ASSERT_TRUE(_co_sched != NULL);
+
+        for (int i = 0; i < CO_ECHO_PAIRS; ++i)
+        {
+                yf_fd_t  fds[2];
+                ASSERT_EQ(socketpair(AF_LOCAL, SOCK_STREAM, 0, fds), 0);
+
+                for (int k = 0; k < 2; ++k)
+                {
+                        yf_nonblocking(fds[k]);
+                        ASSERT_EQ(yf_alloc_fd_evt(_evt_driver, fds[k], 
+                                        &_co_echo_ctxs[i][k].rev, 
+                                        &_co_echo_ctxs[i][k].wev, _log), YF_OK);
+                }
+        }
+
+        yf_u64_t  id = 0;
+        ASSERT_EQ(yf_co_spawn(_co_sched, co_echo_start, NULL, &id), YF_OK);
+        ASSERT_TRUE(id != 0);
+        
+        yf_evt_driver_start(_evt_driver);
+
+        ASSERT_EQ(_co_echo_done, CO_ECHO_PAIRS);
+        ASSERT_EQ(yf_co_num(_co_sched), 0);
+        yf_co_sched_destory(_co_sched);
+
+        //destory with a coroutine parked on fd, the evt must be given back
+        yf_fd_t  fds[2];
+        yf_fd_event_t* rev, *wev;
+        int  org_data = 0;
+        
+        ASSERT_EQ(socketpair(AF_LOCAL, SOCK_STREAM, 0, fds), 0);
+        yf_nonblocking(fds[0]);
+        ASSERT_EQ(yf_alloc_fd_evt(_evt_driver, fds[0], &rev, &wev, _log), YF_OK);
+        rev->data = &org_data;
+        rev->fd_evt_handler = co_org_handler;
+
+        _co_sched = yf_co_sched_create(_evt_driver, 0, 0, _log);
+        ASSERT_EQ(yf_co_spawn(_co_sched, co_wait_forever, rev, NULL), YF_OK);
+        ASSERT_EQ(yf_co_num(_co_sched), 1);
+        ASSERT_TRUE(rev->data != &org_data);
+        
+        yf_co_sched_destory(_co_sched);
+        ASSERT_TRUE(rev->data == &org_data);
+        ASSERT_TRUE(rev->fd_evt_handler == co_org_handler);
+
+        yf_free_fd_evt(rev, wev);
+        close(fds[0]);
+        close(fds[1]);
+}
+
+
+/*
+* async file, write blocks then read back
+*/
+#define AFILE_BLOCKS 64
+#define AFILE_BLOCK_SIZE 4096
+
+yf_afile_pool_t* _afile_pool = NULL;
+yf_file_t  _afile;
+yf_afile_req_t  _afile_reqs[AFILE_BLOCKS];
+char _afile_wbufs[AFILE_BLOCKS][AFILE_BLOCK_SIZE];
+char _afile_rbufs[AFILE_BLOCKS][AFILE_BLOCK_SIZE];
+int _afile_done = 0;
+//one file, done in post order
+int _afile_next_write = 0, _afile_next_read = 0;
+
+void on_afile_read(yf_afile_req_t* req)
+{
+        int index = req - _afile_reqs;
+        
+        ASSERT_EQ(index, _afile_next_read++);
+        ASSERT_EQ(req->ret, AFILE_BLOCK_SIZE);
+        ASSERT_EQ(memcmp(_afile_rbufs[index], _afile_wbufs[index], AFILE_BLOCK_SIZE), 0);
+        
+        if (++_afile_done == 2 * AFILE_BLOCKS)
+                yf_evt_driver_stop(_evt_driver);
+}
+
+void on_afile_write(yf_afile_req_t* req)
+{
+        int index = req - _afile_reqs;
+        
+        ASSERT_EQ(index, _afile_next_write++);
+        ASSERT_EQ(req->ret, AFILE_BLOCK_SIZE);
+        ++_afile_done;
+
+        //read back in io thread too
+        req->done_handler = on_afile_read;
+        ASSERT_EQ(yf_afile_read(_afile_pool, req, &_afile, _afile_rbufs[index], 
+                        AFILE_BLOCK_SIZE, (off_t)index * AFILE_BLOCK_SIZE), YF_OK);
+}
+
+TEST_F(DriverTestor, AsyncFile)
+{
+        _afile_pool = yf_afile_pool_create(_evt_driver, 3, _log);
+        ASSERT_TRUE(_afile_pool != NULL);
+
+        char name[] = "dir/afile_test";
+        yf_memzero_st(_afile);
+        _afile.fd = yf_open_file(name, YF_FILE_RDWR, YF_FILE_TRUNCATE, 
+                        YF_FILE_DEFAULT_ACCESS);
+        ASSERT_TRUE(_afile.fd >= 0);
+        _afile.name.data = name;
+        _afile.name.len = sizeof(name) - 1;
+        _afile.log = _log;
+
+        for (int i = 0; i < AFILE_BLOCKS; ++i)
+        {
+                memset(_afile_wbufs[i], 'a' + i % 26, AFILE_BLOCK_SIZE);
+                yf_memzero_st(_afile_reqs[i]);
+                _afile_reqs[i].log = _log;
+                _afile_reqs[i].done_handler = on_afile_write;
+                
+                ASSERT_EQ(yf_afile_write(_afile_pool, _afile_reqs + i, &_afile, 
+                                _afile_wbufs[i], AFILE_BLOCK_SIZE, 
+                                (off_t)i * AFILE_BLOCK_SIZE), YF_OK);
+        }
+
+        yf_evt_driver_start(_evt_driver);
+        
+        ASSERT_EQ(_afile_done, 2 * AFILE_BLOCKS);
+        
+        //reqs on the same file never run at the same time, no offset lost
+        ASSERT_EQ(_afile.offset, 2 * AFILE_BLOCKS * AFILE_BLOCK_SIZE);
+        yf_afile_pool_destory(_afile_pool);
+        yf_close_file(_afile.fd);
+}
+
+
+/*
+* user evt, triggered by other threads
+*/
+#define USER_EVT_THREADS 4
+#define USER_EVT_TRIGGERS 20000
+
+yf_u64_t _user_evt_cnt = 0;
+yf_u64_t _user_evt_calls = 0;
+
+yf_thread_value_t user_evt_trigger(void* arg)
+{
+        yf_user_event_t* user_evt = (yf_user_event_t*)arg;
+        for (int i = 0; i < USER_EVT_TRIGGERS; ++i)
+        {
+                assert(yf_trigger_user_evt(user_evt) == YF_OK);
+                if (i % 1000 == 0)
+                        usleep(100);
+        }
+        return NULL;
+}
+
+void on_user_evt(yf_user_event_t* evt, yf_u64_t cnt)
+{
+        _user_evt_cnt += cnt;
+        ++_user_evt_calls;
+        
+        if (_user_evt_cnt == USER_EVT_THREADS * USER_EVT_TRIGGERS)
+                yf_evt_driver_stop(_evt_driver);
+}
+
+TEST_F(DriverTestor, UserEvt)
+{
+        yf_user_event_t* user_evt = NULL;
+        ASSERT_EQ(yf_alloc_user_evt(_evt_driver, &user_evt, _log), YF_OK);
+        user_evt->user_evt_handler = on_user_evt;
+
+        yf_tid_t  tids[USER_EVT_THREADS];
+        for (int i = 0; i < USER_EVT_THREADS; ++i)
+                yf_create_thread(tids + i, user_evt_trigger, user_evt, _log);
+
+        yf_evt_driver_start(_evt_driver);
+
+        void* ptr = NULL;
+        for (int i = 0; i < USER_EVT_THREADS; ++i)
+                yf_thread_join(tids[i], &ptr);
+
+        ASSERT_EQ(_user_evt_cnt, USER_EVT_THREADS * USER_EVT_TRIGGERS);
+        //should be coalesced
+        ASSERT_LT(_user_evt_calls, _user_evt_cnt);
+        printf("user evt triggers=%lld, handler calls=%lld\n", 
+                        _user_evt_cnt, _user_evt_calls);
+        
+        yf_free_user_evt(user_evt);
+}
+
+
+/*
+* watch evt, change files under dir in timer
+*/
+#define WATCH_FILES 8
+
+yf_u32_t _watch_what = 0;
+int _watch_modify_cnt = 0;
+int _watch_calls = 0, _watch_rereg_calls = 0, _watch_victim_calls = 0;
+yf_watch_event_t* _watch_victim = NULL;
+
+void on_watch_evt(yf_watch_event_t* evt, yf_u32_t what, const char* name)
+{
+        ASSERT_TRUE(name != NULL);
+        _watch_what |= what;
+        ++_watch_calls;
+        
+        if (what & YF_WATCH_MODIFY)
+        {
+                if (++_watch_modify_cnt == WATCH_FILES)
+                        yf_evt_driver_stop(_evt_driver);
+        }
+}
+
+//free the next watch of the same wd, and register self again (to tail)
+void on_watch_rereg_evt(yf_watch_event_t* evt, yf_u32_t what, const char* name)
+{
+        ++_watch_rereg_calls;
+        if (_watch_victim)
+        {
+                yf_free_watch_evt(_watch_victim);
+                _watch_victim = NULL;
+        }
+        ASSERT_EQ(yf_register_watch_evt(evt), YF_OK);
+}
+
+void on_watch_victim_evt(yf_watch_event_t* evt, yf_u32_t what, const char* name)
+{
+        ++_watch_victim_calls;
+}
+
+void on_watch_write_timeout(yf_tm_evt_t* evt, yf_time_t* start)
+{
+        char path[128];
+        for (int i = 0; i < WATCH_FILES; ++i)
+        {
+                yf_snprintf(path, sizeof(path) - 1, "dir/watch_test/conf_%d%Z", i);
+                FILE* fp = fopen(path, "w");
+                ASSERT_TRUE(fp != NULL);
+                fprintf(fp, "key=%d\n", i);
+                fclose(fp);
+        }
+}
+
+TEST_F(DriverTestor, WatchEvt)
+{
+        char dir[] = "dir/watch_test";
+        char path[128];
+        mkdir(dir, 0755);
+        for (int i = 0; i < WATCH_FILES; ++i)
+        {
+                yf_snprintf(path, sizeof(path) - 1, "%s/conf_%d%Z", dir, i);
+                unlink(path);
+        }
+
+        yf_watch_event_t* watch_evt = NULL;
+        ASSERT_EQ(yf_alloc_watch_evt(_evt_driver, &watch_evt, _log), YF_OK);
+        watch_evt->path = dir;
+        watch_evt->mask = YF_WATCH_CREATE | YF_WATCH_MODIFY;
+        watch_evt->watch_evt_handler = on_watch_evt;
+        ASSERT_EQ(yf_register_watch_evt(watch_evt), YF_OK);
+
+        yf_watch_event_t* rereg_evt = NULL;
+        ASSERT_EQ(yf_alloc_watch_evt(_evt_driver, &rereg_evt, _log), YF_OK);
+        rereg_evt->path = dir;
+        rereg_evt->mask = watch_evt->mask;
+        rereg_evt->watch_evt_handler = on_watch_rereg_evt;
+        ASSERT_EQ(yf_register_watch_evt(rereg_evt), YF_OK);
+
+        ASSERT_EQ(yf_alloc_watch_evt(_evt_driver, &_watch_victim, _log), YF_OK);
+        _watch_victim->path = dir;
+        _watch_victim->mask = watch_evt->mask;
+        _watch_victim->watch_evt_handler = on_watch_victim_evt;
+        ASSERT_EQ(yf_register_watch_evt(_watch_victim), YF_OK);
+
+        yf_tm_evt_t* tm_evt = NULL;
+        ASSERT_EQ(yf_alloc_tm_evt(_evt_driver, &tm_evt, _log), YF_OK);
+        tm_evt->timeout_handler = on_watch_write_timeout;
+        yf_time_t  time_out = {0, 10};
+        ASSERT_EQ(yf_register_tm_evt(tm_evt, &time_out), YF_OK);
+
+        yf_evt_driver_start(_evt_driver);
+
+        ASSERT_EQ(_watch_modify_cnt, WATCH_FILES);
+        ASSERT_TRUE(_watch_what & YF_WATCH_CREATE);
+
+        //each evt once, none to the freed one
+        ASSERT_EQ(_watch_rereg_calls, _watch_calls);
+        ASSERT_EQ(_watch_victim_calls, 0);
+        ASSERT_TRUE(_watch_victim == NULL);
+        
+        yf_free_tm_evt(tm_evt);
+        yf_free_watch_evt(rereg_evt);
+        yf_free_watch_evt(watch_evt);
+}
+
+
+/*
+* watch overflow, touch two files in turn (not coalesced) more than the kernel
+* queue holds before the driver reads, each watch told once
+*/
+int _watch_overflow_cnt[2] = {0, 0};
+
+void on_watch_overflow_evt(yf_watch_event_t* evt, yf_u32_t what, const char* name)
+{
+        if (what & YF_WATCH_OVERFLOW)
+        {
+                ASSERT_TRUE(name == NULL);
+                ++_watch_overflow_cnt[(long)evt->data];
+        }
+}
+
+void on_watch_overflow_timeout(yf_tm_evt_t* evt, yf_time_t* start)
+{
+        yf_evt_driver_stop(_evt_driver);
+}
+
+TEST_F(DriverTestor, WatchOverflow)
+{
+        char dir[] = "dir/watch_overflow";
+        char path[2][128];
+        int  max_queued = 16384;
+
+        FILE* fp = fopen("/proc/sys/fs/inotify/max_queued_events", "r");
+        if (fp)
+        {
+                ASSERT_EQ(fscanf(fp, "%d", &max_queued), 1);
+                fclose(fp);
+        }
+
+        mkdir(dir, 0755);
+        for (int i = 0; i < 2; ++i)
+        {
+                yf_snprintf(path[i], sizeof(path[i]) - 1, "%s/file_%d%Z", dir, i);
+                fp = fopen(path[i], "w");
+                ASSERT_TRUE(fp != NULL);
+                fclose(fp);
+        }
+
+        //attrib one watchs the changes, modify one not, both told
+        yf_watch_event_t* watch_evts[2];
+        for (long i = 0; i < 2; ++i)
+        {
+                ASSERT_EQ(yf_alloc_watch_evt(_evt_driver, watch_evts + i, _log), YF_OK);
+                watch_evts[i]->path = dir;
+                watch_evts[i]->mask = i ? YF_WATCH_MODIFY : YF_WATCH_ATTRIB;
+                watch_evts[i]->data = (void*)i;
+                watch_evts[i]->watch_evt_handler = on_watch_overflow_evt;
+                ASSERT_EQ(yf_register_watch_evt(watch_evts[i]), YF_OK);
+        }
+
+        for (int i = 0; i < max_queued + 64; ++i)
+                ASSERT_EQ(utimes(path[i & 1], NULL), 0);
+
+        yf_tm_evt_t* tm_evt = NULL;
+        ASSERT_EQ(yf_alloc_tm_evt(_evt_driver, &tm_evt, _log), YF_OK);
+        tm_evt->timeout_handler = on_watch_overflow_timeout;
+        yf_time_t  time_out = {0, 200};
+        ASSERT_EQ(yf_register_tm_evt(tm_evt, &time_out), YF_OK);
+
+        yf_evt_driver_start(_evt_driver);
+
+        ASSERT_EQ(_watch_overflow_cnt[0], 1);
+        ASSERT_EQ(_watch_overflow_cnt[1], 1);
+
+        yf_free_tm_evt(tm_evt);
+        for (int i = 0; i < 2; ++i)
+        {
+                yf_free_watch_evt(watch_evts[i]);
+                unlink(path[i]);
+        }
+}
+
 
 #ifdef TEST_F_INIT
 TEST_F_INIT(DriverTestor, Timer);
 TEST_F_INIT(DriverTestor, TmFd);
+TEST_F_INIT(DriverTestor, Coroutine);
+TEST_F_INIT(DriverTestor, AsyncFile);
+TEST_F_INIT(DriverTestor, UserEvt);
+TEST_F_INIT(DriverTestor, WatchEvt);
+TEST_F_INIT(DriverTestor, WatchOverflow);
 #endif
 
 int main(int argc, char **argv)
@@ -240,10 +240,221 @@ TEST_F(ThreadTest, cond)
 }
 
 
+/*
+* time share
+*/
+yf_thread_value_t  time_reader(void* arg)
+{
+        yf_s64_t  last_ms = 0, now_ms;
+        
+        for (int i = 0; i < 2000; ++i)
+        {
+                yf_update_time(NULL, NULL, _log);
+                now_ms = yf_time_2_ms(&yf_now_times.clock_time);
+                assert(now_ms >= last_ms);
+                assert(yf_log_time.data[0] != 0);
+                last_ms = now_ms;
+                usleep(50);
+        }
+        return NULL;
+}
+
+TEST_F(ThreadTest, time_share)
+{
+        yf_tid_t  tid[4];
+        void* ptr = NULL;
+
+        //trylock mode
+        ASSERT_EQ(yf_time_share_enable(0, _log), YF_OK);
+
+        //a fresh snapshot is taken, no own update
+        int  same = 0;
+        for (int i = 0; i < 3 && !same; ++i)
+        {
+                yf_update_time(NULL, NULL, _log);
+                yf_utime_t  last = yf_now_times.clock_utime;
+                yf_update_time(NULL, NULL, _log);
+                same = (last.tv_sec == yf_now_times.clock_utime.tv_sec
+                                && last.tv_usec == yf_now_times.clock_utime.tv_usec);
+        }
+        ASSERT_TRUE(same);
+        
+        for (size_t i = 0; i < YF_ARRAY_SIZE(tid); ++i)
+                yf_create_thread(tid + i, time_reader, NULL, _log);
+        for (size_t i = 0; i < YF_ARRAY_SIZE(tid); ++i)
+                yf_thread_join(tid[i], &ptr);
+        
+        yf_time_share_disable();
+
+        //publisher thread mode
+        ASSERT_EQ(yf_time_share_enable(1, _log), YF_OK);
+        
+        for (size_t i = 0; i < YF_ARRAY_SIZE(tid); ++i)
+                yf_create_thread(tid + i, time_reader, NULL, _log);
+        for (size_t i = 0; i < YF_ARRAY_SIZE(tid); ++i)
+                yf_thread_join(tid[i], &ptr);
+        
+        yf_time_share_disable();
+}
+
+
+/*
+* affinity
+*/
+yf_thread_value_t bind_cpus_thread(void* arg)
+{
+        cpu_set_t  set;
+
+        assert(yf_bind_cpus("0", _log) == YF_OK);
+        assert(sched_getaffinity(0, sizeof(set), &set) == 0);
+        assert(CPU_COUNT(&set) == 1 && CPU_ISSET(0, &set));
+        return NULL;
+}
+
+TEST_F(ThreadTest, bind_cpus)
+{
+        yf_tid_t  tid;
+        void* ptr = NULL;
+        cpu_set_t  set, set_after;
+
+        ASSERT_EQ(sched_getaffinity(0, sizeof(set), &set), 0);
+
+        //just the thread bound
+        yf_create_thread(&tid, bind_cpus_thread, NULL, _log);
+        yf_thread_join(tid, &ptr);
+
+        ASSERT_EQ(sched_getaffinity(0, sizeof(set_after), &set_after), 0);
+        ASSERT_TRUE(CPU_EQUAL(&set, &set_after));
+
+        ASSERT_EQ(yf_bind_cpus("", _log), YF_ERROR);
+        ASSERT_EQ(yf_bind_cpus("a", _log), YF_ERROR);
+        ASSERT_EQ(yf_bind_cpus("3-1", _log), YF_ERROR);
+        ASSERT_EQ(yf_bind_cpus("0,", _log), YF_ERROR);
+        ASSERT_EQ(yf_bind_cpus("0-", _log), YF_ERROR);
+        ASSERT_EQ(yf_bind_cpus("100000", _log), YF_ERROR);
+        ASSERT_TRUE(CPU_EQUAL(&set, &set_after));
+
+        yf_int_t  node = yf_cur_numa_node();
+        ASSERT_GE(node, 0);
+
+        //not whole page, nothing to do
+        char  buf[64];
+        ASSERT_EQ(yf_prefer_numa_node(buf, sizeof(buf), node, _log), YF_AGAIN);
+        ASSERT_EQ(yf_prefer_numa_node(buf, sizeof(buf), -1, _log), YF_AGAIN);
+}
+
+
+/*
+* thread cache alloc
+*/
+#define TC_THREAD_NUM 4
+#define TC_BLOCK_NUM 2000
+
+char*  tc_blocks[TC_THREAD_NUM][TC_BLOCK_NUM];
+size_t  tc_sizes[TC_THREAD_NUM][TC_BLOCK_NUM];
+volatile long  tc_freed_num = 0;
+
+yf_thread_value_t tc_alloc_thread(void* arg)
+{
+        long  no = (long)arg;
+        yf_tc_stat_t  stat;
+
+        for (int i = 0; i < TC_BLOCK_NUM; ++i)
+        {
+                size_t  size = random() % (i % 10 ? 512 : YF_TC_MAX_SIZE + 4096);
+                char* p = (char*)yf_tc_alloc(size);
+                assert(p && yf_tc_size(p) >= size);
+                memset(p, no, size);
+                tc_blocks[no][i] = p;
+                tc_sizes[no][i] = size;
+        }
+
+        //churn on own blocks, the magazine must not grow unbounded
+        for (int i = 0; i < 100000; ++i)
+        {
+                void* p = yf_tc_alloc(random() % 1024);
+                assert(p);
+                yf_tc_free(p);
+        }
+        yf_tc_get_stat(&stat);
+        assert(stat.cached_bytes < 2 * 1024 * 1024);
+        return NULL;
+}
+
+yf_thread_value_t tc_free_thread(void* arg)
+{
+        long  no = (long)arg;
+        yf_tc_stat_t  stat;
+
+        //free the blocks of another thread (remote free)
+        for (int i = 0; i < TC_BLOCK_NUM; ++i)
+        {
+                char* p = tc_blocks[no][i];
+                for (size_t j = 0; j < tc_sizes[no][i]; ++j)
+                        assert(p[j] == (char)no);
+                yf_tc_free(p);
+        }
+
+        void* own[64];
+        for (int i = 0; i < 64; ++i)
+                own[i] = yf_tc_calloc(i * 16);
+        for (int i = 0; i < 64; ++i)
+                yf_tc_free(own[i]);
+
+        //all remote frees done, then the trim can give back all spans
+        __sync_fetch_and_add(&tc_freed_num, 1);
+        while (tc_freed_num < TC_THREAD_NUM)
+                sched_yield();
+
+        yf_tc_get_stat(&stat);
+        assert(stat.span_num && stat.cached_num);
+
+        yf_tc_trim();
+        yf_tc_get_stat(&stat);
+        assert(stat.span_num == 0 && stat.cached_num == 0 && stat.cached_bytes == 0);
+        return NULL;
+}
+
+TEST_F(ThreadTest, tcache)
+{
+        yf_tid_t  tid[TC_THREAD_NUM];
+        void* ptr = NULL;
+        yf_tc_stat_t  stat;
+
+        for (long i = 0; i < TC_THREAD_NUM; ++i)
+                yf_create_thread(tid + i, tc_alloc_thread, (void*)i, _log);
+        for (long i = 0; i < TC_THREAD_NUM; ++i)
+                yf_thread_join(tid[i], &ptr);
+
+        //caches of exited threads are orphans now, adopted by the next threads
+        for (long i = 0; i < TC_THREAD_NUM; ++i)
+                yf_create_thread(tid + i, tc_free_thread, (void*)i, _log);
+        for (long i = 0; i < TC_THREAD_NUM; ++i)
+                yf_thread_join(tid[i], &ptr);
+
+        char* p = (char*)yf_tc_alloc(100);
+        ASSERT_TRUE(p != NULL);
+        ASSERT_EQ(yf_tc_size(p), 112);
+        yf_tc_free(p);
+        yf_tc_free(NULL);
+
+        p = (char*)yf_tc_alloc(YF_TC_MAX_SIZE + 1);
+        ASSERT_EQ(yf_tc_size(p), YF_TC_MAX_SIZE + 1);
+        yf_tc_free(p);
+
+        yf_tc_trim();
+        yf_tc_get_stat(&stat);
+        ASSERT_EQ(stat.span_num, 0);
+}
+
+
 #ifdef TEST_F_INIT
 TEST_F_INIT(ThreadTest, thread);
 TEST_F_INIT(ThreadTest, fast_lock);
 TEST_F_INIT(ThreadTest, cond);
+TEST_F_INIT(ThreadTest, time_share);
+TEST_F_INIT(ThreadTest, bind_cpus);
+TEST_F_INIT(ThreadTest, tcache);
 #endif
 
 int main(int argc, char **argv)